@@ -1,23 +1,208 @@
-// === [YIM Base Status v9] ===
+// === [YIM Base Status v11] ===
 // Adds Cargo Containers tracking to [QG] status overview
 // Compact layout + ASCII spinner feedback
+// One model, rendered on every [YIM] surface (spanning via "YIM:GROUP#")
+// Rescans and level alerts go to a fixed-size log shown on [YIM LOG] panels
+// Refinery / assembler throughput and the bottleneck go to [YIM PROD] panels
 
 const string TAG = "[QG]";
 const string LCD_NAME = "[QG] LCD [YIM-Main]";
+const string DISPLAY_TAG = "[YIM"; // [YIM] or [YIM:surfaceIndex]
+const string SPAN_PREFIX = "YIM:"; // Custom Data line, e.g. YIM:Hangar1
 const double REFRESH_SECONDS = 10;
+const int WATCH_SLICE = 200; // blocks fingerprinted per run (change detection)
+
+// Sampled estimation for huge bases: re-read a rotating stratified subset
+const bool SAMPLED = false;               // true = estimate fill instead of exact sums
+const int SAMPLE_PER_REFRESH = 64;        // blocks re-read per refresh, all sections
+const double MAX_STALENESS_SECONDS = 120; // every block re-read at least this often
+
+// Telemetry (IGC): take the four sections from a YSI publisher's packets
+// (YSI TELEMETRY_MODE = "publish", its [QG] tag group) instead of the blocks
+const bool TELEMETRY = false;
+const string TELEMETRY_CHANNEL = "YTEL";
+const double TELEMETRY_STALE_SECONDS = 30; // measure the blocks again past this
+
+// Multi-site (antenna IGC): each site's YIM sends a small summary of its own
+// scan; a dashboard YIM lists every site, so it only merges packets
+const string SITE_NAME = "";               // "" = no summary sent, e.g. "Main", "Outpost 2"
+const bool SITE_DASHBOARD = false;         // true = sites table on the [YIM] surfaces
+const string SITE_CHANNEL = "YIM-SITES";
+const double SITE_CHANGE_PERCENT = 2;      // send when a section moved this much...
+const double SITE_HEARTBEAT_SECONDS = 120; // ...or this long after the last packet
+const double SITE_STALE_SECONDS = 300;     // marked stale after this without a packet
+
+// Item index over every [QG] inventory, updated a few inventories per run
+const int INDEX_PER_RUN = 8;
+string[] TRACKED_ITEMS = { "Ore/Stone", "Ore/Iron", "Ore/Ice", "Ore/Uranium", "Component/SteelPlate" };
+
+// Production view on [YIM PROD] panels: refineries and assemblers of this
+// construct, read PROD_PER_RUN per run through cached handles so 40
+// refineries never land on one tick. Ore in = ore stock change + ore refined.
+// Queues as set by an autocrafting script (docs/sources/IIM.md): refineries
+// are fed ore, assemblers wait on ingots when their queue cannot start.
+const string PROD_TAG = "[YIM PROD]";
+const int PROD_PER_RUN = 4;
+const double STARVED_KG = 100; // refinery input below this: waiting for ore
+const double BLOCKED_FILL = 0.95; // output this full: refinery blocked
+
+// Event log ("log" argument copies it to the Custom Data of the log panels)
+const string LOG_TAG = "[YIM LOG]";
+const int LOG_CAPACITY = 128;
+const double LOW_PERCENT = 20;  // gas / battery alert below this
+const double FULL_PERCENT = 90; // container alert above this
+
+// Sprite dashboard (class SpriteView) on unspanned [YIM] surfaces: one bar per
+// section and the container fill over the last refreshes; a frame is only
+// sent when a percent or a pixel changed. Spanned groups stay in text.
+const bool SPRITES = false;
+
+// Governor: sheds features when the PB's average cost over a window of runs
+// goes over budget: slower refresh, then no item index / sites, then no
+// production view, then a minimal frame. Restored as headroom returns.
+const double GOVERNOR_BUDGET_MS = 0.25;
+const int GOVERNOR_BUDGET_INSTRUCTIONS = 10000;
+const int GOVERNOR_WINDOW = 30; // runs (~50 s at Update100)
+const int GOVERNOR_SLOW_FACTOR = 3;
+
+List<Display> displays = new List<Display>();
+List<IMyTerminalBlock> displayBlocks = new List<IMyTerminalBlock>();
+Dictionary<string, List<Display>> spans = new Dictionary<string, List<Display>>();
+Dictionary<int, string> frames = new Dictionary<int, string>();
+double[] h2Data, o2Data, batteryData, cargoData;
+string spin;
+
+class Display {
+    public IMyTerminalBlock Block;
+    public IMyTextSurface Surface;
+    public string Span;
+    public int SpanIndex;
+    public string Font;
+    public float Scale;
+    public Vector2 Size = new Vector2(-1, -1);
+    public int BarLength = 15;
+    public int Lines;
+    public SpriteView View; // SPRITES only
+}
+
+System.Text.StringBuilder probe = new System.Text.StringBuilder();
+
+// Change detection: RefreshBlocks keeps the terminal system's block list and
+// its name fingerprint; one slice of that list is checked per run (closed
+// blocks, name hashes) and each pass ends with one typed count query, rotating
+// over the types read here, so a built block is seen within WATCH_KINDS passes.
+// A block of another type built then tagged is seen on the next change or
+// "refresh". A rescan happens only on a change - never on a timer.
+const int WATCH_KINDS = 6;
+List<IMyTerminalBlock> watchBlocks = new List<IMyTerminalBlock>();
+List<IMyTerminalBlock> watchProbe = new List<IMyTerminalBlock>();
+int[] watchKindCounts = new int[WATCH_KINDS];
+int watchCursor, watchKind;
+long watchNames, lastWatchNames;
+bool watchClosed;
 
-IMyTextPanel lcd;
 List<IMyGasTank> h2Tanks = new List<IMyGasTank>();
 List<IMyGasTank> o2Tanks = new List<IMyGasTank>();
 List<IMyBatteryBlock> batteries = new List<IMyBatteryBlock>();
 List<IMyCargoContainer> cargos = new List<IMyCargoContainer>();
 
+// One stratum per section: cached per-block values, running totals and a
+// drift estimate used for the error bound of the blocks not re-read yet
+class Stratum {
+    public int Kind; // 0 gas tank, 1 battery, 2 cargo
+    public List<IMyTerminalBlock> Blocks = new List<IMyTerminalBlock>();
+    public double[] Cur = new double[0], Max = new double[0], ReadAt = new double[0];
+    public double TotalCur, TotalMax, SumReadAt, Drift;
+    public int Cursor;
+    public bool Primed;
+}
+Stratum h2Stratum = new Stratum(), o2Stratum = new Stratum();
+Stratum batteryStratum = new Stratum { Kind = 1 }, cargoStratum = new Stratum { Kind = 2 };
+double clock = 0;
+
+// Per-item totals: each inventory keeps what it contributed last time it was
+// read, so re-reading one applies a delta. Totals are O(1) per MyItemType.
+class InventorySlot {
+    public long Key; // EntityId * 8 + inventory index
+    public IMyTerminalBlock Block;
+    public IMyInventory Inventory;
+    public Dictionary<MyItemType, double> Last = new Dictionary<MyItemType, double>();
+}
+List<InventorySlot> indexSlots = new List<InventorySlot>();
+Dictionary<long, InventorySlot> slotByKey = new Dictionary<long, InventorySlot>();
+Dictionary<MyItemType, double> itemTotals = new Dictionary<MyItemType, double>();
+List<MyInventoryItem> itemBuffer = new List<MyInventoryItem>();
+List<IMyTerminalBlock> indexBlocks = new List<IMyTerminalBlock>();
+MyItemType[] trackedTypes;
+int indexCursor = 0;
+
+class ProdSlot {
+    public IMyProductionBlock Block;
+    public bool Refinery, Indexed; // Indexed: [QG] block, its ore is in the item index
+    public bool Read, Enabled, Working, Queued, Blocked;
+    public double Ore, Ingots, Queue; // input ore, output ingots (kg), assembler queue (items)
+}
+List<ProdSlot> prodSlots = new List<ProdSlot>();
+Dictionary<long, ProdSlot> prodById = new Dictionary<long, ProdSlot>();
+List<IMyProductionBlock> prodBlocks = new List<IMyProductionBlock>();
+List<MyProductionItem> queueBuffer = new List<MyProductionItem>();
+List<IMyTextPanel> prodPanels = new List<IMyTextPanel>();
+int prodCursor = 0, prodPasses = 0, indexPasses = 0, rateSamples = 0;
+double refinedKg = 0; // ore that left working refineries since the last rate
+double oreStock, ingotStock, rateAt, oreRate, inRate, refinedRate, ingotRate;
+
+// Ring buffer of typed events; text is only built when a log panel is shown
+const int EV_RESCAN = 0, EV_REFRESH = 1, EV_LOW = 2, EV_FULL = 3, EV_RECOVERED = 4;
+string[] EVENT_TEXT = { "Blocks changed, rescan", "Manual refresh", "Low", "Almost full", "Back to normal" };
+string[] SECTION_NAMES = { "Hydrogen", "Oxygen", "Batteries", "Containers" };
+long[] logTicks = new long[LOG_CAPACITY];
+int[] logCode = new int[LOG_CAPACITY], logSubject = new int[LOG_CAPACITY]; // subject: section, -1 = none
+double[] logValue = new double[LOG_CAPACITY];
+int logHead = 0, logCount = 0, logVersion = 0, shownVersion = -1;
+bool[] alerted = new bool[4];
+List<IMyTextPanel> logPanels = new List<IMyTextPanel>();
+System.Text.StringBuilder logText = new System.Text.StringBuilder();
+
+// One pass over each block name finds all of the tags below (cached per block)
+NameMatcher names = new NameMatcher();
+int tagId, displayId, logId, prodId;
+
+IMyBroadcastListener telemetry;
+string telemetryPacket;
+double telemetryAt = -1e9;
+bool telemetryOk;            // last refresh rendered a packet (our tag in it)
+bool measuringLocally = true; // false while packets are used: block lists not kept up to date
+
+class Site {
+    public string Name;
+    public double[] Cur = new double[4], Max = new double[4]; // H2, O2, batteries, containers
+    public double ReceivedAt;
+}
+Dictionary<string, Site> sites = new Dictionary<string, Site>();
+List<Site> siteList = new List<Site>();
+IMyBroadcastListener siteListener;
+double[] sentRatio = { -1, -1, -1, -1 };
+long[] readCur = new long[4], readMax = new long[4]; // ReadSite: a packet is parsed whole before it is stored
+double sentAt = -1e9;
+
+Governor governor = new Governor(GOVERNOR_WINDOW, GOVERNOR_BUDGET_MS, GOVERNOR_BUDGET_INSTRUCTIONS);
+
 double timer = 0;
+double measuredAt; // clock of the last Measure (SAMPLED quota)
 int frame = 0;
 char[] spinner = new char[] { '|', '/', '-', '\\' };
 
 public Program() {
     Runtime.UpdateFrequency = UpdateFrequency.Update100; // ~1.6 s
+    trackedTypes = new MyItemType[TRACKED_ITEMS.Length];
+    for (int i = 0; i < TRACKED_ITEMS.Length; i++) trackedTypes[i] = ParseItemType(TRACKED_ITEMS[i]);
+    tagId = names.Keyword(TAG);
+    displayId = names.Tag(DISPLAY_TAG);
+    logId = names.Keyword(LOG_TAG);
+    prodId = names.Keyword(PROD_TAG);
+    names.Build();
+    if (TELEMETRY) telemetry = IGC.RegisterBroadcastListener(TELEMETRY_CHANNEL);
+    if (SITE_DASHBOARD) siteListener = IGC.RegisterBroadcastListener(SITE_CHANNEL);
     RefreshBlocks();
 }
 
@@ -28,55 +213,342 @@ void RefreshBlocks() {
     cargos.Clear();
 
     GridTerminalSystem.GetBlocksOfType(h2Tanks, t =>
-        t.CustomName.Contains(TAG) && t.BlockDefinition.SubtypeName.Contains("Hydrogen"));
+        names.Match(t).Has(tagId) && t.BlockDefinition.SubtypeName.Contains("Hydrogen"));
     GridTerminalSystem.GetBlocksOfType(o2Tanks, t =>
-        t.CustomName.Contains(TAG) && t.BlockDefinition.SubtypeName.Contains("Oxygen"));
+        names.Match(t).Has(tagId) && t.BlockDefinition.SubtypeName.Contains("Oxygen"));
     GridTerminalSystem.GetBlocksOfType(batteries, b =>
-        b.CustomName.Contains(TAG));
+        names.Match(b).Has(tagId));
     GridTerminalSystem.GetBlocksOfType(cargos, c =>
-        c.CustomName.Contains(TAG));
+        names.Match(c).Has(tagId));
+
+    ResetStratum(h2Stratum, h2Tanks);
+    ResetStratum(o2Stratum, o2Tanks);
+    ResetStratum(batteryStratum, batteries);
+    ResetStratum(cargoStratum, cargos);
+    RefreshIndexSlots();
+
+    RefreshDisplays();
+    GridTerminalSystem.GetBlocksOfType(logPanels, p => names.Match(p).Has(logId));
+    GridTerminalSystem.GetBlocksOfType(prodPanels, p => names.Match(p).Has(prodId));
+    RefreshProduction();
+    names.Sweep();
+    ResetWatch();
+}
 
-    lcd = GridTerminalSystem.GetBlockWithName(LCD_NAME) as IMyTextPanel;
-    if (lcd != null) {
-        lcd.ContentType = ContentType.TEXT_AND_IMAGE;
-        lcd.Font = "Monospace";
-        lcd.FontSize = 0.6f;
-        lcd.FontColor = Color.White;
-        lcd.BackgroundColor = Color.Black;
-        lcd.Alignment = TextAlignment.LEFT;
+void RefreshDisplays() {
+    displays.Clear();
+    spans.Clear();
+    displayBlocks.Clear();
+    GridTerminalSystem.GetBlocksOfType(displayBlocks, b =>
+        b is IMyTextSurfaceProvider &&
+        (b.CustomName == LCD_NAME || names.Match(b).Has(displayId)));
+
+    foreach (var b in displayBlocks) {
+        var provider = (IMyTextSurfaceProvider)b;
+        int index = Math.Max(0, names.Match(b).Index[displayId]);
+        if (index >= provider.SurfaceCount) index = 0;
+        if (provider.SurfaceCount == 0) continue;
+
+        var d = new Display();
+        d.Block = b;
+        d.Surface = provider.GetSurface(index);
+        d.Surface.ContentType = ContentType.TEXT_AND_IMAGE;
+        d.Surface.Font = "Monospace";
+        d.Surface.FontSize = 0.6f;
+        d.Surface.FontColor = Color.White;
+        d.Surface.BackgroundColor = Color.Black;
+        d.Surface.Alignment = TextAlignment.LEFT;
+
+        ParseSpan(d);
+        if (d.Span != null) {
+            List<Display> group;
+            if (!spans.TryGetValue(d.Span, out group)) { group = new List<Display>(); spans[d.Span] = group; }
+            group.Add(d);
+        }
+        displays.Add(d);
+    }
+
+    foreach (var group in spans.Values)
+        group.Sort((a, b) => a.SpanIndex.CompareTo(b.SpanIndex));
+}
+
+void ParseSpan(Display d) {
+    foreach (var raw in d.Block.CustomData.Split('\n')) {
+        string line = raw.Trim();
+        if (!line.StartsWith(SPAN_PREFIX)) continue;
+        string spec = line.Substring(SPAN_PREFIX.Length);
+        int cut = spec.Length;
+        while (cut > 0 && char.IsDigit(spec[cut - 1])) cut--;
+        int index;
+        if (cut == 0 || cut == spec.Length || !int.TryParse(spec.Substring(cut), out index)) continue; // too many digits: no span
+        d.Span = spec.Substring(0, cut);
+        d.SpanIndex = index;
+        return;
     }
 }
 
+// Layout is measured per (font, size, surface) and cached until one changes
+void UpdateLayout(Display d) {
+    var s = d.Surface;
+    if (s.SurfaceSize == d.Size && s.Font == d.Font && s.FontSize == d.Scale) return;
+    d.Size = s.SurfaceSize;
+    d.Font = s.Font;
+    d.Scale = s.FontSize;
+
+    float pad = 1f - s.TextPadding / 50f;
+    probe.Clear().Append('M', 10);
+    float charWidth = Math.Max(1f, s.MeasureStringInPixels(probe, d.Font, d.Scale).X / 10f);
+    probe.Clear().Append('M');
+    float first = Math.Max(1f, s.MeasureStringInPixels(probe, d.Font, d.Scale).Y);
+    probe.Append('\n').Append('M');
+    float line = s.MeasureStringInPixels(probe, d.Font, d.Scale).Y - first;
+    if (line <= 0) line = first;
+
+    int columns = (int)(d.Size.X * pad / charWidth);
+    d.BarLength = Math.Max(8, Math.Min(30, columns - 4)); // "- [" + "]"
+    d.Lines = Math.Max(1, 1 + (int)((d.Size.Y * pad - first) / line));
+}
+
 void Main(string argument, UpdateType updateSource) {
+    Tick(argument);
+    governor.Sample(Runtime.LastRunTimeMs, Runtime.CurrentInstructionCount);
+    if (governor.Level > 0) Echo(governor.Status);
+}
+
+void Tick(string argument) {
     timer += Runtime.TimeSinceLastRun.TotalSeconds;
-    if (argument == "refresh") { RefreshBlocks(); timer = 0; }
+    clock += Runtime.TimeSinceLastRun.TotalSeconds;
+    while (telemetry != null && telemetry.HasPendingMessage) {
+        var packet = telemetry.AcceptMessage().Data as string;
+        if (packet != null && packet.StartsWith("YTEL1|")) { telemetryPacket = packet; telemetryAt = clock; }
+    }
+    // Fresh usable packets: no block is read (watcher, item index, production
+    // paused); once stale, the lists are rebuilt once and measuring resumes
+    bool consuming = telemetryOk && clock - telemetryAt < TELEMETRY_STALE_SECONDS;
+    if (argument == "refresh") { RefreshBlocks(); timer = 0; Log(EV_REFRESH, -1, double.NaN); }
+    else if (argument == "log") { ExportLog(); return; }
+    else if (consuming) measuringLocally = false;
+    else if (!measuringLocally) { measuringLocally = true; RefreshBlocks(); }
+    else if (BlocksChanged()) { RefreshBlocks(); Log(EV_RESCAN, -1, watchBlocks.Count); }
+    if (!consuming && governor.Allows(Governor.NO_TAGS)) StepItemIndex();
+    if (!consuming && governor.Allows(Governor.NO_RATES)) StepProduction();
+    ShowLog();
+    while (siteListener != null && siteListener.HasPendingMessage) {
+        var packet = siteListener.AcceptMessage().Data as string;
+        if (packet != null) ReadSite(packet);
+    }
 
-    if (timer < REFRESH_SECONDS) return;
+    if (timer < REFRESH_SECONDS * (governor.Allows(Governor.SLOWER) ? 1 : GOVERNOR_SLOW_FACTOR)) return;
     timer = 0;
 
-    if (lcd == null) return;
-
+    // Measure once, then lay the same data out for each surface
     frame = (frame + 1) % spinner.Length;
-    string spin = spinner[frame].ToString();
+    spin = spinner[frame].ToString();
+    telemetryOk = clock - telemetryAt < TELEMETRY_STALE_SECONDS && ReadTelemetry();
+    if (!telemetryOk) {
+        if (!measuringLocally) { measuringLocally = true; RefreshBlocks(); }
+        Measure();
+    }
+    frames.Clear();
+    CheckLevel(0, h2Data, false);
+    CheckLevel(1, o2Data, false);
+    CheckLevel(2, batteryData, false);
+    CheckLevel(3, cargoData, true);
+    if (SITE_NAME.Length > 0) SendSite();
+    ShowProduction();
 
-    string output = "Base " + TAG + " Status Overview  " + spin + "\n=====================\n";
-    output += BuildSection("Hydrogen", GetGasData(h2Tanks), "L");
-    output += BuildSection("Oxygen", GetGasData(o2Tanks), "L");
-    output += BuildSection("Batteries", GetBatteryData(), "MWh");
-    output += BuildSection("Containers", GetCargoData(), "L");
+    if (displays.Count == 0) return;
+    foreach (var d in displays) {
+        if (d.Span != null) continue;
+        if (SPRITES) { DrawSprites(d); continue; }
+        UpdateLayout(d);
+        d.Surface.WriteText(GetFrame(d.BarLength), false);
+    }
+    foreach (var group in spans.Values) WriteSpan(group);
+}
 
-    lcd.WriteText(output, false);
+void Measure() {
+    if (SAMPLED) {
+        int total = h2Stratum.Blocks.Count + o2Stratum.Blocks.Count
+            + batteryStratum.Blocks.Count + cargoStratum.Blocks.Count;
+        double elapsed = clock - measuredAt; // governor slowdowns, telemetry gaps included
+        measuredAt = clock;
+        h2Data = Estimate(h2Stratum, total, elapsed);
+        o2Data = Estimate(o2Stratum, total, elapsed);
+        batteryData = Estimate(batteryStratum, total, elapsed);
+        cargoData = Estimate(cargoStratum, total, elapsed);
+    } else {
+        h2Data = GetGasData(h2Tanks);
+        o2Data = GetGasData(o2Tanks);
+        batteryData = GetBatteryData();
+        cargoData = GetCargoData();
+    }
+}
+
+// Alerts fire once per crossing; 5 points of hysteresis before "back to normal"
+void CheckLevel(int section, double[] data, bool full) {
+    if (data[3] == 0) return;
+    double pct = data[0] * 100;
+    bool bad = full ? pct > FULL_PERCENT : pct < LOW_PERCENT;
+    bool clear = full ? pct < FULL_PERCENT - 5 : pct > LOW_PERCENT + 5;
+    if (bad && !alerted[section]) { alerted[section] = true; Log(full ? EV_FULL : EV_LOW, section, pct); }
+    else if (clear && alerted[section]) { alerted[section] = false; Log(EV_RECOVERED, section, pct); }
+}
+
+// Hot path: array stores only, no strings
+void Log(int code, int subject, double value) {
+    logTicks[logHead] = DateTime.Now.Ticks;
+    logCode[logHead] = code;
+    logSubject[logHead] = subject;
+    logValue[logHead] = value;
+    logHead = (logHead + 1) % LOG_CAPACITY;
+    if (logCount < LOG_CAPACITY) logCount++;
+    logVersion++;
+}
+
+// Newest first, so a short panel still shows the latest events
+string FormatLog() {
+    logText.Clear();
+    for (int k = 1; k <= logCount; k++) {
+        int i = (logHead - k + LOG_CAPACITY) % LOG_CAPACITY;
+        logText.Append(new DateTime(logTicks[i]).ToString("HH:mm:ss")).Append(' ').Append(EVENT_TEXT[logCode[i]]);
+        if (logSubject[i] >= 0) logText.Append(' ').Append(SECTION_NAMES[logSubject[i]]);
+        if (!double.IsNaN(logValue[i])) logText.Append(' ').Append(logValue[i].ToString("0.#"));
+        logText.Append('\n');
+    }
+    return logText.ToString();
 }
 
-string BuildSection(string name, double[] data, string unit) {
+void ShowLog() {
+    if (logVersion == shownVersion || logPanels.Count == 0) return;
+    shownVersion = logVersion;
+    string text = FormatLog();
+    foreach (var p in logPanels) {
+        if (p.Closed) continue;
+        p.ContentType = ContentType.TEXT_AND_IMAGE;
+        p.WriteText(text);
+    }
+}
+
+void ExportLog() {
+    string text = FormatLog();
+    foreach (var p in logPanels)
+        if (!p.Closed) p.CustomData = text;
+}
+
+string GetFrame(int barLength) {
+    string output;
+    if (frames.TryGetValue(barLength, out output)) return output;
+
+    if (!governor.Allows(Governor.MINIMAL)) {
+        output = "Base " + TAG + "  " + spin + "\n";
+        for (int i = 0; i < 4; i++) {
+            double[] data = i == 0 ? h2Data : i == 1 ? o2Data : i == 2 ? batteryData : cargoData;
+            output += SECTION_NAMES[i] + " " + (data[3] > 0 ? (data[0] * 100).ToString("0.0") + "%" : "-") + "\n";
+        }
+        frames[barLength] = output + governor.Status + "\n";
+        return frames[barLength];
+    }
+
+    output = "Base " + TAG + " Status Overview  " + spin + "\n=====================\n";
+    output += BuildSection("Hydrogen", h2Data, "L", barLength);
+    output += BuildSection("Oxygen", o2Data, "L", barLength);
+    output += BuildSection("Batteries", batteryData, "MWh", barLength);
+    output += BuildSection("Containers", cargoData, "L", barLength);
+    if (governor.Allows(Governor.NO_TAGS)) {
+        output += BuildItemsSection();
+        output += BuildSitesSection();
+    }
+
+    frames[barLength] = output;
+    return output;
+}
+
+// Whole percents on the bars; container fill sparkline at full scale = 100 %
+void DrawSprites(Display d) {
+    if (d.View == null) d.View = new SpriteView(d.Surface, 6);
+    d.View.Text(0, "Base " + TAG, Color.White);
+    for (int i = 0; i < 4; i++) {
+        double[] data = i == 0 ? h2Data : i == 1 ? o2Data : i == 2 ? batteryData : cargoData;
+        bool alert = i == 3 ? data[0] * 100 >= FULL_PERCENT : data[0] * 100 < LOW_PERCENT;
+        Color color = data[3] == 0 ? Color.Gray : alert ? Color.Orange : Color.Lime;
+        d.View.Bar(i + 1, SECTION_NAMES[i], data[0], (int)Math.Round(data[0] * 100), 0, "%", color);
+    }
+    d.View.Spark(5, "Cargo", cargoData[0], 1, Color.Cyan, Color.Cyan);
+    d.View.Draw();
+}
+
+// First panel's layout drives the group; each next panel continues the text
+void WriteSpan(List<Display> group) {
+    foreach (var d in group) UpdateLayout(d);
+    string output = GetFrame(group[0].BarLength);
+    int pos = 0;
+    for (int i = 0; i < group.Count; i++) {
+        bool last = i == group.Count - 1;
+        int end = pos, lines = 0;
+        while (end < output.Length && (last || lines < group[i].Lines)) {
+            int nl = output.IndexOf('\n', end);
+            end = nl < 0 ? output.Length : nl + 1;
+            lines++;
+        }
+        group[i].Surface.WriteText(output.Substring(pos, end - pos), false);
+        pos = end;
+    }
+}
+
+// The only full listing of the terminal system, once per RefreshBlocks
+void ResetWatch() {
+    GridTerminalSystem.GetBlocks(watchBlocks);
+    lastWatchNames = 0;
+    foreach (var b in watchBlocks) lastWatchNames += NameHash(b);
+    for (int k = 0; k < WATCH_KINDS; k++) watchKindCounts[k] = ProbeCount(k);
+    watchCursor = 0; watchNames = 0; watchClosed = false;
+}
+
+bool BlocksChanged() {
+    int end = Math.Min(watchBlocks.Count, watchCursor + WATCH_SLICE);
+    for (int i = watchCursor; i < end; i++) {
+        var b = watchBlocks[i];
+        if (b.Closed) { watchClosed = true; continue; }
+        watchNames += NameHash(b);
+    }
+    watchCursor = end;
+    if (watchCursor < watchBlocks.Count) return false;
+
+    bool changed = watchClosed || watchNames != lastWatchNames || ProbeCount(watchKind) != watchKindCounts[watchKind];
+    watchKind = (watchKind + 1) % WATCH_KINDS;
+    watchCursor = 0; watchNames = 0; watchClosed = false;
+    return changed;
+}
+
+long NameHash(IMyTerminalBlock b) {
+    return (long)b.CustomName.GetHashCode() * 31 + (b.EntityId & 0xFFFF);
+}
+
+// Unfiltered typed query: no script code runs per block (the watch list is unfiltered too)
+int ProbeCount(int kind) {
+    switch (kind) {
+        case 0: GridTerminalSystem.GetBlocksOfType<IMyGasTank>(watchProbe); break;
+        case 1: GridTerminalSystem.GetBlocksOfType<IMyBatteryBlock>(watchProbe); break;
+        case 2: GridTerminalSystem.GetBlocksOfType<IMyCargoContainer>(watchProbe); break;
+        case 3: GridTerminalSystem.GetBlocksOfType<IMyTextSurfaceProvider>(watchProbe); break;
+        case 4: GridTerminalSystem.GetBlocksOfType<IMyProductionBlock>(watchProbe); break;
+        default: GridTerminalSystem.GetBlocksOfType<IMyShipConnector>(watchProbe); break;
+    }
+    return watchProbe.Count;
+}
+
+string BuildSection(string name, double[] data, string unit, int barLength) {
     double ratio = data[0];
     double cur = data[1];
     double max = data[2];
     int count = (int)data[3];
 
-    string bar = GetMiniBar(ratio, 15);
+    string bar = GetMiniBar(ratio, barLength);
     string line1 = string.Format("{0}\n", name);
     string line2 = string.Format("- {0,5:0.0}% {1} / {2} {3}\n", ratio * 100, Format(cur), Format(max), unit);
+    if (data.Length > 4 && max > 0) // sampled: estimate with its error bound
+        line2 = string.Format("- ~{0,4:0.0}% +/-{1:0.0}% {2} / {3} {4}\n", ratio * 100, data[4] / max * 100, Format(cur), Format(max), unit);
     string line3 = string.Format("- {0}\n", bar);
     string line4 = string.Format("- {0} blocks\n\n", count);
 
@@ -88,6 +560,32 @@ string GetMiniBar(double ratio, int len) {
     return "[" + new string('|', filled) + new string('.', len - filled) + "]";
 }
 
+// YTEL1 packet entry of our tag: key, then per section current,max,blocks
+// (gases also a rate) in fixed point x100; see YSI BuildTelemetry
+bool ReadTelemetry() {
+    string key = TAG.Trim('[', ']');
+    string[] parts = telemetryPacket.Split('|');
+    if (parts.Length != 3) return false;
+    foreach (var entry in parts[2].Split(';')) {
+        var f = entry.Split(',');
+        if (f.Length != 17 || !f[0].Equals(key, StringComparison.OrdinalIgnoreCase)) continue;
+        h2Data = PacketSection(f, 1);
+        o2Data = PacketSection(f, 5);
+        batteryData = PacketSection(f, 9);
+        cargoData = PacketSection(f, 12);
+        return true;
+    }
+    return false;
+}
+
+double[] PacketSection(string[] f, int start) {
+    long cur, max, count;
+    long.TryParse(f[start], out cur);
+    long.TryParse(f[start + 1], out max);
+    long.TryParse(f[start + 2], out count);
+    return new double[] { max > 0 ? (double)cur / max : 0, cur / 100.0, max / 100.0, count };
+}
+
 double[] GetGasData(List<IMyGasTank> tanks) {
     double cur = 0, max = 0;
     for (int i = 0; i < tanks.Count; i++) {
@@ -119,8 +617,700 @@ double[] GetCargoData() {
     return new double[] { ratio, cur, max, cargos.Count };
 }
 
+void ResetStratum<T>(Stratum s, List<T> blocks) where T : class, IMyTerminalBlock {
+    s.Blocks.Clear();
+    foreach (var b in blocks) s.Blocks.Add(b);
+    int n = s.Blocks.Count;
+    s.Cur = new double[n]; s.Max = new double[n]; s.ReadAt = new double[n];
+    s.TotalCur = 0; s.TotalMax = 0; s.SumReadAt = 0; s.Drift = 0; s.Cursor = 0;
+    s.Primed = false;
+}
+
+void Read(Stratum s, int i, out double cur, out double max) {
+    var b = s.Blocks[i];
+    if (s.Kind == 0) { var t = (IMyGasTank)b; max = t.Capacity; cur = t.FilledRatio * max; }
+    else if (s.Kind == 1) { var bat = (IMyBatteryBlock)b; cur = bat.CurrentStoredPower; max = bat.MaxStoredPower; }
+    else { var inv = b.GetInventory(); cur = (double)inv.CurrentVolume; max = (double)inv.MaxVolume; }
+}
+
+// Re-reads this stratum's share of the sample (proportional allocation, raised
+// so the rotation covers every block within MAX_STALENESS_SECONDS at the
+// actual pace of Measure calls). Totals are updated by delta, so the cost is
+// O(sample), not O(blocks).
+double[] Estimate(Stratum s, int totalBlocks, double elapsed) {
+    int n = s.Blocks.Count;
+    if (n == 0) return new double[] { 0, 0, 0, 0, 0 };
+
+    int quota = n;
+    if (s.Primed) {
+        int share = (int)Math.Ceiling((double)SAMPLE_PER_REFRESH * n / Math.Max(1, totalBlocks));
+        int fresh = (int)Math.Ceiling(n * Math.Max(REFRESH_SECONDS, elapsed) / MAX_STALENESS_SECONDS);
+        quota = Math.Min(n, Math.Max(share, fresh));
+    }
+
+    double moved = 0, age = 0;
+    for (int k = 0; k < quota; k++) {
+        int i = s.Cursor;
+        s.Cursor = (s.Cursor + 1) % n;
+        double cur, max;
+        Read(s, i, out cur, out max);
+        if (s.Primed) { moved += Math.Abs(cur - s.Cur[i]); age += clock - s.ReadAt[i]; }
+        s.TotalCur += cur - s.Cur[i];
+        s.TotalMax += max - s.Max[i];
+        s.SumReadAt += clock - s.ReadAt[i];
+        s.Cur[i] = cur; s.Max[i] = max; s.ReadAt[i] = clock;
+    }
+    if (age > 0) s.Drift = s.Primed && s.Drift > 0 ? 0.7 * s.Drift + 0.3 * (moved / age) : moved / age;
+    s.Primed = true;
+
+    // Error bound: observed drift per block-second times the total staleness
+    double staleness = Math.Max(0, n * clock - s.SumReadAt);
+    double error = Math.Min(s.TotalMax, s.Drift * staleness);
+    double ratio = s.TotalMax > 0 ? s.TotalCur / s.TotalMax : 0;
+    return new double[] { ratio, s.TotalCur, s.TotalMax, n, error };
+}
+
+MyItemType ParseItemType(string spec) {
+    int slash = spec.IndexOf('/');
+    return new MyItemType("MyObjectBuilder_" + spec.Substring(0, slash), spec.Substring(slash + 1));
+}
+
+// Keeps slots of inventories that still exist, drops the contribution of the
+// ones that disappeared; totals stay valid across rescans
+void RefreshIndexSlots() {
+    GridTerminalSystem.GetBlocksOfType(indexBlocks, b =>
+        b.HasInventory && names.Match(b).Has(tagId) && !(b is IMyGasTank));
+
+    var kept = new Dictionary<long, InventorySlot>();
+    indexSlots.Clear();
+    foreach (var b in indexBlocks) {
+        for (int i = 0; i < b.InventoryCount; i++) {
+            long key = b.EntityId * 8 + i;
+            InventorySlot slot;
+            if (!slotByKey.TryGetValue(key, out slot)) slot = new InventorySlot { Key = key };
+            slot.Block = b;
+            slot.Inventory = b.GetInventory(i);
+            kept[key] = slot;
+            indexSlots.Add(slot);
+        }
+    }
+    foreach (var old in slotByKey.Values)
+        if (!kept.ContainsKey(old.Key)) ApplySlot(old, -1);
+    slotByKey = kept;
+    if (indexCursor >= indexSlots.Count) indexCursor = 0;
+}
+
+void StepItemIndex() {
+    int count = Math.Min(INDEX_PER_RUN, indexSlots.Count);
+    for (int k = 0; k < count; k++) {
+        var slot = indexSlots[indexCursor];
+        indexCursor = (indexCursor + 1) % indexSlots.Count;
+        if (indexCursor == 0) indexPasses++;
+
+        if (slot.Block.Closed) continue; // dropped at the next rescan
+        ApplySlot(slot, -1);
+        slot.Last.Clear();
+        itemBuffer.Clear();
+        slot.Inventory.GetItems(itemBuffer);
+        for (int i = 0; i < itemBuffer.Count; i++) {
+            double prev;
+            slot.Last.TryGetValue(itemBuffer[i].Type, out prev);
+            slot.Last[itemBuffer[i].Type] = prev + (double)itemBuffer[i].Amount;
+        }
+        ApplySlot(slot, 1);
+    }
+}
+
+void ApplySlot(InventorySlot slot, int sign) {
+    foreach (var kv in slot.Last) {
+        double total;
+        itemTotals.TryGetValue(kv.Key, out total);
+        itemTotals[kv.Key] = total + sign * kv.Value;
+    }
+}
+
+double ItemAmount(MyItemType type) {
+    double total;
+    return itemTotals.TryGetValue(type, out total) ? Math.Max(0, total) : 0;
+}
+
+string BuildItemsSection() {
+    if (trackedTypes.Length == 0) return "";
+    string output = "Items\n";
+    for (int i = 0; i < trackedTypes.Length; i++)
+        output += string.Format("- {0,-12} {1}\n", trackedTypes[i].SubtypeId, Format(ItemAmount(trackedTypes[i])));
+    return output;
+}
+
+// Handles kept across rescans, like the item index slots
+void RefreshProduction() {
+    GridTerminalSystem.GetBlocksOfType(prodBlocks, b =>
+        b.IsSameConstructAs(Me) && (b is IMyRefinery || b is IMyAssembler));
+
+    var kept = new Dictionary<long, ProdSlot>();
+    prodSlots.Clear();
+    foreach (var b in prodBlocks) {
+        ProdSlot slot;
+        if (!prodById.TryGetValue(b.EntityId, out slot)) slot = new ProdSlot { Block = b, Refinery = b is IMyRefinery };
+        slot.Indexed = names.Match(b).Has(tagId);
+        kept[b.EntityId] = slot;
+        prodSlots.Add(slot);
+    }
+    prodById = kept;
+    if (prodCursor >= prodSlots.Count) prodCursor = 0;
+}
+
+void StepProduction() {
+    if (prodPanels.Count == 0 || prodSlots.Count == 0) return;
+    int count = Math.Min(PROD_PER_RUN, prodSlots.Count);
+    for (int k = 0; k < count; k++) {
+        var slot = prodSlots[prodCursor];
+        prodCursor = (prodCursor + 1) % prodSlots.Count;
+        if (prodCursor == 0) prodPasses++;
+
+        var b = slot.Block;
+        if (b.Closed) continue; // dropped at the next rescan
+        double ore = InventoryAmount(b.InputInventory, "MyObjectBuilder_Ore");
+        bool working = b.IsProducing;
+        // Ore that left a working refinery's input was refined (ore pulled
+        // out by a sorter at the same time is counted too)
+        if (slot.Refinery && slot.Read && (working || slot.Working) && ore < slot.Ore) refinedKg += slot.Ore - ore;
+
+        var output = b.OutputInventory;
+        slot.Ore = ore;
+        slot.Ingots = InventoryAmount(output, "MyObjectBuilder_Ingot");
+        slot.Working = working;
+        slot.Enabled = b.Enabled;
+        slot.Queued = !b.IsQueueEmpty;
+        slot.Blocked = !working && (double)output.CurrentVolume >= BLOCKED_FILL * (double)output.MaxVolume;
+        slot.Queue = 0;
+        if (!slot.Refinery) {
+            queueBuffer.Clear();
+            b.GetQueue(queueBuffer);
+            for (int i = 0; i < queueBuffer.Count; i++) slot.Queue += (double)queueBuffer[i].Amount;
+        }
+        slot.Read = true;
+    }
+}
+
+double InventoryAmount(IMyInventory inventory, string typeId) {
+    double amount = 0;
+    itemBuffer.Clear();
+    inventory.GetItems(itemBuffer);
+    for (int i = 0; i < itemBuffer.Count; i++)
+        if (itemBuffer[i].Type.TypeId == typeId) amount += (double)itemBuffer[i].Amount;
+    return amount;
+}
+
+// Stocks: [QG] inventories (item index) plus the production blocks outside
+// it. Rates start once both were read in full, then are smoothed per refresh.
+void UpdateRates() {
+    if (prodPasses == 0 || (indexPasses == 0 && indexSlots.Count > 0)) return;
+    double ore = 0, ingots = 0;
+    foreach (var kv in itemTotals) {
+        if (kv.Key.TypeId == "MyObjectBuilder_Ore") ore += Math.Max(0, kv.Value);
+        else if (kv.Key.TypeId == "MyObjectBuilder_Ingot") ingots += Math.Max(0, kv.Value);
+    }
+    foreach (var slot in prodSlots)
+        if (!slot.Indexed) { ore += slot.Ore; ingots += slot.Ingots; }
+
+    double dt = clock - rateAt;
+    if (rateAt > 0 && dt > 0) {
+        double trend = (ore - oreStock) / dt, refined = refinedKg / dt;
+        double a = rateSamples == 0 ? 1 : 0.3;
+        oreRate += a * (trend - oreRate);
+        refinedRate += a * (refined - refinedRate);
+        inRate += a * (Math.Max(0, trend + refined) - inRate);
+        ingotRate += a * ((ingots - ingotStock) / dt - ingotRate);
+        rateSamples++;
+    }
+    oreStock = ore; ingotStock = ingots; rateAt = clock; refinedKg = 0;
+}
+
+// Governor: rates need the item index, the view needs production stepping;
+// the panel keeps its last text while paused and rates start over after
+void ShowProduction() {
+    if (prodPanels.Count == 0) return;
+    if (governor.Allows(Governor.NO_TAGS)) UpdateRates();
+    else { rateAt = 0; rateSamples = 0; refinedKg = 0; }
+    if (!governor.Allows(Governor.NO_RATES)) return;
+    string text = BuildProduction();
+    foreach (var p in prodPanels) {
+        if (p.Closed) continue;
+        p.ContentType = ContentType.TEXT_AND_IMAGE;
+        p.WriteText(text);
+    }
+}
+
+string BuildProduction() {
+    int refineries = 0, working = 0, off = 0, idleCount = 0, starved = 0, blocked = 0;
+    int assemblers = 0, assembling = 0, waiting = 0;
+    double input = 0, queue = 0;
+    string idle = "";
+    foreach (var slot in prodSlots) {
+        if (!slot.Read) continue;
+        if (!slot.Refinery) {
+            assemblers++;
+            queue += slot.Queue;
+            if (slot.Working) assembling++;
+            else if (slot.Enabled && slot.Queued) waiting++;
+            continue;
+        }
+        refineries++;
+        input += slot.Ore;
+        if (!slot.Enabled) { off++; continue; }
+        if (slot.Working) { working++; continue; }
+        if (slot.Blocked) blocked++;
+        else if (slot.Ore < STARVED_KG) starved++;
+        if (++idleCount <= 3) idle += (idle.Length > 0 ? ", " : "") + slot.Block.CustomName;
+    }
+
+    string output = "Production  " + spin + "\n=====================\n";
+    output += string.Format("Refineries {0}/{1} working{2}\n", working, refineries, off > 0 ? ", " + off + " off" : "");
+    output += string.Format("- Ore input  {0} kg\n", Format(input));
+    if (rateSamples > 0) {
+        output += string.Format("- Ore stock  {0} kg {1}{2}/s\n", Format(oreStock), oreRate < 0 ? "-" : "+", Format(Math.Abs(oreRate)));
+        output += string.Format("- Ore in     {0}/s, refined {1}/s\n", Format(inRate), Format(refinedRate));
+        output += string.Format("- Ingots     {0}{1}/s (net)\n", ingotRate < 0 ? "-" : "+", Format(Math.Abs(ingotRate)));
+    } else output += "- Rates after a full pass\n";
+    if (idle.Length > 0) output += "- Idle: " + idle + (idleCount > 3 ? " +" + (idleCount - 3) : "") + "\n";
+    output += string.Format("Assemblers {0}/{1} working{2}\n", assembling, assemblers, waiting > 0 ? ", " + waiting + " waiting" : "");
+    output += string.Format("- Queue      {0} items\n", Format(queue));
+    output += "Bottleneck: " + Bottleneck(refineries - off, working, starved, blocked, waiting) + "\n";
+    return output;
+}
+
+// Blocked output first (nothing else moves), then missing ore, then refineries
+// all busy while ore piles up, then assemblers short of ingots
+string Bottleneck(int refineries, int working, int starved, int blocked, int waiting) {
+    if (refineries == 0) return "no refinery on";
+    if (blocked > 0) return "output full (" + blocked + " refineries)";
+    if (starved * 3 >= refineries) return "ore supply (" + starved + " starved)";
+    if (rateSamples > 0 && working * 10 >= refineries * 9 && oreRate > 0) return "refining (ore piling up)";
+    if (waiting > 0) return "ingots (" + waiting + " assemblers waiting)";
+    return "none, keeping up";
+}
+
+// YSITE1|name|cur,max;cur,max;cur,max;cur,max (H2, O2, batteries, containers; x100)
+void SendSite() {
+    var data = new[] { h2Data, o2Data, batteryData, cargoData };
+    bool changed = clock - sentAt >= SITE_HEARTBEAT_SECONDS;
+    for (int i = 0; i < 4; i++)
+        if (Math.Abs(data[i][0] - sentRatio[i]) * 100 >= SITE_CHANGE_PERCENT) changed = true;
+    if (SITE_DASHBOARD) StoreSite(SITE_NAME, data); // own row, no packet needed
+    if (!changed) return;
+
+    var sb = new System.Text.StringBuilder("YSITE1|").Append(SITE_NAME).Append('|');
+    for (int i = 0; i < 4; i++) {
+        if (i > 0) sb.Append(';');
+        sb.Append((long)Math.Round(data[i][1] * 100)).Append(',').Append((long)Math.Round(data[i][2] * 100));
+        sentRatio[i] = data[i][0];
+    }
+    sentAt = clock;
+    IGC.SendBroadcastMessage(SITE_CHANNEL, sb.ToString(), TransmissionDistance.AntennaRelay);
+}
+
+void ReadSite(string packet) {
+    var parts = packet.Split('|');
+    if (parts.Length != 3 || parts[0] != "YSITE1" || parts[1].Length == 0) return;
+    var sections = parts[2].Split(';');
+    if (sections.Length != 4) return;
+    for (int i = 0; i < 4; i++) {
+        var f = sections[i].Split(',');
+        if (f.Length != 2 || !long.TryParse(f[0], out readCur[i]) || !long.TryParse(f[1], out readMax[i])) return;
+    }
+    // Valid packet only: no phantom site, no half-updated one
+    var site = GetSite(parts[1]);
+    for (int i = 0; i < 4; i++) { site.Cur[i] = readCur[i] / 100.0; site.Max[i] = readMax[i] / 100.0; }
+    site.ReceivedAt = clock;
+}
+
+void StoreSite(string name, double[][] data) {
+    var site = GetSite(name);
+    for (int i = 0; i < 4; i++) { site.Cur[i] = data[i][1]; site.Max[i] = data[i][2]; }
+    site.ReceivedAt = clock;
+}
+
+Site GetSite(string name) {
+    Site site;
+    if (sites.TryGetValue(name, out site)) return site;
+    site = new Site { Name = name };
+    sites[name] = site;
+    siteList.Add(site);
+    siteList.Sort((a, b) => string.Compare(a.Name, b.Name, StringComparison.OrdinalIgnoreCase));
+    return site;
+}
+
+string BuildSitesSection() {
+    if (siteList.Count == 0) return "";
+    string output = string.Format("{0,-14}{1,5}{2,5}{3,5}{4,6}\n", "Sites", "H2", "O2", "Bat", "Cargo");
+    foreach (var site in siteList) {
+        string name = site.Name.Length > 12 ? site.Name.Substring(0, 12) : site.Name;
+        output += string.Format("- {0,-12}{1,5}{2,5}{3,5}{4,6}", name,
+            SitePercent(site, 0), SitePercent(site, 1), SitePercent(site, 2), SitePercent(site, 3));
+        double age = clock - site.ReceivedAt;
+        if (age > SITE_STALE_SECONDS) output += " STALE " + (int)(age / 60) + "m";
+        output += "\n";
+    }
+    return output;
+}
+
+string SitePercent(Site site, int section) {
+    return site.Max[section] > 0 ? Math.Round(site.Cur[section] / site.Max[section] * 100) + "%" : "-";
+}
+
 string Format(double val) {
     if (val >= 1000000) return (val / 1000000).ToString("0.0M");
     if (val >= 1000) return (val / 1000).ToString("0.0k");
     return val.ToString("0.0");
 }
+
+// Retained sprite dashboard on a SCRIPT surface, one row per line: a text, a
+// bar (label, track, fill, value) or a sparkline (label, one column per
+// sample). A row's sprites are created on its first use, rows in order, and
+// then kept: updates edit them in place and Draw sends a frame only when a
+// text changed or a fill or column moved by a whole pixel.
+class SpriteView {
+    public const int SPARK_SAMPLES = 20;
+    const float LABEL_WIDTH = 0.3f;  // share of the width left of bars and sparklines
+    const float VALUE_WIDTH = 0.2f;  // share of the width right of bars
+    static readonly Color TRACK = new Color(40, 40, 40);
+
+    public readonly IMyTextSurface Surface;
+    readonly List<MySprite> sprites = new List<MySprite>();
+    readonly List<int> drawn = new List<int>();  // per sprite: fill / column px or value shown
+    readonly List<int> rowStart = new List<int>();
+    readonly Dictionary<int, double[]> samples = new Dictionary<int, double[]>();
+    readonly Vector2 origin;
+    readonly float width, rowHeight, textScale;
+    bool dirty = true;
+
+    public SpriteView(IMyTextSurface surface, int rows) {
+        Surface = surface;
+        surface.ScriptBackgroundColor = Color.Black;
+        Vector2 size = surface.SurfaceSize;
+        origin = (surface.TextureSize - size) / 2 + size * 0.02f;
+        width = size.X * 0.96f;
+        rowHeight = size.Y * 0.96f / rows;
+        textScale = Math.Min(1.2f, Math.Min(rowHeight / 34f, width / 500f));
+    }
+
+    public void Text(int row, string text, Color color) {
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            AddText(row, "", origin.X, TextAlignment.LEFT);
+        }
+        int i = rowStart[row];
+        SetText(i, text);
+        SetColor(i, color);
+    }
+
+    // value / 10^decimals + unit on the right; the text is only rebuilt when value changes
+    public void Bar(int row, string label, double ratio, int value, int decimals, string unit, Color color) {
+        float track = width * (1 - LABEL_WIDTH - VALUE_WIDTH);
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            float x = origin.X + width * LABEL_WIDTH;
+            AddText(row, label, origin.X, TextAlignment.LEFT);
+            AddBox(new Vector2(x, Middle(row)), new Vector2(track, rowHeight * 0.6f), TRACK);
+            AddBox(new Vector2(x, Middle(row)), new Vector2(0, rowHeight * 0.6f), color);
+            AddText(row, "", origin.X + width, TextAlignment.RIGHT);
+        }
+        int i = rowStart[row];
+
+        int px = (int)(Math.Max(0, Math.Min(1, ratio)) * track);
+        MySprite fill = sprites[i + 2];
+        if (drawn[i + 2] != px) {
+            drawn[i + 2] = px;
+            fill.Size = new Vector2(px, rowHeight * 0.6f);
+            sprites[i + 2] = fill;
+            dirty = true;
+        }
+        SetColor(i + 2, color);
+
+        if (drawn[i + 3] != value) {
+            drawn[i + 3] = value;
+            string text = decimals == 0 ? value.ToString() : (value / Math.Pow(10, decimals)).ToString("F" + decimals);
+            SetText(i + 3, text + unit);
+        }
+    }
+
+    // Appends one sample (NaN: no new sample, the row is left as it is); full
+    // height is scale, or the largest sample shown when scale is 0. Negative
+    // samples grow downwards in the second color.
+    public void Spark(int row, string label, double sample, double scale, Color up, Color down) {
+        float half = rowHeight * 0.4f;
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            AddText(row, label, origin.X, TextAlignment.LEFT);
+            float step = width * (1 - LABEL_WIDTH) / SPARK_SAMPLES;
+            for (int k = 0; k < SPARK_SAMPLES; k++) {
+                float x = origin.X + width * LABEL_WIDTH + k * step;
+                AddBox(new Vector2(x, Middle(row)), new Vector2(step * 0.8f, 0), up);
+            }
+            samples[row] = new double[SPARK_SAMPLES];
+        }
+        if (double.IsNaN(sample)) return;
+        int first = rowStart[row] + 1;
+
+        double[] ring = samples[row];
+        Array.Copy(ring, 1, ring, 0, SPARK_SAMPLES - 1);
+        ring[SPARK_SAMPLES - 1] = sample;
+        double peak = scale;
+        if (peak <= 0) {
+            for (int k = 0; k < SPARK_SAMPLES; k++) peak = Math.Max(peak, Math.Abs(ring[k]));
+        }
+
+        for (int k = 0; k < SPARK_SAMPLES; k++) {
+            int px = peak > 0 ? (int)(Math.Max(-1, Math.Min(1, ring[k] / peak)) * half) : 0;
+            int i = first + k;
+            if (drawn[i] == px) continue;
+
+            drawn[i] = px;
+            MySprite column = sprites[i];
+            column.Size = new Vector2(column.Size.Value.X, Math.Abs(px));
+            column.Position = new Vector2(column.Position.Value.X, Middle(row) - px / 2f);
+            column.Color = px >= 0 ? up : down;
+            sprites[i] = column;
+            dirty = true;
+        }
+    }
+
+    // Sends the retained sprites if anything moved; false when nothing was sent
+    public bool Draw() {
+        if (Surface.ContentType != ContentType.SCRIPT) {  // back from text mode
+            Surface.ContentType = ContentType.SCRIPT;
+            Surface.Script = "";
+            dirty = true;
+        }
+        if (!dirty) return false;
+
+        dirty = false;
+        using (MySpriteDrawFrame frame = Surface.DrawFrame()) {
+            for (int i = 0; i < sprites.Count; i++) frame.Add(sprites[i]);
+        }
+        return true;
+    }
+
+    float Middle(int row) { return origin.Y + (row + 0.5f) * rowHeight; }
+
+    void AddText(int row, string text, float x, TextAlignment alignment) {
+        float y = Middle(row) - 15f * textScale;  // text is positioned by its top
+        sprites.Add(new MySprite(SpriteType.TEXT, text, new Vector2(x, y), null, Color.White, "Debug", alignment, textScale));
+        drawn.Add(int.MinValue);
+        dirty = true;
+    }
+
+    void AddBox(Vector2 position, Vector2 size, Color color) {
+        sprites.Add(new MySprite(SpriteType.TEXTURE, "SquareSimple", position, size, color, null, TextAlignment.LEFT));
+        drawn.Add(int.MinValue);
+        dirty = true;
+    }
+
+    void SetText(int index, string text) {
+        MySprite sprite = sprites[index];
+        if (sprite.Data == text) return;
+        sprite.Data = text;
+        sprites[index] = sprite;
+        dirty = true;
+    }
+
+    void SetColor(int index, Color color) {
+        MySprite sprite = sprites[index];
+        if (sprite.Color.Value == color) return;
+        sprite.Color = color;
+        sprites[index] = sprite;
+        dirty = true;
+    }
+}
+
+// Sheds features when this PB gets expensive for the server (dedicated
+// servers throttle or stop PBs on their average run time). Every run is
+// sampled (Runtime.LastRunTimeMs, instructions); when the window average goes
+// over budget the level rises one step, under half the budget it drops one
+// step, at most one change per window. Features shed in this order:
+// 1 slower refresh, 2 per-tag breakdowns, 3 rates, 4 everything but a minimal frame.
+class Governor {
+    public const int SLOWER = 1, NO_TAGS = 2, NO_RATES = 3, MINIMAL = 4;
+    static readonly string[] LevelNames = { "full", "slower refresh", "no breakdown", "no rates", "minimal frame" };
+    readonly double[] ms;
+    readonly int[] instructions;
+    readonly double budgetMs;
+    readonly int budgetInstructions;
+    int head, count, sinceChange;
+    double sumMs;
+    long sumInstructions;
+    public int Level;
+    public string Status = "";
+
+    public Governor(int window, double budgetMs, int budgetInstructions) {
+        ms = new double[window];
+        instructions = new int[window];
+        this.budgetMs = budgetMs;
+        this.budgetInstructions = budgetInstructions;
+    }
+
+    public bool Allows(int feature) { return Level < feature; }
+    public double AverageMs { get { return count > 0 ? sumMs / count : 0; } }
+    public double AverageInstructions { get { return count > 0 ? (double)sumInstructions / count : 0; } }
+
+    // lastRunMs: the previous run (Runtime.LastRunTimeMs); used: this run's instructions
+    public void Sample(double lastRunMs, int used) {
+        if (count == ms.Length) { sumMs -= ms[head]; sumInstructions -= instructions[head]; }
+        else count++;
+        ms[head] = lastRunMs;
+        instructions[head] = used;
+        sumMs += lastRunMs;
+        sumInstructions += used;
+        head = (head + 1) % ms.Length;
+        if (++sinceChange < ms.Length || count < ms.Length) return;
+
+        double load = Math.Max(AverageMs / budgetMs, AverageInstructions / budgetInstructions);
+        int previous = Level;
+        if (load > 1 && Level < MINIMAL) Level++;
+        else if (load < 0.5 && Level > 0) Level--;
+        if (Level == previous) return;
+        sinceChange = 0;
+        Status = Level == 0 ? "" : "Governor: " + LevelNames[Level] + " (" + AverageMs.ToString("0.00") + " ms/run)";
+    }
+}
+
+// Finds every keyword and tag of the script in a block name in one pass
+// (Aho-Corasick automaton, case-insensitive), plus the path of every [tag]
+// ("Miner1:Cargo", ":"-separated, each path once).
+// Results are cached per block until its name changes.
+// Keyword("Locked") matches anywhere; Tag("[YST") matches "[YST]" and
+// "[YST:n]" (index n) but not "[YST LOG]".
+class NameMatcher {
+    readonly List<Dictionary<char, int>> next = new List<Dictionary<char, int>> { new Dictionary<char, int>() };
+    readonly List<int> fail = new List<int> { 0 }, ends = new List<int> { 0 };
+    int count, tagMask, sweep;
+    readonly Dictionary<long, NameMatch> cache = new Dictionary<long, NameMatch>();
+
+    public int Keyword(string text) { return Add(text, false); }
+    public int Tag(string prefix) { return Add(prefix, true); }
+
+    int Add(string text, bool tag) {
+        int id = count++;
+        if (id == 32) throw new Exception("NameMatcher: 32 patterns max");
+        int s = 0;
+        foreach (char raw in text) {
+            char c = char.ToUpperInvariant(raw);
+            int t;
+            if (!next[s].TryGetValue(c, out t)) {
+                t = next.Count;
+                next.Add(new Dictionary<char, int>());
+                fail.Add(0);
+                ends.Add(0);
+                next[s][c] = t;
+            }
+            s = t;
+        }
+        ends[s] |= 1 << id;
+        if (tag) tagMask |= 1 << id;
+        return id;
+    }
+
+    // Failure links, breadth first; call once after the last Keyword/Tag
+    public void Build() {
+        var queue = new Queue<int>();
+        foreach (var t in next[0].Values) queue.Enqueue(t);
+        while (queue.Count > 0) {
+            int s = queue.Dequeue();
+            foreach (var kv in next[s]) {
+                int f = fail[s], t;
+                while (f > 0 && !next[f].ContainsKey(kv.Key)) f = fail[f];
+                fail[kv.Value] = next[f].TryGetValue(kv.Key, out t) ? t : 0;
+                ends[kv.Value] |= ends[fail[kv.Value]];
+                queue.Enqueue(kv.Value);
+            }
+        }
+    }
+
+    public NameMatch Match(IMyTerminalBlock block) {
+        NameMatch m;
+        string name = block.CustomName;
+        if (!cache.TryGetValue(block.EntityId, out m)) cache[block.EntityId] = m = new NameMatch(count);
+        else if (m.Name == name) { m.Sweep = sweep; return m; }
+        Scan(name, m);
+        m.Sweep = sweep;
+        return m;
+    }
+
+    public NameMatch Match(string name) {
+        var m = new NameMatch(count);
+        Scan(name, m);
+        return m;
+    }
+
+    // Forgets the blocks not matched since the previous call (call after a rescan)
+    public void Sweep() {
+        var gone = new List<long>();
+        foreach (var kv in cache) if (kv.Value.Sweep != sweep) gone.Add(kv.Key);
+        foreach (var id in gone) cache.Remove(id);
+        sweep++;
+    }
+
+    void Scan(string name, NameMatch m) {
+        m.Name = name;
+        m.Hits = 0;
+        m.Tags.Clear();
+        for (int i = 0; i < m.Index.Length; i++) m.Index[i] = -1;
+        if (name == null) return;
+
+        int s = 0, open = -1;
+        for (int i = 0; i < name.Length; i++) {
+            char c = char.ToUpperInvariant(name[i]);
+            if (c == '[') open = i;
+            else if (c == ']' && open >= 0) {
+                AddTag(name, open + 1, i, m);
+                open = -1;
+            }
+
+            int t;
+            while (s > 0 && !next[s].ContainsKey(c)) s = fail[s];
+            s = next[s].TryGetValue(c, out t) ? t : 0;
+            for (int hits = ends[s]; hits != 0; hits &= hits - 1) {
+                int id = 0;
+                while ((hits & (1 << id)) == 0) id++;
+                if ((tagMask & (1 << id)) == 0) m.Hits |= 1 << id;
+                else TagEnd(name, i + 1, id, m);
+            }
+        }
+    }
+
+    // Segments trimmed, a last numeric one is an index: "[Hangar:2]" -> "Hangar"
+    static void AddTag(string name, int start, int end, NameMatch m) {
+        string[] parts = name.Substring(start, end - start).Split(':');
+        int count = parts.Length, index;
+        if (count > 1 && int.TryParse(parts[count - 1], out index)) count--;
+        for (int i = 0; i < count; i++) {
+            parts[i] = parts[i].Trim();
+            if (parts[i].Length == 0) return;
+        }
+        string tag = string.Join(":", parts, 0, count);
+        foreach (var t in m.Tags) if (string.Equals(t, tag, StringComparison.OrdinalIgnoreCase)) return;
+        m.Tags.Add(tag);
+    }
+
+    // After a tag prefix: "]" (no index) or ":digits]"
+    static void TagEnd(string name, int at, int id, NameMatch m) {
+        if (at >= name.Length) return;
+        if (name[at] == ']') { m.Hits |= 1 << id; return; }
+        if (name[at] != ':') return;
+        int value = 0, i = at + 1;
+        while (i < name.Length && char.IsDigit(name[i]) && value < 100000) value = value * 10 + name[i++] - '0';
+        if (i == at + 1 || i >= name.Length || name[i] != ']') return;
+        if ((m.Hits & (1 << id)) == 0) m.Index[id] = value;
+        m.Hits |= 1 << id;
+    }
+}
+
+class NameMatch {
+    public string Name;
+    public int Hits, Sweep;
+    public readonly int[] Index;                            // per Tag(): ":n" index, -1 = none
+    public readonly List<string> Tags = new List<string>(); // every [tag] path, e.g. "Hangar" for [Hangar:2], "Miner1:Cargo"
+    public NameMatch(int patterns) { Index = new int[patterns]; }
+    public bool Has(int id) { return (Hits & (1 << id)) != 0; }
+}
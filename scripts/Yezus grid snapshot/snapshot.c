@@ -0,0 +1,285 @@
+// === [YSNAP Grid Snapshot v1] ===
+// Captures the terminal system into a compact text snapshot for the offline
+// harness (tools/harness, "replay"). Sliced over several runs so a 3k-block
+// base stays under the instruction limit; "watch" appends delta frames.
+// Output goes to the Custom Data of every [SNAP] block (split in parts),
+// or to this PB's Custom Data when there is none.
+
+const string SNAP_TAG = "[SNAP]";
+const bool WHOLE_TERMINAL = true;  // false = this construct only (no docked ships)
+const int BLOCKS_PER_RUN = 150;    // blocks captured per run
+const double WATCH_SECONDS = 60;   // delta frame period in "watch" mode
+const int PART_CHARS = 60000;      // Custom Data size per [SNAP] block
+const int MAX_CHARS = 900000;      // watch stops once the snapshot reaches this
+const int MAX_CUSTOM_DATA = 2000;  // longer Custom Data is not captured
+
+// Block kinds, tested in this order (first match wins)
+const char K_TANK = 'T', K_BATTERY = 'B', K_PRODUCER = 'P', K_THRUST = 'H', K_COCKPIT = 'C',
+    K_CONTROLLER = 'R', K_CARGO = 'K', K_PRODUCTION = 'F', K_GAS = 'Y', K_CONNECTOR = 'N', K_PB = 'G', K_PANEL = 'L', K_SURFACES = 'S', K_OTHER = '-';
+
+List<IMyTerminalBlock> blocks = new List<IMyTerminalBlock>();
+Dictionary<long, int> indexById = new Dictionary<long, int>();
+Dictionary<IMyCubeGrid, int> gridIndex = new Dictionary<IMyCubeGrid, int>();
+List<IMyTerminalBlock> gridRep = new List<IMyTerminalBlock>();
+List<int> gridConstruct = new List<int>();
+List<MyInventoryItem> items = new List<MyInventoryItem>();
+List<MyProductionItem> queue = new List<MyProductionItem>();
+List<IMyTerminalBlock> targets = new List<IMyTerminalBlock>();
+string[] last;                     // dynamic lines of the previous frame, per block
+bool[] down;                       // not working in the previous frame
+System.Text.StringBuilder snap = new System.Text.StringBuilder();
+System.Text.StringBuilder line = new System.Text.StringBuilder();
+System.Globalization.CultureInfo inv = System.Globalization.CultureInfo.InvariantCulture;
+MatrixD toLocal;
+
+int state;                         // 0 idle, 1 full capture, 2 watching, 3 delta pass
+int cursor, frames, changed;
+bool watch;
+double clock, sinceFrame;
+
+public Program() {
+    Runtime.UpdateFrequency = UpdateFrequency.None;
+    Echo("YSNAP: run \"capture\" or \"watch\"");
+}
+
+public void Main(string arg, UpdateType src) {
+    clock += Runtime.TimeSinceLastRun.TotalSeconds;
+    sinceFrame += Runtime.TimeSinceLastRun.TotalSeconds;
+    arg = (arg ?? "").Trim().ToLowerInvariant();
+
+    if (arg == "capture" || arg == "watch") { Start(arg == "watch"); return; }
+    if (arg == "stop") { Stop("stopped"); return; }
+
+    if (state == 1) Capture();
+    else if (state == 3) Delta();
+    else if (state == 2 && sinceFrame >= WATCH_SECONDS) { sinceFrame = 0; StartDelta(); }
+}
+
+void Start(bool watching) {
+    blocks.Clear(); indexById.Clear(); gridIndex.Clear(); gridRep.Clear(); gridConstruct.Clear();
+    GridTerminalSystem.GetBlocks(blocks);
+    if (!WHOLE_TERMINAL) blocks.RemoveAll(b => !b.IsSameConstructAs(Me));
+    for (int i = 0; i < blocks.Count; i++) indexById[blocks[i].EntityId] = i;
+    last = new string[blocks.Count];
+    down = new bool[blocks.Count];
+    toLocal = MatrixD.Transpose(Me.CubeGrid.WorldMatrix);
+
+    watch = watching;
+    snap.Clear();
+    snap.Append("YSNAP 1\n");
+    snap.Append("# ").Append(Me.CubeGrid.CustomName).Append(", ").Append(blocks.Count).Append(" blocks\n");
+    clock = 0; sinceFrame = 0; frames = 1; cursor = 0;
+    snap.Append("T 0\n");
+    Grid(Me); // the reference grid is always grid 0
+    state = 1;
+    Runtime.UpdateFrequency = UpdateFrequency.Update10;
+}
+
+void Stop(string why) {
+    state = 0;
+    Runtime.UpdateFrequency = UpdateFrequency.None;
+    Write();
+    Echo("YSNAP " + why + ": " + blocks.Count + " blocks, " + frames + " frame(s), " + snap.Length + " chars");
+}
+
+// Static description + first dynamic values, BLOCKS_PER_RUN at a time
+void Capture() {
+    int end = Math.Min(blocks.Count, cursor + BLOCKS_PER_RUN);
+    for (int i = cursor; i < end; i++) {
+        var b = blocks[i];
+        int g = Grid(b);
+        char kind = Kind(b);
+        var def = b.BlockDefinition;
+        string type = def.TypeIdString ?? "";
+        if (type.StartsWith("MyObjectBuilder_")) type = type.Substring(16);
+
+        snap.Append("B ").Append(g).Append(' ').Append(kind).Append(' ').Append(Token(type)).Append(' ')
+            .Append(Token(def.SubtypeName)).Append(' ').Append(OneLine(b.CustomName)).Append('\n');
+        if (!string.IsNullOrEmpty(b.CustomData) && b.CustomData.Length <= MAX_CUSTOM_DATA)
+            snap.Append("D ").Append(Escape(b.CustomData)).Append('\n');
+
+        var sp = b as IMyTextSurfaceProvider;
+        if (sp != null && sp.SurfaceCount > 0) {
+            snap.Append("S ");
+            for (int s = 0; s < sp.SurfaceCount; s++) {
+                var size = sp.GetSurface(s).SurfaceSize;
+                if (s > 0) snap.Append(',');
+                snap.Append(Num(size.X)).Append('x').Append(Num(size.Y));
+            }
+            snap.Append('\n');
+        }
+        if (kind == K_THRUST || kind == K_COCKPIT || kind == K_CONTROLLER) {
+            snap.Append("O ");
+            Vec(snap, Vector3D.TransformNormal(b.WorldMatrix.Forward, toLocal)); snap.Append(' ');
+            Vec(snap, Vector3D.TransformNormal(b.WorldMatrix.Up, toLocal)); snap.Append('\n');
+        }
+
+        last[i] = Dynamic(i, b, kind);
+        down[i] = !b.IsWorking;
+        snap.Append(last[i]);
+    }
+    cursor = end;
+    Echo("YSNAP capturing " + cursor + "/" + blocks.Count);
+    if (cursor < blocks.Count) return;
+
+    if (watch) { state = 2; Runtime.UpdateFrequency = UpdateFrequency.Update100; Write(); Echo("YSNAP watching, frame 1"); }
+    else Stop("done");
+}
+
+void StartDelta() {
+    if (snap.Length >= MAX_CHARS) { Stop("full"); return; }
+    snap.Append("T ").Append(Num(clock)).Append('\n');
+    frames++; cursor = 0; changed = 0;
+    state = 3;
+    Runtime.UpdateFrequency = UpdateFrequency.Update10;
+}
+
+// Only the dynamic lines that changed since the previous frame
+void Delta() {
+    int end = Math.Min(blocks.Count, cursor + BLOCKS_PER_RUN);
+    for (int i = cursor; i < end; i++) {
+        var b = blocks[i];
+        if (b.Closed) continue;
+        string d = Dynamic(i, b, Kind(b));
+        if (d == last[i]) continue;
+        snap.Append(d);
+        if (b.IsWorking && down[i]) snap.Append("X ").Append(i).Append(" 1\n");
+        down[i] = !b.IsWorking;
+        last[i] = d;
+        changed++;
+    }
+    cursor = end;
+    if (cursor < blocks.Count) return;
+
+    state = 2;
+    Runtime.UpdateFrequency = UpdateFrequency.Update100;
+    Write();
+    Echo("YSNAP watching, frame " + frames + ": " + changed + " changed, " + snap.Length + " chars");
+}
+
+int Grid(IMyTerminalBlock b) {
+    int g;
+    if (gridIndex.TryGetValue(b.CubeGrid, out g)) return g;
+    g = gridRep.Count;
+    int construct = g;
+    for (int i = 0; i < gridRep.Count; i++)
+        if (gridRep[i].IsSameConstructAs(b)) { construct = gridConstruct[i]; break; }
+    gridIndex[b.CubeGrid] = g;
+    gridRep.Add(b);
+    gridConstruct.Add(construct);
+    var grid = b.CubeGrid;
+    snap.Append("G ").Append(grid.GridSizeEnum == MyCubeSize.Large ? 'L' : 'S').Append(' ')
+        .Append(grid.IsStatic ? 1 : 0).Append(' ').Append(construct).Append(' ').Append(OneLine(grid.CustomName)).Append('\n');
+    return g;
+}
+
+char Kind(IMyTerminalBlock b) {
+    if (b is IMyGasTank) return K_TANK;
+    if (b is IMyBatteryBlock) return K_BATTERY;
+    if (b is IMyPowerProducer) return K_PRODUCER;
+    if (b is IMyThrust) return K_THRUST;
+    if (b is IMyCockpit) return K_COCKPIT;
+    if (b is IMyShipController) return K_CONTROLLER;
+    if (b is IMyCargoContainer) return K_CARGO;
+    if (b is IMyProductionBlock) return K_PRODUCTION;
+    if (b is IMyGasGenerator || b is IMyAirVent || b is IMyOxygenFarm) return K_GAS;
+    if (b is IMyShipConnector) return K_CONNECTOR;
+    if (b is IMyProgrammableBlock) return K_PB;
+    if (b is IMyTextPanel) return K_PANEL;
+    if (b is IMyTextSurfaceProvider) return K_SURFACES;
+    return K_OTHER;
+}
+
+// One line per changing value group, prefixed with the block index
+string Dynamic(int i, IMyTerminalBlock b, char kind) {
+    line.Clear();
+    for (int n = 0; n < b.InventoryCount; n++) {
+        var v = b.GetInventory(n);
+        line.Append("I ").Append(i).Append(' ').Append(n).Append(' ').Append(Num((double)v.MaxVolume));
+        items.Clear();
+        v.GetItems(items);
+        for (int k = 0; k < items.Count; k++) {
+            line.Append(' ').Append(items[k].Type.TypeId.Substring(16)).Append('/').Append(items[k].Type.SubtypeId)
+                .Append('=').Append(Num((double)items[k].Amount));
+        }
+        line.Append('\n');
+    }
+
+    if (kind == K_TANK) {
+        var t = (IMyGasTank)b;
+        line.Append("Q ").Append(i).Append(' ').Append(Num(t.Capacity)).Append(' ').Append(Num(t.FilledRatio)).Append('\n');
+    } else if (kind == K_BATTERY) {
+        var p = (IMyBatteryBlock)b;
+        line.Append("E ").Append(i).Append(' ').Append(Num(p.CurrentStoredPower)).Append(' ').Append(Num(p.MaxStoredPower))
+            .Append(' ').Append(Num(p.CurrentOutput)).Append(' ').Append(Num(p.MaxOutput)).Append('\n');
+    } else if (kind == K_PRODUCER) {
+        var p = (IMyPowerProducer)b;
+        line.Append("W ").Append(i).Append(' ').Append(Num(p.CurrentOutput)).Append(' ').Append(Num(p.MaxOutput)).Append('\n');
+    } else if (kind == K_THRUST) {
+        var t = (IMyThrust)b;
+        line.Append("H ").Append(i).Append(' ').Append(Num(t.MaxEffectiveThrust)).Append(' ').Append(Num(t.MaxThrust))
+            .Append(' ').Append(Num(t.CurrentThrust)).Append('\n');
+    } else if (kind == K_CONNECTOR) {
+        var c = (IMyShipConnector)b;
+        int other = -1;
+        if (c.OtherConnector != null) indexById.TryGetValue(c.OtherConnector.EntityId, out other);
+        line.Append("C ").Append(i).Append(' ').Append((int)c.Status).Append(' ').Append(other).Append('\n');
+    } else if (kind == K_PRODUCTION) {
+        var p = (IMyProductionBlock)b;
+        queue.Clear();
+        p.GetQueue(queue);
+        double queued = 0;
+        for (int k = 0; k < queue.Count; k++) queued += (double)queue[k].Amount;
+        line.Append("F ").Append(i).Append(' ').Append(p.IsProducing ? 1 : 0).Append(' ').Append(queue.Count)
+            .Append(' ').Append(Num(queued)).Append('\n');
+    } else if (kind == K_GAS) {
+        var vent = b as IMyAirVent;
+        var farm = b as IMyOxygenFarm;
+        if (vent != null) line.Append("V ").Append(i).Append(' ').Append((int)vent.Status).Append('\n');
+        else if (farm != null) line.Append("V ").Append(i).Append(' ').Append(Num(farm.GetOutput())).Append('\n');
+    } else if (kind == K_COCKPIT || kind == K_CONTROLLER) {
+        var c = (IMyShipController)b;
+        var m = c.CalculateShipMass();
+        line.Append("M ").Append(i).Append(' ').Append(c.IsMainCockpit ? 1 : 0).Append(' ').Append(Num(m.BaseMass)).Append(' ')
+            .Append(Num(m.TotalMass)).Append(' ').Append(Num(m.PhysicalMass)).Append(' ');
+        Vec(line, Vector3D.TransformNormal(c.GetNaturalGravity(), toLocal));
+        line.Append('\n');
+    }
+
+    if (!b.IsWorking) line.Append("X ").Append(i).Append(" 0\n");
+    return line.ToString();
+}
+
+// Splits on line boundaries into the [SNAP] blocks, in name order
+void Write() {
+    targets.Clear();
+    GridTerminalSystem.SearchBlocksOfName(SNAP_TAG, targets, b => b.IsSameConstructAs(Me));
+    targets.Sort((a, b) => string.CompareOrdinal(a.CustomName, b.CustomName));
+    if (targets.Count == 0) targets.Add(Me);
+
+    string text = snap.ToString();
+    int pos = 0;
+    for (int t = 0; t < targets.Count; t++) {
+        int end = Math.Min(text.Length, pos + PART_CHARS);
+        if (end < text.Length) {
+            int nl = text.LastIndexOf('\n', end - 1, end - pos);
+            if (nl > pos) end = nl + 1;
+        }
+        string part = "# part " + (t + 1) + "/" + targets.Count + "\n" + text.Substring(pos, end - pos);
+        targets[t].CustomData = part;
+        pos = end;
+    }
+    if (pos < text.Length) Echo("YSNAP: " + (text.Length - pos) + " chars did not fit, add [SNAP] blocks");
+}
+
+string Num(double v) { return v.ToString("0.###", inv); }
+
+void Vec(System.Text.StringBuilder sb, Vector3D v) {
+    sb.Append(Num(v.X)).Append(',').Append(Num(v.Y)).Append(',').Append(Num(v.Z));
+}
+
+string Token(string s) { return string.IsNullOrEmpty(s) ? "_" : s.Replace(' ', '_'); }
+
+string OneLine(string s) { return (s ?? "").Replace('\n', ' ').Replace('\r', ' '); }
+
+string Escape(string s) { return s.Replace("\\", "\\\\").Replace("\r", "").Replace("\n", "\\n"); }
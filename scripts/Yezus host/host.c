@@ -0,0 +1,335 @@
+// === [YHOST Task Host v1] ===
+// Runs several scripts (YIM, YSI, the storage monitor...) as cooperative tasks
+// in one PB: one shared block scan, one profiler, per-task priorities and
+// instruction budgets, and each task's own update frequency as its sleep
+// interval. Arguments go to one task with a "name:" prefix, to all without.
+// Tasks are added with the harness: tools/harness bundle (see readme).
+
+const string HOST_TAG = "[YHOST]";  // LCDs showing the profiler
+const double SCAN_SECONDS = 3;      // shared block list refreshed at most this often
+const int RUN_BUDGET = 30000;       // instructions tasks may use per run (game limit 50000)
+const int MAX_DEFER_RUNS = 20;      // a deferred task runs anyway after this many runs
+const string STORAGE_VERSION = "YHOST1";
+
+// "name priority budget": lower priority runs first; budget = expected
+// instructions per run, exceeding it is flagged in the profiler
+string[] TASK_CONFIG = { "monitor 0 8000", "yim 1 8000", "ysi 2 12000", "yst 3 12000" };
+
+List<HostTask> tasks = new List<HostTask>();
+SharedTerminal terminal = new SharedTerminal();
+List<IMyTextPanel> hostPanels = new List<IMyTextPanel>();
+List<IMyBroadcastListener> listenerBuffer = new List<IMyBroadcastListener>();
+HashSet<IMyBroadcastListener> claimedListeners = new HashSet<IMyBroadcastListener>();
+System.Text.StringBuilder profile = new System.Text.StringBuilder();
+double clock;
+int lastCost, maxCost, runs;
+
+// Stand-in for GridTerminalSystem inside tasks: block queries are answered
+// from one list, scanned at most every SCAN_SECONDS for all tasks together.
+// Name and id lookups go to the real terminal system (always current).
+class SharedTerminal {
+    public IMyGridTerminalSystem Gts;
+    public double Now, ScannedAt = -1e9;
+    public int Scans;
+    readonly List<IMyTerminalBlock> blocks = new List<IMyTerminalBlock>();
+
+    void Ensure() {
+        if (Now - ScannedAt < SCAN_SECONDS) return;
+        blocks.Clear();
+        Gts.GetBlocks(blocks);
+        ScannedAt = Now;
+        Scans++;
+    }
+
+    public void Invalidate() { ScannedAt = -1e9; }
+
+    public void GetBlocks(List<IMyTerminalBlock> list) {
+        Ensure();
+        list.Clear();
+        for (int i = 0; i < blocks.Count; i++) if (!blocks[i].Closed) list.Add(blocks[i]);
+    }
+
+    public void GetBlocksOfType<T>(List<T> list, Func<T, bool> collect = null) where T : class {
+        Ensure();
+        list.Clear();
+        for (int i = 0; i < blocks.Count; i++) {
+            var t = blocks[i] as T;
+            if (t != null && !blocks[i].Closed && (collect == null || collect(t))) list.Add(t);
+        }
+    }
+
+    public void SearchBlocksOfName(string name, List<IMyTerminalBlock> list, Func<IMyTerminalBlock, bool> collect = null) {
+        Ensure();
+        list.Clear();
+        for (int i = 0; i < blocks.Count; i++) {
+            var b = blocks[i];
+            if (!b.Closed && b.CustomName.IndexOf(name, StringComparison.OrdinalIgnoreCase) >= 0 && (collect == null || collect(b))) list.Add(b);
+        }
+    }
+
+    public IMyTerminalBlock GetBlockWithName(string name) { return Gts.GetBlockWithName(name); }
+    public IMyTerminalBlock GetBlockWithId(long id) { return Gts.GetBlockWithId(id); }
+}
+
+// Stand-in for Runtime inside tasks
+class TaskRuntime {
+    public IMyGridProgramRuntimeInfo Host;
+    public UpdateFrequency UpdateFrequency;
+    public TimeSpan TimeSinceLastRun;
+    public int Start;
+    public double LastRunTimeMs { get { return Host.LastRunTimeMs; } }
+    public int MaxInstructionCount { get { return Host.MaxInstructionCount; } }
+    public int CurrentInstructionCount { get { return Host.CurrentInstructionCount - Start; } }
+}
+
+// A script hosted as a task: the members a script uses from MyGridProgram
+abstract class HostTask {
+    public readonly string Name;
+    public SharedTerminal GridTerminalSystem;
+    public IMyProgrammableBlock Me;
+    public TaskRuntime Runtime = new TaskRuntime();
+    public Action<string> Echo;
+    public IMyIntergridCommunicationSystem IGC; // shared: one endpoint for all tasks
+    public List<IMyBroadcastListener> Listeners = new List<IMyBroadcastListener>(); // registered by this task
+    public string Storage = "";
+
+    public int Priority = 5, Budget = 5000;
+    public System.Text.StringBuilder EchoText = new System.Text.StringBuilder();
+    public UpdateType Pending;
+    public double LastRun, AvgCost;
+    public int Runs, MaxCost, Deferred, OverBudget, Waiting;
+    public string Error;
+
+    protected HostTask(string name) {
+        Name = name;
+        Echo = text => EchoText.Append(text).Append('\n');
+    }
+
+    public virtual void Init() { }
+    public virtual void Main(string argument, UpdateType updateSource) { }
+    public virtual void Save() { }
+}
+
+public Program() {
+    terminal.Gts = GridTerminalSystem;
+    Register();
+    ApplyConfig();
+    tasks.Sort((a, b) => a.Priority != b.Priority ? a.Priority.CompareTo(b.Priority) : string.CompareOrdinal(a.Name, b.Name));
+    LoadStorage();
+
+    foreach (var t in tasks) {
+        t.GridTerminalSystem = terminal;
+        t.Me = Me;
+        t.IGC = IGC;
+        t.Runtime.Host = Runtime;
+        t.Runtime.Start = Runtime.CurrentInstructionCount;
+        try { t.Init(); }
+        catch (Exception e) { Fail(t, e); }
+        ClaimListeners(t);
+    }
+    GridTerminalSystem.GetBlocksOfType(hostPanels, p => p.IsSameConstructAs(Me) && p.CustomName.Contains(HOST_TAG));
+    UpdateFrequencyFromTasks();
+    if (tasks.Count == 0) Echo("YHOST: no task bundled (tools/harness bundle)");
+}
+
+// Bundled tasks (tools/harness bundle fills this in)
+void Register() {
+    // @register
+}
+
+void Add(HostTask task) { tasks.Add(task); }
+
+void ApplyConfig() {
+    foreach (var line in TASK_CONFIG) {
+        var f = line.Split(' ');
+        foreach (var t in tasks) {
+            if (!t.Name.Equals(f[0], StringComparison.OrdinalIgnoreCase)) continue;
+            int.TryParse(f[1], out t.Priority);
+            int.TryParse(f[2], out t.Budget);
+        }
+    }
+}
+
+public void Save() {
+    var sb = new System.Text.StringBuilder(STORAGE_VERSION);
+    foreach (var t in tasks) {
+        if (t.Error == null) {
+            try { t.Save(); } catch (Exception e) { Fail(t, e); }
+        }
+        sb.Append('\n').Append(t.Name).Append('=').Append((t.Storage ?? "").Replace("\\", "\\\\").Replace("\n", "\\n"));
+    }
+    Storage = sb.ToString();
+}
+
+void LoadStorage() {
+    if (!Storage.StartsWith(STORAGE_VERSION)) return;
+    foreach (var line in Storage.Split('\n')) {
+        int eq = line.IndexOf('=');
+        if (eq <= 0) continue;
+        string name = line.Substring(0, eq);
+        foreach (var t in tasks) if (t.Name == name) t.Storage = Unescape(line.Substring(eq + 1));
+    }
+}
+
+string Unescape(string s) {
+    var sb = new System.Text.StringBuilder(s.Length);
+    for (int i = 0; i < s.Length; i++) {
+        if (s[i] == '\\' && i + 1 < s.Length) { i++; sb.Append(s[i] == 'n' ? '\n' : s[i]); }
+        else sb.Append(s[i]);
+    }
+    return sb.ToString();
+}
+
+public void Main(string argument, UpdateType updateSource) {
+    clock += Runtime.TimeSinceLastRun.TotalSeconds;
+    terminal.Now = clock;
+    runs++;
+
+    if ((updateSource & UpdateType.IGC) != 0) Deliver(argument);
+    else if (!string.IsNullOrWhiteSpace(argument)) Route(argument.Trim(), updateSource);
+
+    const UpdateType ticks = UpdateType.Update1 | UpdateType.Update10 | UpdateType.Update100 | UpdateType.Once;
+    bool ranAny = false;
+    foreach (var t in tasks) {
+        if (t.Error != null) continue;
+        var due = (Ticks(t.Runtime.UpdateFrequency) & updateSource & ticks) | t.Pending;
+        if (due == 0) continue;
+
+        // Over the run budget: wait for a quieter run, unless it waited too long
+        int expected = t.Runs > 0 ? (int)t.AvgCost : t.Budget;
+        if (ranAny && Runtime.CurrentInstructionCount + expected > RUN_BUDGET && t.Waiting < MAX_DEFER_RUNS) {
+            t.Pending = due;
+            t.Waiting++;
+            t.Deferred++;
+            continue;
+        }
+        RunTask(t, "", due);
+        ranAny = true;
+    }
+
+    UpdateFrequencyFromTasks();
+    lastCost = Runtime.CurrentInstructionCount;
+    if (lastCost > maxCost) maxCost = lastCost;
+    ShowProfile();
+}
+
+// A listener callback (argument: the one given to SetMessageCallback) only
+// runs the tasks owning a listener with messages waiting, never the others
+void Deliver(string argument) {
+    foreach (var t in tasks) {
+        if (t.Error != null) continue;
+        foreach (var l in t.Listeners) {
+            if (!l.HasPendingMessage) continue;
+            RunTask(t, argument ?? "", UpdateType.IGC);
+            break;
+        }
+    }
+}
+
+// Listeners that appeared while a task initialized are its own
+void ClaimListeners(HostTask t) {
+    listenerBuffer.Clear();
+    IGC.GetBroadcastListeners(listenerBuffer);
+    foreach (var l in listenerBuffer) {
+        if (claimedListeners.Add(l)) t.Listeners.Add(l);
+    }
+}
+
+// "name:argument" or "name argument" goes to that task, anything else to all
+void Route(string argument, UpdateType updateSource) {
+    if (argument.Equals("host reset", StringComparison.OrdinalIgnoreCase)) {
+        foreach (var t in tasks) { t.Runs = 0; t.AvgCost = 0; t.MaxCost = 0; t.Deferred = 0; t.OverBudget = 0; }
+        maxCost = 0;
+        terminal.Invalidate();
+        return;
+    }
+
+    int cut = argument.IndexOfAny(new[] { ':', ' ' });
+    if (cut > 0) {
+        string name = argument.Substring(0, cut);
+        foreach (var t in tasks) {
+            if (!t.Name.Equals(name, StringComparison.OrdinalIgnoreCase)) continue;
+            if (t.Error == null) RunTask(t, argument.Substring(cut + 1).Trim(), updateSource & ~(UpdateType.Update1 | UpdateType.Update10 | UpdateType.Update100 | UpdateType.Once));
+            return;
+        }
+    }
+    foreach (var t in tasks) if (t.Error == null) RunTask(t, argument, updateSource & ~(UpdateType.Update1 | UpdateType.Update10 | UpdateType.Update100 | UpdateType.Once));
+}
+
+void RunTask(HostTask t, string argument, UpdateType source) {
+    if (source == UpdateType.None) source = UpdateType.Terminal;
+    int start = Runtime.CurrentInstructionCount;
+    t.Runtime.Start = start;
+    t.Runtime.TimeSinceLastRun = TimeSpan.FromSeconds(clock - t.LastRun);
+    t.LastRun = clock;
+    if ((source & UpdateType.Once) != 0) t.Runtime.UpdateFrequency &= ~UpdateFrequency.Once;
+    t.EchoText.Clear();
+
+    try { t.Main(argument, source); }
+    catch (Exception e) { Fail(t, e); }
+
+    int cost = Runtime.CurrentInstructionCount - start;
+    t.AvgCost = t.Runs == 0 ? cost : t.AvgCost * 0.9 + cost * 0.1;
+    if (cost > t.MaxCost) t.MaxCost = cost;
+    if (cost > t.Budget) t.OverBudget++;
+    t.Runs++;
+    t.Pending = UpdateType.None;
+    t.Waiting = 0;
+}
+
+// One failing task is stopped; the others keep running
+void Fail(HostTask t, Exception e) {
+    t.Error = e.GetType().Name + ": " + e.Message;
+    t.Runtime.UpdateFrequency = UpdateFrequency.None;
+}
+
+UpdateType Ticks(UpdateFrequency f) {
+    var u = UpdateType.None;
+    if ((f & UpdateFrequency.Update1) != 0) u |= UpdateType.Update1;
+    if ((f & UpdateFrequency.Update10) != 0) u |= UpdateType.Update10;
+    if ((f & UpdateFrequency.Update100) != 0) u |= UpdateType.Update100;
+    if ((f & UpdateFrequency.Once) != 0) u |= UpdateType.Once;
+    return u;
+}
+
+// The host wakes up as often as its most eager task (deferred tasks: next tick)
+void UpdateFrequencyFromTasks() {
+    var f = UpdateFrequency.None;
+    foreach (var t in tasks) {
+        if (t.Error != null) continue;
+        f |= t.Runtime.UpdateFrequency;
+        if (t.Pending != UpdateType.None) f |= UpdateFrequency.Once;
+    }
+    Runtime.UpdateFrequency = f;
+}
+
+void ShowProfile() {
+    profile.Clear();
+    profile.Append("YHOST ").Append(tasks.Count).Append(" tasks, scans ").Append(terminal.Scans)
+        .Append(", run ").Append(lastCost).Append(" / max ").Append(maxCost).Append(" instr\n");
+    profile.Append("task      prio   runs    avg    max budget defer\n");
+    foreach (var t in tasks) {
+        profile.Append(t.Name.PadRight(9)).Append(t.Priority.ToString().PadLeft(5)).Append(t.Runs.ToString().PadLeft(7))
+            .Append(((int)t.AvgCost).ToString().PadLeft(7)).Append(t.MaxCost.ToString().PadLeft(7))
+            .Append(t.Budget.ToString().PadLeft(7)).Append(t.Deferred.ToString().PadLeft(6));
+        if (t.OverBudget > 0) profile.Append(" !").Append(t.OverBudget);
+        profile.Append('\n');
+        if (t.Error != null) profile.Append("  stopped: ").Append(t.Error).Append('\n');
+    }
+
+    string text = profile.ToString();
+    foreach (var p in hostPanels) {
+        if (p.Closed) continue;
+        p.ContentType = ContentType.TEXT_AND_IMAGE;
+        p.Font = "Monospace";
+        p.WriteText(text);
+    }
+
+    foreach (var t in tasks) {
+        if (t.EchoText.Length == 0) continue;
+        profile.Append("--- ").Append(t.Name).Append('\n').Append(t.EchoText);
+    }
+    Echo(profile.ToString());
+}
+
+// @tasks
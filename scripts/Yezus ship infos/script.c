@@ -1,15 +1,62 @@
-// === [YSI Ship Status v1] ===
-// Displays tagged ship resource levels on a single LCD or cockpit surface.
+// === [YSI Ship Status v2] ===
+// Displays tagged ship resource levels on every tagged LCD or cockpit surface.
 
 const string TAG_LABEL = "[YSI]";
 const string TAG_PREFIX = "[YSI";
+const string SPAN_PREFIX = "YSI:"; // Custom Data line "YSI:GROUP#" spans panels
 const int DEFAULT_SURFACE_INDEX = 0;
 const double REFRESH_SECONDS = 5;
 const string TOTAL_KEY = "__TOTAL__";
-
-IMyTextSurface displaySurface;
-IMyTerminalBlock displayBlock;
-int displaySurfaceIndex = DEFAULT_SURFACE_INDEX;
+const int WATCH_SLICE = 150; // blocks fingerprinted per run by the change detector
+
+// Warm start snapshot kept in Storage: rates, peaks and view survive recompiles
+const string SNAPSHOT_VERSION = "YSI1";
+const int SNAPSHOT_MAX_KEYS = 32;
+const int SNAPSHOT_MAX_KEY_LENGTH = 32;
+const double SNAPSHOT_SCALE = 100.0; // fixed-point, culture independent
+
+// Telemetry bus (IGC): one PB measures and broadcasts every refresh, the
+// others render its packets without reading any block
+const string TELEMETRY_MODE = "off";          // "off", "publish" or "consume"
+const string TELEMETRY_CHANNEL = "YTEL";      // broadcast tag, one per publisher group
+const double TELEMETRY_STALE_SECONDS = 30;    // consumers measure themselves past this
+const string TELEMETRY_VERSION = "YTEL1";
+
+// Gas flows: sources and sinks of H2 / O2, each with its last estimate;
+// FLOW_PER_REFRESH of them are re-read per refresh. A flow is a coefficient
+// derived once per block definition (L/s at full power / thrust / production,
+// approximate vanilla values) times one cheap reading: CurrentThrust,
+// CurrentOutput, farm output, vent status, ice present.
+const int FLOW_PER_REFRESH = 32;
+
+// Governor: sheds features when the PB's average cost over a window of runs
+// goes over budget (see class Governor), restores them as headroom returns
+const double GOVERNOR_BUDGET_MS = 0.25;          // average Runtime.LastRunTimeMs
+const int GOVERNOR_BUDGET_INSTRUCTIONS = 10000;  // average instructions per run
+const int GOVERNOR_WINDOW = 30;                  // runs
+const int GOVERNOR_SLOW_FACTOR = 3;              // refresh interval multiplier once shedding
+
+// Sprite dashboard (class SpriteView) instead of text on unspanned displays:
+// fill bars and H2 / O2 production sparklines, a frame sent only when a bar
+// or column moved by a pixel. Spanned groups stay in text.
+const bool SPRITES = false;
+const int SPRITE_ROWS = 8;
+
+// Layout targets: the tallest frame (4 entries, 2 gas flow lines, a 4-option
+// menu) and the widest bar line
+const int FRAME_LINES = 26;
+const int FRAME_COLUMNS = 35;
+const float MIN_FONT_SIZE = 0.4f;
+const float MAX_FONT_SIZE = 1.4f;
+const int MIN_BAR_LENGTH = 8;
+const int MAX_BAR_LENGTH = 24;
+
+List<DisplayTarget> displays = new List<DisplayTarget>();
+Dictionary<string, List<DisplayTarget>> spanGroups = new Dictionary<string, List<DisplayTarget>>(StringComparer.OrdinalIgnoreCase);
+Dictionary<int, string> frameCache = new Dictionary<int, string>();
+StatusModel model = new StatusModel();
+BlockWatcher blockWatcher;
+Governor governor = new Governor(GOVERNOR_WINDOW, GOVERNOR_BUDGET_MS, GOVERNOR_BUDGET_INSTRUCTIONS);
 
 List<IMyGasTank> hydrogenTanks = new List<IMyGasTank>();
 List<IMyGasTank> oxygenTanks = new List<IMyGasTank>();
@@ -17,10 +64,29 @@ List<IMyBatteryBlock> batteries = new List<IMyBatteryBlock>();
 List<IMyCargoContainer> cargoContainers = new List<IMyCargoContainer>();
 List<IMyPowerProducer> powerProducers = new List<IMyPowerProducer>();
 List<IMyTerminalBlock> displayCandidates = new List<IMyTerminalBlock>();
-
-List<string> scratchTags = new List<string>();
+List<IMyTerminalBlock> flowCandidates = new List<IMyTerminalBlock>();
+List<GasFlow> gasFlows = new List<GasFlow>();
+Dictionary<string, double> flowCoefficients = new Dictionary<string, double>();
+int flowCursor = 0;
+bool flowsSampled = false;
+
+// L/s at full rate by subtype, else by kind (FLOW_GENERATOR... order) and
+// grid size; generators: H2, O2 is half
+Dictionary<string, double> FULL_FLOW_LPS = new Dictionary<string, double> {
+    { "LargeBlockLargeHydrogenThrust", 4820 },
+    { "LargeBlockSmallHydrogenThrust", 803 },
+    { "SmallBlockLargeHydrogenThrust", 386 },
+    { "SmallBlockSmallHydrogenThrust", 80 }
+};
+double[] FULL_FLOW_LARGE = { 1000, 1000, 4820, 300, 1.8 };
+double[] FULL_FLOW_SMALL = { 250, 100, 386, 75, 1.8 };
+
+NameMatcher names = new NameMatcher();
+int displayTagId;
 List<string> menuOptions = new List<string>();
 List<string> removalBuffer = new List<string>();
+List<string> leafTags = new List<string>();
+System.Text.StringBuilder spriteMenu = new System.Text.StringBuilder();
 
 Dictionary<string, ResourceGroup> tagGroups = new Dictionary<string, ResourceGroup>(StringComparer.OrdinalIgnoreCase);
 List<string> tagList = new List<string>();
@@ -36,6 +102,7 @@ Dictionary<string, double> oxygenPeakRate = new Dictionary<string, double>(Strin
 Dictionary<string, double> powerCapacityByTag = new Dictionary<string, double>(StringComparer.OrdinalIgnoreCase);
 double totalPowerOutput = 0;
 double totalPowerCapacity = 0;
+int rateSample = 0; // bumped each time the rates are recomputed (refresh or new packet)
 
 ViewMode currentView = ViewMode.All;
 string currentTagKey = null;
@@ -44,6 +111,12 @@ int selectedOptionIndex = 0;
 
 double secondsSinceLast = 0;
 
+IMyBroadcastListener telemetryListener;
+string telemetryPacket = null;
+double telemetryAge = 1e9;
+bool measuringLocally = true; // false while packets are fresh (block lists not kept up to date)
+int telemetrySequence = 0;
+
 enum ViewMode {
     All,
     Tag
@@ -61,12 +134,18 @@ struct ResourceStats {
     public double Current;
     public double Capacity;
     public int Blocks;
+    public double Produced;
+    public double Consumed;
+    public int FlowBlocks;
 
     public ResourceStats(double fill, double current, double capacity, int blocks) {
         Fill = fill;
         Current = current;
         Capacity = capacity;
         Blocks = blocks;
+        Produced = 0;
+        Consumed = 0;
+        FlowBlocks = 0;
     }
 }
 
@@ -74,11 +153,17 @@ class ResourceAccumulator {
     public double Current;
     public double Capacity;
     public int Count;
+    public double Produced;  // L/s (gases), from the gas flow estimates
+    public double Consumed;
+    public int FlowBlocks;
 
     public void Reset() {
         Current = 0;
         Capacity = 0;
         Count = 0;
+        Produced = 0;
+        Consumed = 0;
+        FlowBlocks = 0;
     }
 
     public void Add(double current, double capacity) {
@@ -87,13 +172,210 @@ class ResourceAccumulator {
         Count++;
     }
 
+    public void Add(ResourceAccumulator other) {
+        Current += other.Current;
+        Capacity += other.Capacity;
+        Count += other.Count;
+        Produced += other.Produced;
+        Consumed += other.Consumed;
+        FlowBlocks += other.FlowBlocks;
+    }
+
+    public void AddFlow(double flow) {
+        if (flow > 0) Produced += flow;
+        else Consumed -= flow;
+        FlowBlocks++;
+    }
+
     public ResourceStats ToStats() {
         double fill = Capacity > 0 ? Current / Capacity : 0;
-        return new ResourceStats(fill, Current, Capacity, Count);
+        ResourceStats stats = new ResourceStats(fill, Current, Capacity, Count);
+        stats.Produced = Produced;
+        stats.Consumed = Consumed;
+        stats.FlowBlocks = FlowBlocks;
+        return stats;
+    }
+}
+
+class StatusModel {
+    public string Header;
+    public ResourceStats Hydrogen;
+    public ResourceStats Oxygen;
+    public ResourceStats Power;
+    public ResourceStats Cargo;
+    public double HydrogenRate;
+    public double OxygenRate;
+    public double PowerOutput;
+    public double HydrogenPeak;
+    public double OxygenPeak;
+    public double PowerCapacity;
+}
+
+class DisplayTarget {
+    public IMyTerminalBlock Block;
+    public IMyTextSurface Surface;
+    public int SurfaceIndex;
+    public string SpanGroup;
+    public int SpanIndex;
+
+    // Cached layout, recomputed only when the surface, font or span changes
+    public TextMetrics Metrics = new TextMetrics();
+    public int LinesNeeded;
+    public float ForcedFont;
+    public float FontSize;
+    public int BarLength = MAX_BAR_LENGTH;
+    public int LineCapacity;
+
+    public SpriteView View; // SPRITES only, created on first draw
+    public int SparkSample = -1; // rateSample of the last spark point
+}
+
+// Font metrics measured with MeasureStringInPixels at scale 1.0. Text scales
+// linearly with FontSize, so one measurement per (font, surface) is enough.
+class TextMetrics {
+    public string Font;
+    public Vector2 SurfaceSize = new Vector2(-1, -1);
+    public float Padding = -1;
+    public float UsableWidth;
+    public float UsableHeight;
+    public float CharWidth;
+    public float FirstLineHeight;
+    public float LineHeight;
+
+    System.Text.StringBuilder probe = new System.Text.StringBuilder();
+
+    public bool Measure(IMyTextSurface surface) {
+        if (surface.Font == Font && surface.SurfaceSize == SurfaceSize && surface.TextPadding == Padding) {
+            return false;
+        }
+
+        Font = surface.Font;
+        SurfaceSize = surface.SurfaceSize;
+        Padding = surface.TextPadding;
+
+        float usable = 1f - Padding / 50f;
+        UsableWidth = SurfaceSize.X * usable;
+        UsableHeight = SurfaceSize.Y * usable;
+
+        probe.Clear().Append('M', 10);
+        CharWidth = Math.Max(1f, surface.MeasureStringInPixels(probe, Font, 1f).X / 10f);
+
+        probe.Clear().Append('M');
+        FirstLineHeight = Math.Max(1f, surface.MeasureStringInPixels(probe, Font, 1f).Y);
+        probe.Append('\n').Append('M');
+        LineHeight = surface.MeasureStringInPixels(probe, Font, 1f).Y - FirstLineHeight;
+        if (LineHeight <= 0) LineHeight = FirstLineHeight;
+
+        return true;
+    }
+
+    public int LinesAt(float fontSize) {
+        float remaining = UsableHeight - FirstLineHeight * fontSize;
+        if (remaining < 0) return 1;
+        return 1 + (int)(remaining / (LineHeight * fontSize));
+    }
+
+    public int ColumnsAt(float fontSize) {
+        return (int)(UsableWidth / (CharWidth * fontSize));
+    }
+}
+
+// Detects built, removed or renamed blocks without rescanning on a timer.
+// Reset() keeps the block list of the last RefreshBlocks with its name
+// fingerprint; each Step() fingerprints one slice of it (closed blocks, name
+// hashes). A pass ends with one typed count query, rotating over the block
+// types this script reads, so a built block is seen within PROBE_KINDS passes
+// without listing the whole terminal system again. A block of another type
+// that is built then tagged shows up on the next change or "refresh".
+class BlockWatcher {
+    const int PROBE_KINDS = 8;
+
+    readonly List<IMyTerminalBlock> blocks = new List<IMyTerminalBlock>();
+    readonly List<IMyTerminalBlock> probe = new List<IMyTerminalBlock>();
+    readonly int[] kindCounts = new int[PROBE_KINDS];
+    readonly Func<IMyTerminalBlock, bool> filter;
+    readonly int sliceSize;
+
+    int cursor;
+    int kind;
+    long nameSum;
+    bool sawClosed;
+    long lastNameSum;
+
+    public BlockWatcher(Func<IMyTerminalBlock, bool> filter, int sliceSize) {
+        this.filter = filter;
+        this.sliceSize = sliceSize;
+    }
+
+    // Once per RefreshBlocks: the only full listing of the terminal system
+    public void Reset(IMyGridTerminalSystem terminal) {
+        terminal.GetBlocksOfType(blocks, filter);
+        lastNameSum = 0;
+        for (int i = 0; i < blocks.Count; i++) lastNameSum += NameHash(blocks[i]);
+        for (int k = 0; k < PROBE_KINDS; k++) kindCounts[k] = Probe(terminal, k);
+        cursor = 0;
+        nameSum = 0;
+        sawClosed = false;
+    }
+
+    public bool Step(IMyGridTerminalSystem terminal) {
+        int end = Math.Min(blocks.Count, cursor + sliceSize);
+        for (int i = cursor; i < end; i++) {
+            IMyTerminalBlock block = blocks[i];
+            if (block.Closed) {
+                sawClosed = true;
+                continue;
+            }
+            nameSum += NameHash(block);
+        }
+        cursor = end;
+
+        if (cursor < blocks.Count) return false;
+
+        bool changed = sawClosed || nameSum != lastNameSum || Probe(terminal, kind) != kindCounts[kind];
+        kind = (kind + 1) % PROBE_KINDS;
+        cursor = 0;
+        nameSum = 0;
+        sawClosed = false;
+        return changed;
+    }
+
+    static long NameHash(IMyTerminalBlock block) {
+        return (long)block.CustomName.GetHashCode() * 31 + (block.EntityId & 0xFFFF);
+    }
+
+    // The filter only runs on blocks of the probed type
+    int Probe(IMyGridTerminalSystem terminal, int k) {
+        switch (k) {
+            case 0: terminal.GetBlocksOfType<IMyGasTank>(probe, filter); break;
+            case 1: terminal.GetBlocksOfType<IMyPowerProducer>(probe, filter); break;
+            case 2: terminal.GetBlocksOfType<IMyCargoContainer>(probe, filter); break;
+            case 3: terminal.GetBlocksOfType<IMyTextSurfaceProvider>(probe, filter); break;
+            case 4: terminal.GetBlocksOfType<IMyThrust>(probe, filter); break;
+            case 5: terminal.GetBlocksOfType<IMyGasGenerator>(probe, filter); break;
+            case 6: terminal.GetBlocksOfType<IMyAirVent>(probe, filter); break;
+            default: terminal.GetBlocksOfType<IMyOxygenFarm>(probe, filter); break;
+        }
+        return probe.Count;
     }
 }
 
+// A source or sink of gas: Hydrogen / Oxygen is its last estimate in L/s,
+// positive when producing
+class GasFlow {
+    public IMyTerminalBlock Block;
+    public int Kind;
+    public double Coefficient;
+    public double Hydrogen;
+    public double Oxygen;
+}
+
+const int FLOW_GENERATOR = 0, FLOW_ENGINE = 1, FLOW_THRUSTER = 2, FLOW_VENT = 3, FLOW_FARM = 4;
+
+// Tag "A:B:C" is a child of "A:B"; the whole construct has no parent
 class ResourceGroup {
+    public string Key;
+    public ResourceGroup Parent;
     public ResourceAccumulator Hydrogen = new ResourceAccumulator();
     public ResourceAccumulator Oxygen = new ResourceAccumulator();
     public ResourceAccumulator Batteries = new ResourceAccumulator();
@@ -105,15 +387,40 @@ class ResourceGroup {
         Batteries.Reset();
         Cargo.Reset();
     }
+
+    public void Add(ResourceGroup other) {
+        Hydrogen.Add(other.Hydrogen);
+        Oxygen.Add(other.Oxygen);
+        Batteries.Add(other.Batteries);
+        Cargo.Add(other.Cargo);
+    }
 }
 
 public Program() {
     Runtime.UpdateFrequency = UpdateFrequency.Update100; // ~1.6 s
+    blockWatcher = new BlockWatcher(b => b.IsSameConstructAs(Me), WATCH_SLICE);
+    displayTagId = names.Tag(TAG_PREFIX);
+    names.Build();
+    if (TELEMETRY_MODE == "consume") {
+        telemetryListener = IGC.RegisterBroadcastListener(TELEMETRY_CHANNEL);
+        telemetryListener.SetMessageCallback(TELEMETRY_CHANNEL);
+    }
+    RestoreSnapshot();
     RefreshBlocks();
     WriteStatus();
 }
 
+public void Save() {
+    Storage = BuildSnapshot();
+}
+
 public void Main(string argument, UpdateType updateSource) {
+    Tick(argument, updateSource);
+    governor.Sample(Runtime.LastRunTimeMs, Runtime.CurrentInstructionCount);
+    if (governor.Level > 0) Echo(governor.Status);
+}
+
+void Tick(string argument, UpdateType updateSource) {
     bool commandHandled = false;
 
     if (!string.IsNullOrWhiteSpace(argument)) {
@@ -144,8 +451,29 @@ public void Main(string argument, UpdateType updateSource) {
         return;
     }
 
+    telemetryAge += Runtime.TimeSinceLastRun.TotalSeconds;
+    if ((updateSource & UpdateType.IGC) != 0) {
+        if (ReceiveTelemetry()) {
+            secondsSinceLast = 0;
+            WriteStatus();
+        }
+        return;
+    }
+
+    // Fresh packets: no block is read at all. Once they go stale the lists
+    // are rebuilt (the watcher was paused) and the local scan takes over.
+    if (TelemetryFresh()) {
+        measuringLocally = false;
+    } else if (!measuringLocally) {
+        measuringLocally = true;
+        RefreshBlocks();
+    } else if (blockWatcher.Step(GridTerminalSystem)) {
+        RefreshBlocks();
+    }
+
     secondsSinceLast += Runtime.TimeSinceLastRun.TotalSeconds;
-    if (secondsSinceLast < REFRESH_SECONDS) return;
+    double interval = governor.Allows(Governor.SLOWER) ? REFRESH_SECONDS : REFRESH_SECONDS * GOVERNOR_SLOW_FACTOR;
+    if (secondsSinceLast < interval) return;
 
     double elapsed = secondsSinceLast;
     secondsSinceLast = 0;
@@ -174,78 +502,296 @@ void RefreshBlocks() {
     GridTerminalSystem.GetBlocksOfType(powerProducers, p =>
         p.IsSameConstructAs(Me));
 
-    displaySurface = null;
-    displayBlock = null;
-    displaySurfaceIndex = DEFAULT_SURFACE_INDEX;
-    LocateDisplaySurface();
+    RefreshGasFlows();
+    LocateDisplaySurfaces();
+    names.Sweep();
+    blockWatcher.Reset(GridTerminalSystem);
 }
 
-void LocateDisplaySurface() {
+// Every flow is read on the next refresh, then FLOW_PER_REFRESH per refresh
+void RefreshGasFlows() {
+    gasFlows.Clear();
+    flowCursor = 0;
+    flowsSampled = false;
+    flowCandidates.Clear();
+    GridTerminalSystem.GetBlocksOfType(flowCandidates, b =>
+        b.IsSameConstructAs(Me) && FlowKind(b) >= 0);
+
+    for (int i = 0; i < flowCandidates.Count; i++) {
+        IMyTerminalBlock block = flowCandidates[i];
+        GasFlow flow = new GasFlow();
+        flow.Block = block;
+        flow.Kind = FlowKind(block);
+        flow.Coefficient = FlowCoefficient(block, flow.Kind);
+        gasFlows.Add(flow);
+    }
+}
+
+int FlowKind(IMyTerminalBlock block) {
+    if (block is IMyGasGenerator) return FLOW_GENERATOR;
+    if (block is IMyAirVent) return FLOW_VENT;
+    if (block is IMyOxygenFarm) return FLOW_FARM;
+    if (block is IMyThrust) {
+        return ContainsIgnoreCase(block.BlockDefinition.SubtypeName, "Hydrogen") ? FLOW_THRUSTER : -1;
+    }
+    if (block is IMyPowerProducer) {
+        return ContainsIgnoreCase(block.BlockDefinition.TypeIdString, "HydrogenEngine") ? FLOW_ENGINE : -1;
+    }
+    return -1;
+}
+
+// Per definition: L/s per N of thrust, per MW of output, or at full rate
+double FlowCoefficient(IMyTerminalBlock block, int kind) {
+    string key = block.BlockDefinition.ToString();
+    double coefficient;
+    if (flowCoefficients.TryGetValue(key, out coefficient)) return coefficient;
+
+    double full;
+    if (!FULL_FLOW_LPS.TryGetValue(block.BlockDefinition.SubtypeName ?? "", out full)) {
+        full = block.CubeGrid.GridSizeEnum == MyCubeSize.Large ? FULL_FLOW_LARGE[kind] : FULL_FLOW_SMALL[kind];
+    }
+
+    coefficient = full;
+    if (kind == FLOW_THRUSTER) {
+        float maxThrust = ((IMyThrust)block).MaxThrust;
+        coefficient = maxThrust > 0 ? full / maxThrust : 0;
+    } else if (kind == FLOW_ENGINE) {
+        float maxOutput = ((IMyPowerProducer)block).MaxOutput;
+        coefficient = maxOutput > 0 ? full / maxOutput : 0;
+    }
+
+    flowCoefficients[key] = coefficient;
+    return coefficient;
+}
+
+void SampleFlow(GasFlow flow) {
+    flow.Hydrogen = 0;
+    flow.Oxygen = 0;
+    IMyTerminalBlock block = flow.Block;
+    if (block.Closed || !block.IsWorking) return;
+
+    switch (flow.Kind) {
+        case FLOW_GENERATOR:
+            // Needs ice, and only fills gases that still have room
+            if ((double)block.GetInventory(0).CurrentVolume <= 0) return;
+            if (totalGroup.Hydrogen.Current < totalGroup.Hydrogen.Capacity) flow.Hydrogen = flow.Coefficient;
+            if (totalGroup.Oxygen.Current < totalGroup.Oxygen.Capacity) flow.Oxygen = flow.Coefficient / 2;
+            break;
+        case FLOW_ENGINE:
+            flow.Hydrogen = -flow.Coefficient * ((IMyPowerProducer)block).CurrentOutput;
+            break;
+        case FLOW_THRUSTER:
+            flow.Hydrogen = -flow.Coefficient * ((IMyThrust)block).CurrentThrust;
+            break;
+        case FLOW_VENT:
+            VentStatus status = ((IMyAirVent)block).Status;
+            if (status == VentStatus.Depressurizing) flow.Oxygen = flow.Coefficient;
+            else if (status == VentStatus.Pressurizing) flow.Oxygen = -flow.Coefficient;
+            break;
+        case FLOW_FARM:
+            flow.Oxygen = flow.Coefficient * ((IMyOxygenFarm)block).GetOutput();
+            break;
+    }
+}
+
+// Re-reads the next slice (every flow after a rescan), then adds every last
+// estimate to the whole grid and to the block's own tags (RollUpTags carries
+// them up). Runs once the tanks are summed: generators read the grid's fill.
+void UpdateGasFlows() {
+    int count = flowsSampled ? Math.Min(FLOW_PER_REFRESH, gasFlows.Count) : gasFlows.Count;
+    flowsSampled = true;
+    for (int k = 0; k < count; k++) {
+        SampleFlow(gasFlows[flowCursor]);
+        flowCursor = (flowCursor + 1) % gasFlows.Count;
+    }
+
+    bool tagBreakdown = governor.Allows(Governor.NO_TAGS);
+    for (int i = 0; i < gasFlows.Count; i++) {
+        GasFlow flow = gasFlows[i];
+        AddFlow(totalGroup, flow);
+        if (!tagBreakdown) continue;
+
+        List<string> tags = LeafTags(flow.Block);
+        for (int t = 0; t < tags.Count; t++) {
+            AddFlow(GetOrCreateGroup(tags[t]), flow);
+        }
+    }
+}
+
+void AddFlow(ResourceGroup group, GasFlow flow) {
+    if (flow.Kind == FLOW_GENERATOR || flow.Kind == FLOW_ENGINE || flow.Kind == FLOW_THRUSTER) {
+        group.Hydrogen.AddFlow(flow.Hydrogen);
+    }
+    if (flow.Kind == FLOW_GENERATOR || flow.Kind == FLOW_VENT || flow.Kind == FLOW_FARM) {
+        group.Oxygen.AddFlow(flow.Oxygen);
+    }
+}
+
+void LocateDisplaySurfaces() {
+    displays.Clear();
+    spanGroups.Clear();
     displayCandidates.Clear();
     GridTerminalSystem.GetBlocksOfType(displayCandidates, block =>
         block.IsSameConstructAs(Me) &&
         block is IMyTextSurfaceProvider &&
-        HasTag(block.CustomName));
+        names.Match(block).Has(displayTagId));
 
     for (int i = 0; i < displayCandidates.Count; i++) {
         IMyTerminalBlock candidate = displayCandidates[i];
         IMyTextSurfaceProvider provider = candidate as IMyTextSurfaceProvider;
         if (provider == null) continue;
 
-        int index = DEFAULT_SURFACE_INDEX;
-        if (!TryGetTagIndex(candidate.CustomName, out index)) {
-            index = DEFAULT_SURFACE_INDEX;
-        }
+        int index = names.Match(candidate).Index[displayTagId];
+        if (index < 0) index = DEFAULT_SURFACE_INDEX;
 
         if (index < 0 || index >= provider.SurfaceCount) continue;
 
         IMyTextSurface surface = provider.GetSurface(index);
         if (surface == null) continue;
 
-        displayBlock = candidate;
-        displaySurface = surface;
-        displaySurfaceIndex = index;
-        ConfigureDisplay(displayBlock, displaySurface);
-        break;
+        DisplayTarget target = new DisplayTarget();
+        target.Block = candidate;
+        target.Surface = surface;
+        target.SurfaceIndex = index;
+        ConfigureDisplay(candidate, surface);
+
+        string group;
+        int spanIndex;
+        if (TryGetSpan(candidate.CustomData, out group, out spanIndex)) {
+            target.SpanGroup = group;
+            target.SpanIndex = spanIndex;
+
+            List<DisplayTarget> members;
+            if (!spanGroups.TryGetValue(group, out members)) {
+                members = new List<DisplayTarget>();
+                spanGroups[group] = members;
+            }
+            members.Add(target);
+        }
+
+        displays.Add(target);
+    }
+
+    foreach (var members in spanGroups.Values) {
+        members.Sort((a, b) => a.SpanIndex.CompareTo(b.SpanIndex));
+    }
+}
+
+bool TryGetSpan(string customData, out string group, out int spanIndex) {
+    group = null;
+    spanIndex = 0;
+    if (string.IsNullOrEmpty(customData)) return false;
+
+    string[] lines = customData.Split('\n');
+    for (int i = 0; i < lines.Length; i++) {
+        string line = lines[i].Trim();
+        if (!line.StartsWith(SPAN_PREFIX, StringComparison.OrdinalIgnoreCase)) continue;
+
+        string spec = line.Substring(SPAN_PREFIX.Length).Trim();
+        int digits = spec.Length;
+        while (digits > 0 && char.IsDigit(spec[digits - 1])) digits--;
+        if (digits == 0 || digits == spec.Length) continue;
+
+        // An index past int.MaxValue is ignored like any malformed line
+        if (!int.TryParse(spec.Substring(digits), out spanIndex)) continue;
+        group = spec.Substring(0, digits);
+        return true;
     }
+
+    return false;
+}
+
+// Lays a surface out for linesNeeded lines, or with the font forced by the
+// first panel of its span group. Nothing is measured unless the key changed.
+void UpdateLayout(DisplayTarget target, int linesNeeded, float forcedFont) {
+    TextMetrics metrics = target.Metrics;
+    bool remeasured = metrics.Measure(target.Surface);
+    if (!remeasured && target.LinesNeeded == linesNeeded && target.ForcedFont == forcedFont) return;
+
+    target.LinesNeeded = linesNeeded;
+    target.ForcedFont = forcedFont;
+
+    float font = forcedFont > 0 ? forcedFont : GetAdaptiveFontSize(metrics, linesNeeded);
+    target.FontSize = font;
+    target.Surface.FontSize = font;
+
+    int bar = metrics.ColumnsAt(font) - 11; // "  100.0% [" + "]"
+    if (bar < MIN_BAR_LENGTH) bar = MIN_BAR_LENGTH;
+    if (bar > MAX_BAR_LENGTH) bar = MAX_BAR_LENGTH;
+
+    target.BarLength = bar;
+    target.LineCapacity = metrics.LinesAt(font);
 }
 
 void ConfigureDisplay(IMyTerminalBlock block, IMyTextSurface surface) {
     surface.ContentType = ContentType.TEXT_AND_IMAGE;
     surface.Font = "Monospace";
-    surface.FontSize = GetAdaptiveFontSize(block, surface);
     surface.FontColor = Color.White;
     surface.BackgroundColor = Color.Black;
     surface.Alignment = TextAlignment.LEFT;
     surface.TextPadding = 2f;
 }
 
-float GetAdaptiveFontSize(IMyTerminalBlock block, IMyTextSurface surface) {
-    var size = surface.SurfaceSize;
-    double minDimension = Math.Min(size.X, size.Y);
-    if (minDimension <= 0) minDimension = 256;
+// Largest font that fits linesNeeded lines and a full-width bar line
+float GetAdaptiveFontSize(TextMetrics metrics, int linesNeeded) {
+    float height = metrics.FirstLineHeight + (linesNeeded - 1) * metrics.LineHeight;
+    float byHeight = metrics.UsableHeight / height;
+    float byWidth = metrics.UsableWidth / (FRAME_COLUMNS * metrics.CharWidth);
 
-    double scale = minDimension / 512.0;
-    if (scale <= 0) scale = 0.5;
+    float font = Math.Min(byHeight, byWidth);
+    if (font < MIN_FONT_SIZE) font = MIN_FONT_SIZE;
+    if (font > MAX_FONT_SIZE) font = MAX_FONT_SIZE;
 
-    double baseFont = (block is IMyCockpit || block is IMyShipController) ? 0.85 : 1.2;
-    double font = baseFont * scale;
-
-    if (font < 0.55) font = 0.55;
-    if (font > 1.4) font = 1.4;
-
-    return (float)font;
+    return font;
 }
 
 void WriteStatus(double elapsedSeconds = 0) {
-    if (!EnsureDisplay()) {
+    bool publishing = TELEMETRY_MODE == "publish";
+    bool hasDisplay = EnsureDisplay();
+    if (!hasDisplay && !publishing) {
         Echo("No tagged display surface found. Add " + TAG_LABEL + "[:index] to an LCD or cockpit.");
         return;
     }
 
-    RebuildResourceGroups();
-    UpdateProductionRates(elapsedSeconds);
+    if (TelemetryFresh()) {
+        ApplyTelemetry(telemetryPacket);
+    } else {
+        RebuildResourceGroups();
+        if (elapsedSeconds > 0) rateSample++;
+        if (governor.Allows(Governor.NO_RATES)) {
+            UpdateProductionRates(elapsedSeconds);
+        } else {
+            // Resume from fresh samples: the last amounts are as old as the pause
+            lastHydrogenAmount.Clear();
+            lastOxygenAmount.Clear();
+        }
+    }
+    if (publishing) {
+        IGC.SendBroadcastMessage(TELEMETRY_CHANNEL, BuildTelemetry(), TransmissionDistance.ConnectedConstructs);
+    }
+    if (!hasDisplay) return;
+
+    BuildStatusModel();
+
+    frameCache.Clear();
+    for (int i = 0; i < displays.Count; i++) {
+        DisplayTarget target = displays[i];
+        if (target.SpanGroup != null) continue;
+        if (SPRITES) {
+            DrawSprites(target);
+            continue;
+        }
 
+        UpdateLayout(target, FRAME_LINES, 0);
+        target.Surface.WriteText(GetFrame(target.BarLength));
+    }
+
+    foreach (var members in spanGroups.Values) {
+        WriteSpanned(members);
+    }
+}
+
+void BuildStatusModel() {
     ResourceGroup activeGroup = totalGroup;
     string header = "ALL";
     string activeKey = TOTAL_KEY;
@@ -264,6 +810,10 @@ void WriteStatus(double elapsedSeconds = 0) {
             currentTagKey = null;
             activeKey = TOTAL_KEY;
         }
+    } else if (currentView == ViewMode.Tag && !governor.Allows(Governor.NO_TAGS)) {
+        // Breakdown shed: whole grid meanwhile, the tag view comes back with it
+        header = "ALL (tags paused)";
+        activeKey = TOTAL_KEY;
     } else if (currentView == ViewMode.Tag) {
         currentView = ViewMode.All;
         header = "ALL";
@@ -274,27 +824,45 @@ void WriteStatus(double elapsedSeconds = 0) {
         activeKey = TOTAL_KEY;
     }
 
-    ResourceStats hydrogen = activeGroup.Hydrogen.ToStats();
-    ResourceStats oxygen = activeGroup.Oxygen.ToStats();
-    ResourceStats power = activeGroup.Batteries.ToStats();
-    ResourceStats cargo = activeGroup.Cargo.ToStats();
+    model.Header = header;
+    model.Hydrogen = activeGroup.Hydrogen.ToStats();
+    model.Oxygen = activeGroup.Oxygen.ToStats();
+    model.Power = activeGroup.Batteries.ToStats();
+    model.Cargo = activeGroup.Cargo.ToStats();
+
+    model.HydrogenRate = GetRateForKey(hydrogenRateByKey, activeKey);
+    model.OxygenRate = GetRateForKey(oxygenRateByKey, activeKey);
+    model.PowerOutput = GetPowerOutputForKey(activeKey);
+    model.HydrogenPeak = GetPeakRate(hydrogenPeakRate, activeKey);
+    model.OxygenPeak = GetPeakRate(oxygenPeakRate, activeKey);
+    model.PowerCapacity = GetPowerCapacityForKey(activeKey);
+}
 
-    double hRate = GetRateForKey(hydrogenRateByKey, activeKey);
-    double oRate = GetRateForKey(oxygenRateByKey, activeKey);
-    double powerOutput = GetPowerOutputForKey(activeKey);
-    double hMaxRate = GetPeakRate(hydrogenPeakRate, activeKey);
-    double oMaxRate = GetPeakRate(oxygenPeakRate, activeKey);
-    double powerMax = GetPowerCapacityForKey(activeKey);
+// Frames only differ by bar length, so surfaces sharing a layout share the text
+string GetFrame(int barLength) {
+    string frame;
+    if (frameCache.TryGetValue(barLength, out frame)) return frame;
 
     System.Text.StringBuilder sb = new System.Text.StringBuilder();
-    sb.AppendLine(header);
+    sb.AppendLine(model.Header);
+    if (!governor.Allows(Governor.MINIMAL)) {
+        AppendMinimalEntry(sb, "H2", model.Hydrogen);
+        AppendMinimalEntry(sb, "O2", model.Oxygen);
+        AppendMinimalEntry(sb, "Power", model.Power);
+        AppendMinimalEntry(sb, "Cargo", model.Cargo);
+        sb.AppendLine(governor.Status);
+        frame = sb.ToString();
+        frameCache[barLength] = frame;
+        return frame;
+    }
     sb.AppendLine("================");
     sb.AppendLine();
 
-    AppendResourceEntry(sb, "Hydrogen", hydrogen, "L", true, hRate, hMaxRate, true);
-    AppendResourceEntry(sb, "Oxygen", oxygen, "L", true, oRate, oMaxRate, true);
-    AppendResourceEntry(sb, "Batteries", power, "MWh", true, powerOutput * 1000000.0, powerMax * 1000000.0, false);
-    AppendResourceEntry(sb, "Cargo", cargo, "L", false, 0, 0, true);
+    bool rates = governor.Allows(Governor.NO_RATES);
+    AppendResourceEntry(sb, "Hydrogen", model.Hydrogen, "L", rates, model.HydrogenRate, model.HydrogenPeak, true, barLength);
+    AppendResourceEntry(sb, "Oxygen", model.Oxygen, "L", rates, model.OxygenRate, model.OxygenPeak, true, barLength);
+    AppendResourceEntry(sb, "Batteries", model.Power, "MWh", rates, model.PowerOutput * 1000000.0, model.PowerCapacity * 1000000.0, false, barLength);
+    AppendResourceEntry(sb, "Cargo", model.Cargo, "L", false, 0, 0, true, barLength);
 
     List<string> options = BuildMenuOptions();
     if (options.Count > 0) {
@@ -305,26 +873,102 @@ void WriteStatus(double elapsedSeconds = 0) {
         }
     }
 
-    displaySurface.WriteText(sb.ToString());
+    frame = sb.ToString();
+    frameCache[barLength] = frame;
+    return frame;
+}
+
+// Same model as GetFrame; fill values are whole percents, so a frame is only
+// sent when one of them, a bar pixel, a rate column or the menu changed
+void DrawSprites(DisplayTarget target) {
+    if (target.View == null) {
+        target.View = new SpriteView(target.Surface, SPRITE_ROWS);
+    }
+    SpriteView view = target.View;
+    bool rates = governor.Allows(Governor.NO_RATES);
+    // One spark point per rate computation, not per redraw (menu, packets)
+    bool sample = target.SparkSample != rateSample;
+    target.SparkSample = rateSample;
+
+    view.Text(0, model.Header, Color.White);
+    DrawSpriteBar(view, 1, "H2", model.Hydrogen, false);
+    view.Spark(2, "H2 prod", !sample ? double.NaN : rates ? model.HydrogenRate : 0, 0, Color.Lime, Color.Orange);
+    DrawSpriteBar(view, 3, "O2", model.Oxygen, false);
+    view.Spark(4, "O2 prod", !sample ? double.NaN : rates ? model.OxygenRate : 0, 0, Color.Lime, Color.Orange);
+    DrawSpriteBar(view, 5, "Power", model.Power, false);
+    DrawSpriteBar(view, 6, "Cargo", model.Cargo, true);
+
+    spriteMenu.Clear();
+    List<string> options = BuildMenuOptions();
+    for (int i = 0; i < options.Count; i++) {
+        spriteMenu.Append(i == selectedOptionIndex ? "> " : "  ").Append(options[i]).Append(' ');
+    }
+    view.Text(7, spriteMenu.ToString(), Color.Gray);
+    view.Draw();
+}
+
+// Orange when low, or when nearly full for cargo
+void DrawSpriteBar(SpriteView view, int row, string label, ResourceStats stats, bool fullIsAlert) {
+    bool alert = fullIsAlert ? stats.Fill >= 0.9 : stats.Fill < 0.2;
+    Color color = stats.Blocks == 0 ? Color.Gray : alert ? Color.Orange : Color.Lime;
+    view.Bar(row, label, stats.Fill, (int)Math.Round(stats.Fill * 100), 0, "%", color);
+}
+
+// Like IIM-inventory:GROUP#, the first panel's layout drives the group and
+// each following panel continues where the previous one ran out of lines.
+void WriteSpanned(List<DisplayTarget> members) {
+    if (members.Count == 0) return;
+
+    int linesPerPanel = (FRAME_LINES + members.Count - 1) / members.Count;
+    UpdateLayout(members[0], linesPerPanel, 0);
+    for (int i = 1; i < members.Count; i++) {
+        UpdateLayout(members[i], 0, members[0].FontSize);
+    }
+    string frame = GetFrame(members[0].BarLength);
+
+    int position = 0;
+    for (int i = 0; i < members.Count; i++) {
+        DisplayTarget target = members[i];
+        bool last = i == members.Count - 1;
+
+        int end = position;
+        int lines = 0;
+        while (end < frame.Length && (last || lines < target.LineCapacity)) {
+            int newline = frame.IndexOf('\n', end);
+            end = newline < 0 ? frame.Length : newline + 1;
+            lines++;
+        }
+
+        target.Surface.WriteText(frame.Substring(position, end - position));
+        position = end;
+    }
 }
 
 bool EnsureDisplay() {
-    if (displaySurface != null) return true;
-    LocateDisplaySurface();
-    return displaySurface != null;
+    for (int i = 0; i < displays.Count; i++) {
+        if (displays[i].Block.Closed) {
+            LocateDisplaySurfaces();
+            break;
+        }
+    }
+
+    if (displays.Count > 0) return true;
+    LocateDisplaySurfaces();
+    return displays.Count > 0;
 }
 
 void AppendResourceEntry(System.Text.StringBuilder sb, string label, ResourceStats stats, string unit,
-    bool hasRate, double rateValue, double maxRateValue, bool rateIsVolume) {
+    bool hasRate, double rateValue, double maxRateValue, bool rateIsVolume, int barLength) {
     sb.AppendLine(label);
 
     if (stats.Blocks == 0) {
         sb.AppendLine("  (none detected)");
+        AppendFlowLine(sb, stats);
         sb.AppendLine();
         return;
     }
 
-    sb.AppendFormat("  {0,5:0.0}% {1}\n", stats.Fill * 100, BuildBar(stats.Fill, 24));
+    sb.AppendFormat("  {0,5:0.0}% {1}\n", stats.Fill * 100, BuildBar(stats.Fill, barLength));
     sb.Append("  Storage ")
         .Append(FormatValueWithUnit(stats.Current, unit))
         .Append(" / ")
@@ -336,9 +980,30 @@ void AppendResourceEntry(System.Text.StringBuilder sb, string label, ResourceSta
     }
 
     sb.AppendLine();
+    AppendFlowLine(sb, stats);
     sb.AppendLine();
 }
 
+// Estimated sources and sinks, next to Prod (the measured change in the tanks)
+void AppendFlowLine(System.Text.StringBuilder sb, ResourceStats stats) {
+    if (stats.FlowBlocks == 0) return;
+
+    sb.Append("  In ").Append(FormatFlow(stats.Produced))
+        .Append(" Out ").Append(FormatFlow(-stats.Consumed))
+        .Append(" Net ").Append(FormatFlow(stats.Produced - stats.Consumed))
+        .AppendLine();
+}
+
+// Governor at MINIMAL: one line per resource, no bar, rate or menu
+void AppendMinimalEntry(System.Text.StringBuilder sb, string label, ResourceStats stats) {
+    sb.Append(label).Append(' ');
+    if (stats.Blocks == 0) {
+        sb.AppendLine("-");
+    } else {
+        sb.AppendFormat("{0:0.0}%\n", stats.Fill * 100);
+    }
+}
+
 void RebuildResourceGroups() {
     totalGroup.Clear();
     tagGroups.Clear();
@@ -348,21 +1013,21 @@ void RebuildResourceGroups() {
         IMyGasTank tank = hydrogenTanks[i];
         double capacity = tank.Capacity;
         double current = tank.FilledRatio * capacity;
-        ProcessResource(current, capacity, ResourceKind.Hydrogen, tank.CustomName);
+        ProcessResource(current, capacity, ResourceKind.Hydrogen, tank);
     }
 
     for (int i = 0; i < oxygenTanks.Count; i++) {
         IMyGasTank tank = oxygenTanks[i];
         double capacity = tank.Capacity;
         double current = tank.FilledRatio * capacity;
-        ProcessResource(current, capacity, ResourceKind.Oxygen, tank.CustomName);
+        ProcessResource(current, capacity, ResourceKind.Oxygen, tank);
     }
 
     for (int i = 0; i < batteries.Count; i++) {
         IMyBatteryBlock battery = batteries[i];
         double current = battery.CurrentStoredPower;
         double capacity = battery.MaxStoredPower;
-        ProcessResource(current, capacity, ResourceKind.Batteries, battery.CustomName);
+        ProcessResource(current, capacity, ResourceKind.Batteries, battery);
     }
 
     for (int i = 0; i < cargoContainers.Count; i++) {
@@ -370,21 +1035,41 @@ void RebuildResourceGroups() {
         IMyInventory inventory = container.GetInventory();
         double current = (double)inventory.CurrentVolume;
         double capacity = (double)inventory.MaxVolume;
-        ProcessResource(current, capacity, ResourceKind.Cargo, container.CustomName);
+        ProcessResource(current, capacity, ResourceKind.Cargo, container);
     }
 
-    UpdatePowerOutputs();
-
-    tagList.Sort(StringComparer.OrdinalIgnoreCase);
+    bool rates = governor.Allows(Governor.NO_RATES);
+    if (rates) {
+        UpdatePowerOutputs();
+        UpdateGasFlows();
+    }
+    RollUpTags(rates);
+    FinishResourceGroups();
+}
 
-    PruneProductionDictionaries();
+// Sorting, pruning and view bookkeeping once the groups are filled (measured or received)
+void FinishResourceGroups() {
+    tagList.Sort(CompareTagPaths);
+
+    // Breakdown shed by the governor: the tag groups are empty on purpose.
+    // Per-tag rates, peaks and the view are kept for when it comes back; only
+    // the last amounts go (a rate needs two consecutive samples).
+    bool breakdownShed = !governor.Allows(Governor.NO_TAGS);
+    if (breakdownShed) {
+        RemoveMissingKeys(lastHydrogenAmount);
+        RemoveMissingKeys(lastOxygenAmount);
+    } else {
+        PruneProductionDictionaries();
+    }
 
     if (tagList.Count == 0) {
-        currentTagIndex = -1;
-        currentTagKey = null;
-        if (currentView == ViewMode.Tag) {
-            currentView = ViewMode.All;
-            selectedOptionIndex = 0;
+        if (!breakdownShed) {
+            currentTagIndex = -1;
+            currentTagKey = null;
+            if (currentView == ViewMode.Tag) {
+                currentView = ViewMode.All;
+                selectedOptionIndex = 0;
+            }
         }
     } else {
         if (!string.IsNullOrEmpty(currentTagKey)) {
@@ -398,12 +1083,15 @@ void RebuildResourceGroups() {
     BuildMenuOptions();
 }
 
-void ProcessResource(double current, double capacity, ResourceKind kind, string customName) {
+void ProcessResource(double current, double capacity, ResourceKind kind, IMyTerminalBlock block) {
     AddToAccumulator(totalGroup, kind, current, capacity);
-    AddToTagGroups(customName, kind, current, capacity);
+    if (governor.Allows(Governor.NO_TAGS)) {
+        AddToTagGroups(block, kind, current, capacity);
+    }
 }
 
 void UpdatePowerOutputs() {
+    bool tagBreakdown = governor.Allows(Governor.NO_TAGS);
     totalPowerOutput = 0;
     totalPowerCapacity = 0;
     powerOutputByTag.Clear();
@@ -415,40 +1103,28 @@ void UpdatePowerOutputs() {
         double capacity = producer.MaxOutput;
         totalPowerOutput += output;
         totalPowerCapacity += capacity;
-        AddPowerToTag(producer.CustomName, output);
-        AddPowerCapacityToTag(producer.CustomName, capacity);
+        if (tagBreakdown) {
+            AddPowerToTag(producer, output);
+            AddPowerCapacityToTag(producer, capacity);
+        }
     }
 }
 
-void AddPowerToTag(string customName, double output) {
-    int tagCount = ExtractTags(customName);
-    if (tagCount == 0) return;
-
-    for (int i = 0; i < tagCount; i++) {
-        string tag = scratchTags[i];
+void AddPowerToTag(IMyTerminalBlock block, double output) {
+    List<string> tags = LeafTags(block);
+    for (int i = 0; i < tags.Count; i++) {
+        string tag = tags[i];
         GetOrCreateGroup(tag);
-
-        double existing;
-        if (!powerOutputByTag.TryGetValue(tag, out existing)) {
-            existing = 0;
-        }
-        powerOutputByTag[tag] = existing + output;
+        AddToMap(powerOutputByTag, tag, output);
     }
 }
 
-void AddPowerCapacityToTag(string customName, double capacity) {
-    int tagCount = ExtractTags(customName);
-    if (tagCount == 0) return;
-
-    for (int i = 0; i < tagCount; i++) {
-        string tag = scratchTags[i];
+void AddPowerCapacityToTag(IMyTerminalBlock block, double capacity) {
+    List<string> tags = LeafTags(block);
+    for (int i = 0; i < tags.Count; i++) {
+        string tag = tags[i];
         GetOrCreateGroup(tag);
-
-        double existing;
-        if (!powerCapacityByTag.TryGetValue(tag, out existing)) {
-            existing = 0;
-        }
-        powerCapacityByTag[tag] = existing + capacity;
+        AddToMap(powerCapacityByTag, tag, capacity);
     }
 }
 
@@ -472,25 +1148,83 @@ ResourceAccumulator GetAccumulator(ResourceGroup group, ResourceKind kind) {
     }
 }
 
-void AddToTagGroups(string customName, ResourceKind kind, double current, double capacity) {
-    int tagCount = ExtractTags(customName);
-    for (int i = 0; i < tagCount; i++) {
-        string tag = scratchTags[i];
+// A block is only added to its own (deepest) tags; RollUpTags carries it up
+void AddToTagGroups(IMyTerminalBlock block, ResourceKind kind, double current, double capacity) {
+    List<string> tags = LeafTags(block);
+    for (int i = 0; i < tags.Count; i++) {
+        string tag = tags[i];
         ResourceGroup group = GetOrCreateGroup(tag);
         AddToAccumulator(group, kind, current, capacity);
     }
 }
 
+// The block's tag paths minus those another of its tags is under
+// ([A] [A:B] counts the block in A:B, and in A through the roll-up)
+List<string> LeafTags(IMyTerminalBlock block) {
+    List<string> tags = names.Match(block).Tags;
+    leafTags.Clear();
+    for (int i = 0; i < tags.Count; i++) {
+        bool covered = false;
+        for (int j = 0; j < tags.Count && !covered; j++) {
+            covered = j != i && tags[j].Length > tags[i].Length && tags[j][tags[i].Length] == ':'
+                && tags[j].StartsWith(tags[i], StringComparison.OrdinalIgnoreCase);
+        }
+        if (!covered) leafTags.Add(tags[i]);
+    }
+    return leafTags;
+}
+
+// A path creates its ancestors first, so until FinishResourceGroups sorts it,
+// tagList has every parent ahead of its children
 ResourceGroup GetOrCreateGroup(string tag) {
     ResourceGroup group;
     if (!tagGroups.TryGetValue(tag, out group)) {
+        int colon = tag.LastIndexOf(':');
         group = new ResourceGroup();
+        group.Key = tag;
+        group.Parent = colon > 0 ? GetOrCreateGroup(tag.Substring(0, colon)) : null;
         tagGroups[tag] = group;
         tagList.Add(tag);
     }
     return group;
 }
 
+// Walking the creation order backwards adds each group to its parent after
+// all of its own children were added to it: one add per tag, whatever the depth
+void RollUpTags(bool power) {
+    for (int i = tagList.Count - 1; i >= 0; i--) {
+        ResourceGroup group = tagGroups[tagList[i]];
+        if (group.Parent == null) continue;
+
+        group.Parent.Add(group);
+        if (power) {
+            AddToMap(powerOutputByTag, group.Parent.Key, GetPowerOutputForKey(group.Key));
+            AddToMap(powerCapacityByTag, group.Parent.Key, GetPowerCapacityForKey(group.Key));
+        }
+    }
+}
+
+void AddToMap(Dictionary<string, double> map, string key, double value) {
+    double existing;
+    if (!map.TryGetValue(key, out existing)) {
+        existing = 0;
+    }
+    map[key] = existing + value;
+}
+
+// Depth-first order: a tag, its sub-tags, then the next tag ("A", "A:B", "A B")
+int CompareTagPaths(string a, string b) {
+    int length = Math.Min(a.Length, b.Length);
+    for (int i = 0; i < length; i++) {
+        if (a[i] == b[i]) continue;
+        if (a[i] == ':') return -1;
+        if (b[i] == ':') return 1;
+        int c = char.ToUpperInvariant(a[i]).CompareTo(char.ToUpperInvariant(b[i]));
+        if (c != 0) return c;
+    }
+    return a.Length - b.Length;
+}
+
 void UpdateProductionRates(double elapsedSeconds) {
     if (elapsedSeconds <= 0) return;
 
@@ -515,9 +1249,14 @@ double UpdateSingleRate(Dictionary<string, double> lastMap, Dictionary<string, d
     string key, double currentValue, double elapsedSeconds) {
     double previous;
     if (!lastMap.TryGetValue(key, out previous)) {
+        // First sample (or first after a pause): keep the last known rate
         lastMap[key] = currentValue;
-        rateMap[key] = 0;
-        return 0;
+        double known;
+        if (!rateMap.TryGetValue(key, out known)) {
+            known = 0;
+            rateMap[key] = 0;
+        }
+        return known;
     }
 
     double rate = (currentValue - previous) / elapsedSeconds;
@@ -558,42 +1297,6 @@ void RemoveMissingKeys(Dictionary<string, double> map) {
     }
 }
 
-int ExtractTags(string name) {
-    scratchTags.Clear();
-    if (string.IsNullOrEmpty(name)) return 0;
-
-    int search = 0;
-    while (true) {
-        int open = name.IndexOf('[', search);
-        if (open < 0) break;
-        int close = name.IndexOf(']', open + 1);
-        if (close < 0) break;
-
-        string content = name.Substring(open + 1, close - open - 1);
-        if (!string.IsNullOrEmpty(content)) {
-            int colon = content.IndexOf(':');
-            if (colon >= 0) content = content.Substring(0, colon);
-            content = content.Trim();
-            if (content.Length > 0 && !ContainsTag(content)) {
-                scratchTags.Add(content);
-            }
-        }
-
-        search = close + 1;
-    }
-
-    return scratchTags.Count;
-}
-
-bool ContainsTag(string tag) {
-    for (int i = 0; i < scratchTags.Count; i++) {
-        if (string.Equals(scratchTags[i], tag, StringComparison.OrdinalIgnoreCase)) {
-            return true;
-        }
-    }
-    return false;
-}
-
 List<string> BuildMenuOptions() {
     menuOptions.Clear();
 
@@ -602,11 +1305,16 @@ List<string> BuildMenuOptions() {
             menuOptions.Add("Next");
         }
     } else {
+        ResourceGroup group = TagGroupAt(currentTagIndex);
         if (tagList.Count > 0) {
             menuOptions.Add("Next");
             menuOptions.Add("Back");
+            ResourceGroup next = TagGroupAt(currentTagIndex + 1);
+            if (group != null && next != null && next.Parent == group) {
+                menuOptions.Add("Open");
+            }
         }
-        menuOptions.Add("Main");
+        menuOptions.Add(group != null && group.Parent != null ? "Up" : "Main");
     }
 
     if (menuOptions.Count == 0) {
@@ -639,11 +1347,11 @@ void ApplySelection() {
 
         if (currentView == ViewMode.All) {
             if (currentTagIndex < 0) currentTagIndex = 0;
-            else currentTagIndex = (currentTagIndex + 1) % tagList.Count;
+            else currentTagIndex = SiblingIndex(currentTagIndex, 1);
             currentView = ViewMode.Tag;
         } else {
             if (currentTagIndex < 0) currentTagIndex = 0;
-            else currentTagIndex = (currentTagIndex + 1) % tagList.Count;
+            else currentTagIndex = SiblingIndex(currentTagIndex, 1);
         }
         currentTagKey = tagList[currentTagIndex];
         selectedOptionIndex = 0;
@@ -651,9 +1359,21 @@ void ApplySelection() {
         if (tagList.Count == 0) return;
 
         if (currentTagIndex < 0) currentTagIndex = 0;
-        currentTagIndex = (currentTagIndex - 1 + tagList.Count) % tagList.Count;
+        currentTagIndex = SiblingIndex(currentTagIndex, -1);
         currentTagKey = tagList[currentTagIndex];
         selectedOptionIndex = 1;
+    } else if (choice == "Open") {
+        // Depth-first order: the first sub-tag follows its parent
+        currentTagIndex++;
+        currentTagKey = tagList[currentTagIndex];
+        selectedOptionIndex = 0;
+    } else if (choice == "Up") {
+        ResourceGroup group = TagGroupAt(currentTagIndex);
+        if (group != null && group.Parent != null) {
+            currentTagIndex = FindTagIndex(group.Parent.Key);
+            currentTagKey = group.Parent.Key;
+        }
+        selectedOptionIndex = 0;
     } else if (choice == "Main") {
         currentView = ViewMode.All;
         selectedOptionIndex = 0;
@@ -662,6 +1382,28 @@ void ApplySelection() {
     BuildMenuOptions();
 }
 
+ResourceGroup TagGroupAt(int index) {
+    if (index < 0 || index >= tagList.Count) return null;
+
+    ResourceGroup group;
+    tagGroups.TryGetValue(tagList[index], out group);
+    return group;
+}
+
+// Next (step 1) or previous (step -1) tag under the same parent, wrapping
+int SiblingIndex(int index, int step) {
+    ResourceGroup group = TagGroupAt(index);
+    if (group == null) return index;
+
+    int count = tagList.Count;
+    for (int k = 1; k < count; k++) {
+        int i = ((index + step * k) % count + count) % count;
+        ResourceGroup other = TagGroupAt(i);
+        if (other != null && other.Parent == group.Parent) return i;
+    }
+    return index;
+}
+
 int FindTagIndex(string tag) {
     for (int i = 0; i < tagList.Count; i++) {
         if (string.Equals(tagList[i], tag, StringComparison.OrdinalIgnoreCase)) {
@@ -817,37 +1559,202 @@ double GetPowerCapacityForKey(string key) {
     return 0;
 }
 
-bool HasTag(string name) {
-    int dummy;
-    return TryGetTagIndex(name, out dummy);
+// Format: YSI1|view|tagKey|option|secondsSinceLast|key,lastH,lastO,rateH,rateO,peakH,peakO;...
+// Game time is frozen while the world is unloaded, so the saved secondsSinceLast
+// keeps the first rate after a reload measured over the right interval.
+string BuildSnapshot() {
+    System.Text.StringBuilder sb = new System.Text.StringBuilder();
+    sb.Append(SNAPSHOT_VERSION).Append('|')
+        .Append(currentView == ViewMode.Tag ? 1 : 0).Append('|')
+        .Append(IsSnapshotKey(currentTagKey) ? currentTagKey : "").Append('|')
+        .Append(selectedOptionIndex).Append('|')
+        .Append(ToFixed(secondsSinceLast)).Append('|');
+
+    int written = 0;
+    AppendSnapshotKey(sb, TOTAL_KEY, ref written);
+    for (int i = 0; i < tagList.Count && written < SNAPSHOT_MAX_KEYS; i++) {
+        AppendSnapshotKey(sb, tagList[i], ref written);
+    }
+
+    return sb.ToString();
+}
+
+void AppendSnapshotKey(System.Text.StringBuilder sb, string key, ref int written) {
+    if (!IsSnapshotKey(key)) return;
+
+    double lastH, lastO;
+    bool hasH = lastHydrogenAmount.TryGetValue(key, out lastH);
+    bool hasO = lastOxygenAmount.TryGetValue(key, out lastO);
+    if (!hasH && !hasO) return;
+
+    if (written > 0) sb.Append(';');
+    sb.Append(key).Append(',')
+        .Append(hasH ? ToFixed(lastH) : "").Append(',')
+        .Append(hasO ? ToFixed(lastO) : "").Append(',')
+        .Append(ToFixed(GetRateForKey(hydrogenRateByKey, key))).Append(',')
+        .Append(ToFixed(GetRateForKey(oxygenRateByKey, key))).Append(',')
+        .Append(ToFixed(GetPeakRate(hydrogenPeakRate, key))).Append(',')
+        .Append(ToFixed(GetPeakRate(oxygenPeakRate, key)));
+    written++;
+}
+
+void RestoreSnapshot() {
+    if (string.IsNullOrEmpty(Storage)) return;
+
+    string[] parts = Storage.Split('|');
+    if (parts.Length != 6 || parts[0] != SNAPSHOT_VERSION) return;
+
+    currentView = parts[1] == "1" ? ViewMode.Tag : ViewMode.All;
+    currentTagKey = parts[2].Length > 0 ? parts[2] : null;
+    int option;
+    if (int.TryParse(parts[3], out option) && option >= 0) selectedOptionIndex = option;
+    double seconds;
+    if (TryFromFixed(parts[4], out seconds) && seconds >= 0) secondsSinceLast = seconds;
+
+    if (parts[5].Length == 0) return;
+    string[] entries = parts[5].Split(';');
+    for (int i = 0; i < entries.Length && i < SNAPSHOT_MAX_KEYS; i++) {
+        string[] fields = entries[i].Split(',');
+        if (fields.Length != 7 || !IsSnapshotKey(fields[0])) continue;
+
+        string key = fields[0];
+        double value;
+        if (TryFromFixed(fields[1], out value)) lastHydrogenAmount[key] = value;
+        if (TryFromFixed(fields[2], out value)) lastOxygenAmount[key] = value;
+        if (TryFromFixed(fields[3], out value)) hydrogenRateByKey[key] = value;
+        if (TryFromFixed(fields[4], out value)) oxygenRateByKey[key] = value;
+        if (TryFromFixed(fields[5], out value)) hydrogenPeakRate[key] = value;
+        if (TryFromFixed(fields[6], out value)) oxygenPeakRate[key] = value;
+    }
+}
+
+bool IsSnapshotKey(string key) {
+    if (string.IsNullOrEmpty(key) || key.Length > SNAPSHOT_MAX_KEY_LENGTH) return false;
+    return key.IndexOf('|') < 0 && key.IndexOf(';') < 0 && key.IndexOf(',') < 0;
+}
+
+string ToFixed(double value) {
+    return ((long)Math.Round(value * SNAPSHOT_SCALE)).ToString();
 }
 
-bool TryGetTagIndex(string name, out int index) {
-    index = DEFAULT_SURFACE_INDEX;
-    if (string.IsNullOrEmpty(name)) return false;
+bool TryFromFixed(string text, out double value) {
+    long raw;
+    if (!long.TryParse(text, out raw)) {
+        value = 0;
+        return false;
+    }
 
-    int start = name.IndexOf(TAG_PREFIX, StringComparison.OrdinalIgnoreCase);
-    if (start < 0) return false;
+    value = raw / SNAPSHOT_SCALE;
+    return true;
+}
 
-    int end = name.IndexOf(']', start);
-    if (end < 0) return false;
+// Packet: YTEL1|sequence|key,h2 cur,h2 max,h2 blocks,h2 rate,o2 cur,o2 max,o2 blocks,o2 rate,
+// battery cur,battery max,battery blocks,cargo cur,cargo max,cargo blocks,power out,power max;...
+// Values in fixed point (ToFixed); the first key is the whole construct (TOTAL_KEY)
+string BuildTelemetry() {
+    System.Text.StringBuilder sb = new System.Text.StringBuilder();
+    telemetrySequence++;
+    sb.Append(TELEMETRY_VERSION).Append('|').Append(telemetrySequence).Append('|');
+    AppendTelemetryKey(sb, TOTAL_KEY, totalGroup);
+    for (int i = 0; i < tagList.Count; i++) {
+        ResourceGroup group;
+        if (!IsSnapshotKey(tagList[i]) || !tagGroups.TryGetValue(tagList[i], out group)) continue;
+        sb.Append(';');
+        AppendTelemetryKey(sb, tagList[i], group);
+    }
+    return sb.ToString();
+}
+
+void AppendTelemetryKey(System.Text.StringBuilder sb, string key, ResourceGroup group) {
+    sb.Append(key);
+    AppendAccumulator(sb, group.Hydrogen);
+    sb.Append(',').Append(ToFixed(GetRateForKey(hydrogenRateByKey, key)));
+    AppendAccumulator(sb, group.Oxygen);
+    sb.Append(',').Append(ToFixed(GetRateForKey(oxygenRateByKey, key)));
+    AppendAccumulator(sb, group.Batteries);
+    AppendAccumulator(sb, group.Cargo);
+    sb.Append(',').Append(ToFixed(GetPowerOutputForKey(key)))
+        .Append(',').Append(ToFixed(GetPowerCapacityForKey(key)));
+}
+
+void AppendAccumulator(System.Text.StringBuilder sb, ResourceAccumulator accumulator) {
+    sb.Append(',').Append(ToFixed(accumulator.Current))
+        .Append(',').Append(ToFixed(accumulator.Capacity))
+        .Append(',').Append(accumulator.Count);
+}
+
+bool TelemetryFresh() {
+    return telemetryPacket != null && telemetryAge < TELEMETRY_STALE_SECONDS;
+}
 
-    string content = name.Substring(start + 1, end - start - 1);
-    if (string.IsNullOrEmpty(content)) return false;
+// Keeps the newest valid packet of the waiting ones
+bool ReceiveTelemetry() {
+    bool received = false;
+    while (telemetryListener != null && telemetryListener.HasPendingMessage) {
+        MyIGCMessage message = telemetryListener.AcceptMessage();
+        string packet = message.Data as string;
+        if (packet == null || !packet.StartsWith(TELEMETRY_VERSION + "|")) continue;
+        telemetryPacket = packet;
+        telemetryAge = 0;
+        received = true;
+        rateSample++;
+    }
+    return received;
+}
 
-    int colon = content.IndexOf(':');
-    string core = colon >= 0 ? content.Substring(0, colon) : content;
-    if (!core.Equals("YSI", StringComparison.OrdinalIgnoreCase)) return false;
+// Fills the groups, rates and power totals from a packet, as if measured here
+void ApplyTelemetry(string packet) {
+    totalGroup.Clear();
+    tagGroups.Clear();
+    tagList.Clear();
+    powerOutputByTag.Clear();
+    powerCapacityByTag.Clear();
 
-    if (colon >= 0 && colon + 1 < content.Length) {
-        string indexPart = content.Substring(colon + 1);
-        int parsed;
-        if (int.TryParse(indexPart, out parsed) && parsed >= 0) {
-            index = parsed;
+    string[] parts = packet.Split('|');
+    if (parts.Length != 3) return;
+
+    string[] entries = parts[2].Split(';');
+    for (int i = 0; i < entries.Length; i++) {
+        string[] f = entries[i].Split(',');
+        if (f.Length != 17 || !IsSnapshotKey(f[0])) continue;
+
+        string key = f[0];
+        bool total = key == TOTAL_KEY;
+        ResourceGroup group = total ? totalGroup : GetOrCreateGroup(key);
+        ReadAccumulator(f, 1, group.Hydrogen);
+        ReadAccumulator(f, 5, group.Oxygen);
+        ReadAccumulator(f, 9, group.Batteries);
+        ReadAccumulator(f, 12, group.Cargo);
+
+        double hRate, oRate, output, capacity;
+        TryFromFixed(f[4], out hRate);
+        TryFromFixed(f[8], out oRate);
+        TryFromFixed(f[15], out output);
+        TryFromFixed(f[16], out capacity);
+        hydrogenRateByKey[key] = hRate;
+        oxygenRateByKey[key] = oRate;
+        lastHydrogenAmount[key] = group.Hydrogen.Current;
+        lastOxygenAmount[key] = group.Oxygen.Current;
+        TrackPeakRate(hydrogenPeakRate, key, hRate);
+        TrackPeakRate(oxygenPeakRate, key, oRate);
+
+        if (total) {
+            totalPowerOutput = output;
+            totalPowerCapacity = capacity;
+        } else {
+            powerOutputByTag[key] = output;
+            powerCapacityByTag[key] = capacity;
         }
     }
 
-    return true;
+    FinishResourceGroups();
+}
+
+void ReadAccumulator(string[] fields, int start, ResourceAccumulator accumulator) {
+    accumulator.Reset();
+    TryFromFixed(fields[start], out accumulator.Current);
+    TryFromFixed(fields[start + 1], out accumulator.Capacity);
+    int.TryParse(fields[start + 2], out accumulator.Count);
 }
 
 bool ContainsIgnoreCase(string source, string value) {
@@ -864,3 +1771,353 @@ bool IsTankType(IMyGasTank tank, string keyword) {
 
     return false;
 }
+
+// Retained sprite dashboard on a SCRIPT surface, one row per line: a text, a
+// bar (label, track, fill, value) or a sparkline (label, one column per
+// sample). A row's sprites are created on its first use, rows in order, and
+// then kept: updates edit them in place and Draw sends a frame only when a
+// text changed or a fill or column moved by a whole pixel.
+class SpriteView {
+    public const int SPARK_SAMPLES = 20;
+    const float LABEL_WIDTH = 0.3f;  // share of the width left of bars and sparklines
+    const float VALUE_WIDTH = 0.2f;  // share of the width right of bars
+    static readonly Color TRACK = new Color(40, 40, 40);
+
+    public readonly IMyTextSurface Surface;
+    readonly List<MySprite> sprites = new List<MySprite>();
+    readonly List<int> drawn = new List<int>();  // per sprite: fill / column px or value shown
+    readonly List<int> rowStart = new List<int>();
+    readonly Dictionary<int, double[]> samples = new Dictionary<int, double[]>();
+    readonly Vector2 origin;
+    readonly float width, rowHeight, textScale;
+    bool dirty = true;
+
+    public SpriteView(IMyTextSurface surface, int rows) {
+        Surface = surface;
+        surface.ScriptBackgroundColor = Color.Black;
+        Vector2 size = surface.SurfaceSize;
+        origin = (surface.TextureSize - size) / 2 + size * 0.02f;
+        width = size.X * 0.96f;
+        rowHeight = size.Y * 0.96f / rows;
+        textScale = Math.Min(1.2f, Math.Min(rowHeight / 34f, width / 500f));
+    }
+
+    public void Text(int row, string text, Color color) {
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            AddText(row, "", origin.X, TextAlignment.LEFT);
+        }
+        int i = rowStart[row];
+        SetText(i, text);
+        SetColor(i, color);
+    }
+
+    // value / 10^decimals + unit on the right; the text is only rebuilt when value changes
+    public void Bar(int row, string label, double ratio, int value, int decimals, string unit, Color color) {
+        float track = width * (1 - LABEL_WIDTH - VALUE_WIDTH);
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            float x = origin.X + width * LABEL_WIDTH;
+            AddText(row, label, origin.X, TextAlignment.LEFT);
+            AddBox(new Vector2(x, Middle(row)), new Vector2(track, rowHeight * 0.6f), TRACK);
+            AddBox(new Vector2(x, Middle(row)), new Vector2(0, rowHeight * 0.6f), color);
+            AddText(row, "", origin.X + width, TextAlignment.RIGHT);
+        }
+        int i = rowStart[row];
+
+        int px = (int)(Math.Max(0, Math.Min(1, ratio)) * track);
+        MySprite fill = sprites[i + 2];
+        if (drawn[i + 2] != px) {
+            drawn[i + 2] = px;
+            fill.Size = new Vector2(px, rowHeight * 0.6f);
+            sprites[i + 2] = fill;
+            dirty = true;
+        }
+        SetColor(i + 2, color);
+
+        if (drawn[i + 3] != value) {
+            drawn[i + 3] = value;
+            string text = decimals == 0 ? value.ToString() : (value / Math.Pow(10, decimals)).ToString("F" + decimals);
+            SetText(i + 3, text + unit);
+        }
+    }
+
+    // Appends one sample (NaN: no new sample, the row is left as it is); full
+    // height is scale, or the largest sample shown when scale is 0. Negative
+    // samples grow downwards in the second color.
+    public void Spark(int row, string label, double sample, double scale, Color up, Color down) {
+        float half = rowHeight * 0.4f;
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            AddText(row, label, origin.X, TextAlignment.LEFT);
+            float step = width * (1 - LABEL_WIDTH) / SPARK_SAMPLES;
+            for (int k = 0; k < SPARK_SAMPLES; k++) {
+                float x = origin.X + width * LABEL_WIDTH + k * step;
+                AddBox(new Vector2(x, Middle(row)), new Vector2(step * 0.8f, 0), up);
+            }
+            samples[row] = new double[SPARK_SAMPLES];
+        }
+        if (double.IsNaN(sample)) return;
+        int first = rowStart[row] + 1;
+
+        double[] ring = samples[row];
+        Array.Copy(ring, 1, ring, 0, SPARK_SAMPLES - 1);
+        ring[SPARK_SAMPLES - 1] = sample;
+        double peak = scale;
+        if (peak <= 0) {
+            for (int k = 0; k < SPARK_SAMPLES; k++) peak = Math.Max(peak, Math.Abs(ring[k]));
+        }
+
+        for (int k = 0; k < SPARK_SAMPLES; k++) {
+            int px = peak > 0 ? (int)(Math.Max(-1, Math.Min(1, ring[k] / peak)) * half) : 0;
+            int i = first + k;
+            if (drawn[i] == px) continue;
+
+            drawn[i] = px;
+            MySprite column = sprites[i];
+            column.Size = new Vector2(column.Size.Value.X, Math.Abs(px));
+            column.Position = new Vector2(column.Position.Value.X, Middle(row) - px / 2f);
+            column.Color = px >= 0 ? up : down;
+            sprites[i] = column;
+            dirty = true;
+        }
+    }
+
+    // Sends the retained sprites if anything moved; false when nothing was sent
+    public bool Draw() {
+        if (Surface.ContentType != ContentType.SCRIPT) {  // back from text mode
+            Surface.ContentType = ContentType.SCRIPT;
+            Surface.Script = "";
+            dirty = true;
+        }
+        if (!dirty) return false;
+
+        dirty = false;
+        using (MySpriteDrawFrame frame = Surface.DrawFrame()) {
+            for (int i = 0; i < sprites.Count; i++) frame.Add(sprites[i]);
+        }
+        return true;
+    }
+
+    float Middle(int row) { return origin.Y + (row + 0.5f) * rowHeight; }
+
+    void AddText(int row, string text, float x, TextAlignment alignment) {
+        float y = Middle(row) - 15f * textScale;  // text is positioned by its top
+        sprites.Add(new MySprite(SpriteType.TEXT, text, new Vector2(x, y), null, Color.White, "Debug", alignment, textScale));
+        drawn.Add(int.MinValue);
+        dirty = true;
+    }
+
+    void AddBox(Vector2 position, Vector2 size, Color color) {
+        sprites.Add(new MySprite(SpriteType.TEXTURE, "SquareSimple", position, size, color, null, TextAlignment.LEFT));
+        drawn.Add(int.MinValue);
+        dirty = true;
+    }
+
+    void SetText(int index, string text) {
+        MySprite sprite = sprites[index];
+        if (sprite.Data == text) return;
+        sprite.Data = text;
+        sprites[index] = sprite;
+        dirty = true;
+    }
+
+    void SetColor(int index, Color color) {
+        MySprite sprite = sprites[index];
+        if (sprite.Color.Value == color) return;
+        sprite.Color = color;
+        sprites[index] = sprite;
+        dirty = true;
+    }
+}
+
+// Sheds features when this PB gets expensive for the server (dedicated
+// servers throttle or stop PBs on their average run time). Every run is
+// sampled (Runtime.LastRunTimeMs, instructions); when the window average goes
+// over budget the level rises one step, under half the budget it drops one
+// step, at most one change per window. Features shed in this order:
+// 1 slower refresh, 2 per-tag breakdowns, 3 rates, 4 everything but a minimal frame.
+class Governor {
+    public const int SLOWER = 1, NO_TAGS = 2, NO_RATES = 3, MINIMAL = 4;
+    static readonly string[] LevelNames = { "full", "slower refresh", "no breakdown", "no rates", "minimal frame" };
+    readonly double[] ms;
+    readonly int[] instructions;
+    readonly double budgetMs;
+    readonly int budgetInstructions;
+    int head, count, sinceChange;
+    double sumMs;
+    long sumInstructions;
+    public int Level;
+    public string Status = "";
+
+    public Governor(int window, double budgetMs, int budgetInstructions) {
+        ms = new double[window];
+        instructions = new int[window];
+        this.budgetMs = budgetMs;
+        this.budgetInstructions = budgetInstructions;
+    }
+
+    public bool Allows(int feature) { return Level < feature; }
+    public double AverageMs { get { return count > 0 ? sumMs / count : 0; } }
+    public double AverageInstructions { get { return count > 0 ? (double)sumInstructions / count : 0; } }
+
+    // lastRunMs: the previous run (Runtime.LastRunTimeMs); used: this run's instructions
+    public void Sample(double lastRunMs, int used) {
+        if (count == ms.Length) { sumMs -= ms[head]; sumInstructions -= instructions[head]; }
+        else count++;
+        ms[head] = lastRunMs;
+        instructions[head] = used;
+        sumMs += lastRunMs;
+        sumInstructions += used;
+        head = (head + 1) % ms.Length;
+        if (++sinceChange < ms.Length || count < ms.Length) return;
+
+        double load = Math.Max(AverageMs / budgetMs, AverageInstructions / budgetInstructions);
+        int previous = Level;
+        if (load > 1 && Level < MINIMAL) Level++;
+        else if (load < 0.5 && Level > 0) Level--;
+        if (Level == previous) return;
+        sinceChange = 0;
+        Status = Level == 0 ? "" : "Governor: " + LevelNames[Level] + " (" + AverageMs.ToString("0.00") + " ms/run)";
+    }
+}
+
+// Finds every keyword and tag of the script in a block name in one pass
+// (Aho-Corasick automaton, case-insensitive), plus the path of every [tag]
+// ("Miner1:Cargo", ":"-separated, each path once).
+// Results are cached per block until its name changes.
+// Keyword("Locked") matches anywhere; Tag("[YST") matches "[YST]" and
+// "[YST:n]" (index n) but not "[YST LOG]".
+class NameMatcher {
+    readonly List<Dictionary<char, int>> next = new List<Dictionary<char, int>> { new Dictionary<char, int>() };
+    readonly List<int> fail = new List<int> { 0 }, ends = new List<int> { 0 };
+    int count, tagMask, sweep;
+    readonly Dictionary<long, NameMatch> cache = new Dictionary<long, NameMatch>();
+
+    public int Keyword(string text) { return Add(text, false); }
+    public int Tag(string prefix) { return Add(prefix, true); }
+
+    int Add(string text, bool tag) {
+        int id = count++;
+        if (id == 32) throw new Exception("NameMatcher: 32 patterns max");
+        int s = 0;
+        foreach (char raw in text) {
+            char c = char.ToUpperInvariant(raw);
+            int t;
+            if (!next[s].TryGetValue(c, out t)) {
+                t = next.Count;
+                next.Add(new Dictionary<char, int>());
+                fail.Add(0);
+                ends.Add(0);
+                next[s][c] = t;
+            }
+            s = t;
+        }
+        ends[s] |= 1 << id;
+        if (tag) tagMask |= 1 << id;
+        return id;
+    }
+
+    // Failure links, breadth first; call once after the last Keyword/Tag
+    public void Build() {
+        var queue = new Queue<int>();
+        foreach (var t in next[0].Values) queue.Enqueue(t);
+        while (queue.Count > 0) {
+            int s = queue.Dequeue();
+            foreach (var kv in next[s]) {
+                int f = fail[s], t;
+                while (f > 0 && !next[f].ContainsKey(kv.Key)) f = fail[f];
+                fail[kv.Value] = next[f].TryGetValue(kv.Key, out t) ? t : 0;
+                ends[kv.Value] |= ends[fail[kv.Value]];
+                queue.Enqueue(kv.Value);
+            }
+        }
+    }
+
+    public NameMatch Match(IMyTerminalBlock block) {
+        NameMatch m;
+        string name = block.CustomName;
+        if (!cache.TryGetValue(block.EntityId, out m)) cache[block.EntityId] = m = new NameMatch(count);
+        else if (m.Name == name) { m.Sweep = sweep; return m; }
+        Scan(name, m);
+        m.Sweep = sweep;
+        return m;
+    }
+
+    public NameMatch Match(string name) {
+        var m = new NameMatch(count);
+        Scan(name, m);
+        return m;
+    }
+
+    // Forgets the blocks not matched since the previous call (call after a rescan)
+    public void Sweep() {
+        var gone = new List<long>();
+        foreach (var kv in cache) if (kv.Value.Sweep != sweep) gone.Add(kv.Key);
+        foreach (var id in gone) cache.Remove(id);
+        sweep++;
+    }
+
+    void Scan(string name, NameMatch m) {
+        m.Name = name;
+        m.Hits = 0;
+        m.Tags.Clear();
+        for (int i = 0; i < m.Index.Length; i++) m.Index[i] = -1;
+        if (name == null) return;
+
+        int s = 0, open = -1;
+        for (int i = 0; i < name.Length; i++) {
+            char c = char.ToUpperInvariant(name[i]);
+            if (c == '[') open = i;
+            else if (c == ']' && open >= 0) {
+                AddTag(name, open + 1, i, m);
+                open = -1;
+            }
+
+            int t;
+            while (s > 0 && !next[s].ContainsKey(c)) s = fail[s];
+            s = next[s].TryGetValue(c, out t) ? t : 0;
+            for (int hits = ends[s]; hits != 0; hits &= hits - 1) {
+                int id = 0;
+                while ((hits & (1 << id)) == 0) id++;
+                if ((tagMask & (1 << id)) == 0) m.Hits |= 1 << id;
+                else TagEnd(name, i + 1, id, m);
+            }
+        }
+    }
+
+    // Segments trimmed, a last numeric one is an index: "[Hangar:2]" -> "Hangar"
+    static void AddTag(string name, int start, int end, NameMatch m) {
+        string[] parts = name.Substring(start, end - start).Split(':');
+        int count = parts.Length, index;
+        if (count > 1 && int.TryParse(parts[count - 1], out index)) count--;
+        for (int i = 0; i < count; i++) {
+            parts[i] = parts[i].Trim();
+            if (parts[i].Length == 0) return;
+        }
+        string tag = string.Join(":", parts, 0, count);
+        foreach (var t in m.Tags) if (string.Equals(t, tag, StringComparison.OrdinalIgnoreCase)) return;
+        m.Tags.Add(tag);
+    }
+
+    // After a tag prefix: "]" (no index) or ":digits]"
+    static void TagEnd(string name, int at, int id, NameMatch m) {
+        if (at >= name.Length) return;
+        if (name[at] == ']') { m.Hits |= 1 << id; return; }
+        if (name[at] != ':') return;
+        int value = 0, i = at + 1;
+        while (i < name.Length && char.IsDigit(name[i]) && value < 100000) value = value * 10 + name[i++] - '0';
+        if (i == at + 1 || i >= name.Length || name[i] != ']') return;
+        if ((m.Hits & (1 << id)) == 0) m.Index[id] = value;
+        m.Hits |= 1 << id;
+    }
+}
+
+class NameMatch {
+    public string Name;
+    public int Hits, Sweep;
+    public readonly int[] Index;                            // per Tag(): ":n" index, -1 = none
+    public readonly List<string> Tags = new List<string>(); // every [tag] path, e.g. "Hangar" for [Hangar:2], "Miner1:Cargo"
+    public NameMatch(int patterns) { Index = new int[patterns]; }
+    public bool Has(int id) { return (Hits & (1 << id)) != 0; }
+}
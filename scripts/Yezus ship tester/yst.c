@@ -1,14 +1,80 @@
-// === [YST Ship Load Overview v3.8 - Titles, pages, detail nav] ===
-// Works on cockpit screens tagged [YST:index] or panels [YST]
+// === [YST Ship Load Overview v3.9 - Multi-surface output] ===
+// Works on every cockpit screen tagged [YST:index] and every panel [YST]
 // Accurate thrust & load ratios, multi-page LCD, 0g compatible
+// Base side: ships docked to [QG] connectors listed on [YST HANGAR] panels
+// "live": flight telemetry at Update10 (TWR, stopping distance, H2 burn)
 
 List<IMyThrust> thrusters = new List<IMyThrust>();
 List<IMyShipController> controllers = new List<IMyShipController>();
 List<IMyTerminalBlock> containers = new List<IMyTerminalBlock>();
 List<IMyCargoContainer> cargoContainers = new List<IMyCargoContainer>();
 List<IMyGasTank> gasTanks = new List<IMyGasTank>();
-IMyTextSurface surface; // can be cockpit LCD or panel
+List<YstDisplay> displays = new List<YstDisplay>();
+IMyTextSurface surface; // surface currently being rendered (cockpit LCD or panel)
 IMyTextPanel lcd;
+NameMatcher names = new NameMatcher(); // [YST] / [YST:index], un seul passage par nom
+int ystTag, hangarTag, dockTag;
+
+class YstDisplay {
+    public IMyTextSurface Surface;
+    public TextMetrics Metrics = new TextMetrics();
+    public SpriteView View; // live view, Sprites only
+    public double SparkAt = -1; // H2 rate sample shown last
+}
+
+// Measured font metrics for one surface, keyed by (font, size, surface size).
+// MeasureStringInPixels only runs when that key changes, glyphs lazily once.
+class TextMetrics {
+    public string Font;
+    public float Scale;
+    public Vector2 Size = new Vector2(-1, -1);
+    public float Width, Height;      // usable area (px) inside text padding
+    public float LineHeight;         // px per line at Scale
+    public int MaxLines, Columns;
+    Dictionary<char,float> glyphs = new Dictionary<char,float>();
+    System.Text.StringBuilder probe = new System.Text.StringBuilder();
+    IMyTextSurface surf;
+
+    public bool Update(IMyTextSurface s) {
+        if (s == surf && s.Font == Font && s.FontSize == Scale && s.SurfaceSize == Size) return false;
+        surf = s; Font = s.Font; Scale = s.FontSize; Size = s.SurfaceSize;
+        glyphs.Clear();
+        float pad = 1f - s.TextPadding / 50f;
+        Width = Size.X * pad; Height = Size.Y * pad;
+        probe.Clear().Append('M');
+        float one = s.MeasureStringInPixels(probe, Font, Scale).Y;
+        probe.Append('\n').Append('M');
+        float two = s.MeasureStringInPixels(probe, Font, Scale).Y;
+        LineHeight = (two - one) > 0 ? (two - one) : Math.Max(1f, one);
+        MaxLines = Math.Max(1, (int)((Height - one) / LineHeight) + 1);
+        Columns = Math.Max(1, (int)(Width / Math.Max(1f, Glyph(' '))));
+        return true;
+    }
+
+    public float Glyph(char c) {
+        float w;
+        if (glyphs.TryGetValue(c, out w)) return w;
+        probe.Clear().Append(c);
+        w = surf.MeasureStringInPixels(probe, Font, Scale).X;
+        glyphs[c] = w;
+        return w;
+    }
+
+    public float TextWidth(string text) {
+        float w = 0;
+        for (int i=0;i<text.Length;i++) w += Glyph(text[i]);
+        return w;
+    }
+}
+
+// Ship model, computed once per run and shared by every display
+IMyShipController ctrl;
+TextMetrics metrics; // metrics of the display being rendered
+MatrixD refMatrix;
+double shipMass, baseEmptyMass;
+double up, down, left, right, forward, backward, upForward;
+double totalL, usedL, fill;
+double compMass, oreMass, iceMass;
 
 const double EarthGravityWellMeters = 60000.0;   // Approx altitude to exit Earthlike gravity (~60 km)
 const double EarthPlanetRadiusMeters = 60000.0;  // Earthlike planet radius in SE
@@ -19,16 +85,106 @@ const double MoonSurfaceGravity = EarthSurfaceGravity * 0.25; // ~0.25g at moon
 const double HydroConsumptionPerNewtonSecond = 1.0e-3; // Conservative hydro usage per N*s
 const double HydroClimbSpeed = 90.0;             // Typical sustained vertical speed with loaded ships
 const double HydroThrottleBuffer = 1.25;         // Pilot throttle overhead / maneuvering losses
+const int WatchSlice = 100;                      // Blocks fingerprinted per Update100 run
+const string HangarTag = "[YST HANGAR]";         // Base-side LCDs listing the docked ships
+const string DockTag = "[QG]";                   // Base connectors ships dock to
+const double LaunchTwr = 1.2;                    // Min up TWR at local gravity to launch
+const double LoadedDensity = 2.5;                // kg/L of a full cargo (ore scenario)
+const double MassChangeKg = 500;                 // Cargo change that triggers a re-evaluation
+
+// Ship overview, built once per refresh (BuildShipTables): counts in fixed
+// tables, the lines of each section, and per page height the first section
+// of every page, so rendering a page only writes its own lines
+int[] thrustTable = new int[36]; // side * 6 + kind (IS IB HS HB AS AB)
+string[] SideNames = { "Up", "Down", "Left", "Right", "Fwd", "Back" };
+List<string> cargoKinds = new List<string>(), h2Kinds = new List<string>(), o2Kinds = new List<string>();
+List<int> cargoCounts = new List<int>(), h2Counts = new List<int>(), o2Counts = new List<int>();
+List<string> shipLines = new List<string>();
+List<int> sectionStart = new List<int>(); // first line of each section, then the end
+Dictionary<int, List<int>> sliceIndex = new Dictionary<int, List<int>>(); // page height -> first section per page, then the end
+IMyShipController tableCtrl; // tables follow the main controller's frame
+
+// Live flight: thrusters grouped by axis at refresh, one axis re-summed per
+// tick (effective thrust drifts with altitude and air), CalculateShipMass
+// only when the cargo volume moved, hydrogen burn over LiveRateSeconds
+const double LiveRateSeconds = 2;
+bool live;
+double clock;
+IMyShipController liveCtrl;
+List<IMyThrust>[] axisThrusters = new List<IMyThrust>[6];
+double[] axisThrust = new double[6]; // N per axis, see Axis()
+List<IMyGasTank> h2Tanks = new List<IMyGasTank>();
+int liveAxis;
+double liveMass, liveVolume = -1, liveH2 = -1, liveH2At, h2Rate;
+double stopTime, stopDistSq;
+bool canStop;
+System.Text.StringBuilder liveText = new System.Text.StringBuilder();
+// Sprites: live view as a SpriteView (TWR bars full at LiveTwrFull, H2 burn
+// sparkline), a frame only sent when a bar, a column or a text changed
+const bool Sprites = false;
+const double LiveTwrFull = 3;
+
+// Governor (class Governor): over budget on average, the live view ticks every
+// GovernorSlowFactor Update10, then the hangar pauses, then the H2 rate, then
+// the live view shrinks to speed and stop
+const double GovernorBudgetMs = 0.25;
+const int GovernorBudgetInstructions = 10000;
+const int GovernorWindow = 30;                   // runs (~5 s at Update10)
+const int GovernorSlowFactor = 3;
+Governor governor = new Governor(GovernorWindow, GovernorBudgetMs, GovernorBudgetInstructions);
+int liveSkip;
+
+// Change detector: checks one slice per run of the block list kept by RefreshBlocks
+// (closed blocks, name hashes); a pass ends with one typed count query, rotating over
+// WatchKinds types, for built blocks
+const int WatchKinds = 6;
+List<IMyTerminalBlock> watchBlocks = new List<IMyTerminalBlock>();
+List<IMyTerminalBlock> watchProbe = new List<IMyTerminalBlock>();
+int[] watchKindCounts = new int[WatchKinds];
+int watchCursor, watchKind;
+long watchNames, lastWatchNames;
+bool watchClosed;
+
+// Docked ships, one per construct behind a [QG] connector. Blocks are split
+// per ship at rescan (one pass, each grid resolved once); mass and thrust are
+// cached per ship and re-evaluated only when its cargo mass moved.
+class DockedShip {
+    public IMyShipConnector Link;      // the ship's connector
+    public string Name;
+    public IMyShipController Ctrl;
+    public List<IMyThrust> Thrusters = new List<IMyThrust>();
+    public List<IMyInventory> Inventories = new List<IMyInventory>();
+    public double[] Thrust = new double[6]; // N: up, down, left, right, fwd, back
+    public double CargoMass = -1, Mass, BaseMass, CapacityL, Gravity;
+}
+List<DockedShip> ships = new List<DockedShip>();
+Dictionary<IMyCubeGrid, int> shipByGrid = new Dictionary<IMyCubeGrid, int>();
+List<IMyTextPanel> hangars = new List<IMyTextPanel>();
+List<IMyShipConnector> docks = new List<IMyShipConnector>();
+List<IMyTerminalBlock> allBlocks = new List<IMyTerminalBlock>();
+System.Text.StringBuilder hangarText = new System.Text.StringBuilder();
+int shipCursor;
+bool hangarDirty;
 
 public Program() {
-    Runtime.UpdateFrequency = UpdateFrequency.None;
+    Runtime.UpdateFrequency = UpdateFrequency.Update100; // change detection only, renders stay on demand
+    ystTag = names.Tag("[YST");
+    hangarTag = names.Keyword(HangarTag);
+    dockTag = names.Keyword(DockTag);
+    names.Build();
     RefreshBlocks();
     if (string.IsNullOrEmpty(Storage)) Storage = "mode=overview;scenario=comp;slice=25;cursor=0";
+    for (int a = 0; a < 6; a++) axisThrusters[a] = new List<IMyThrust>();
+    live = Storage.StartsWith("mode=live;");
+    if (live) Runtime.UpdateFrequency |= UpdateFrequency.Update10;
 }
 
 void RefreshBlocks() {
     surface = null;
     lcd = null;
+    tableCtrl = null;
+    liveCtrl = null;
+    displays.Clear();
 
     GridTerminalSystem.GetBlocksOfType(thrusters, t => t.CubeGrid == Me.CubeGrid);
     GridTerminalSystem.GetBlocksOfType(controllers, c => c.CubeGrid == Me.CubeGrid);
@@ -37,92 +193,77 @@ void RefreshBlocks() {
     GridTerminalSystem.GetBlocksOfType(cargoContainers, c => c.CubeGrid == Me.CubeGrid);
     GridTerminalSystem.GetBlocksOfType(gasTanks, t => t.CubeGrid == Me.CubeGrid);
 
-    // 1) Priorite: LCD panel avec [YST]
+    // 1) Tous les LCD panels avec [YST]
     List<IMyTextPanel> panels = new List<IMyTextPanel>();
-    GridTerminalSystem.GetBlocksOfType(panels, p => p.CubeGrid == Me.CubeGrid && p.CustomName.Contains("[YST]"));
-    if (panels.Count > 0) {
-        lcd = panels[0];
-        surface = lcd as IMyTextSurface;
-        return;
-    }
+    GridTerminalSystem.GetBlocksOfType(panels, p => p.CubeGrid == Me.CubeGrid && names.Match(p).Has(ystTag));
+    foreach (var p in panels) AddDisplay(p);
 
-    // 2) Sinon, cockpit tagge [YST:index]
+    // 2) Et tous les cockpits tagges [YST:index]
     List<IMyCockpit> cockpits = new List<IMyCockpit>();
-    GridTerminalSystem.GetBlocksOfType(cockpits, c => c.CubeGrid == Me.CubeGrid && c.CustomName.Contains("[YST:"));
+    GridTerminalSystem.GetBlocksOfType(cockpits, c => c.CubeGrid == Me.CubeGrid && names.Match(c).Index[ystTag] >= 0);
     foreach (var c in cockpits) {
         var sp = c as IMyTextSurfaceProvider;
         if (sp == null || sp.SurfaceCount == 0) continue;
-        string name = c.CustomName;
-        int start = name.IndexOf("[YST:") + 5;
-        int end = name.IndexOf("]", start);
-        if (start < 5 || end < 0) continue;
-        string numStr = name.Substring(start, end - start);
-        int index;
-        if (!int.TryParse(numStr, out index)) index = 0;
-        if (index < 0 || index >= sp.SurfaceCount) index = 0;
-        surface = sp.GetSurface(index);
-        return;
+        int index = names.Match(c).Index[ystTag];
+        if (index >= sp.SurfaceCount) index = 0;
+        AddDisplay(sp.GetSurface(index));
     }
+    RefreshHangar();
+    names.Sweep();
+    ResetWatch();
+
+    if (panels.Count > 0) lcd = panels[0];
+    if (displays.Count > 0) surface = displays[0].Surface;
+}
+
+void AddDisplay(IMyTextSurface s) {
+    var d = new YstDisplay();
+    d.Surface = s;
+    displays.Add(d);
 }
 
 public void Main(string argument, UpdateType updateSource) {
-    if (surface == null) {
-        RefreshBlocks();
-        if (surface == null) {
-            Echo("No [YST] display found.");
+    Tick(argument, updateSource);
+    governor.Sample(Runtime.LastRunTimeMs, Runtime.CurrentInstructionCount);
+    if (governor.Level > 0) Echo(governor.Status);
+}
+
+void Tick(string argument, UpdateType updateSource) {
+    clock += Runtime.TimeSinceLastRun.TotalSeconds;
+    // Timer ticks watch for block changes and the docked ships (Update100) and
+    // refresh the live view (Update10); full re-render after a rescan
+    if ((updateSource & (UpdateType.Update10 | UpdateType.Update100)) != 0 && string.IsNullOrEmpty(argument)) {
+        bool changed = false;
+        if ((updateSource & UpdateType.Update100) != 0) {
+            changed = BlocksChanged();
+            if (changed) RefreshBlocks();
+            if (governor.Allows(Governor.NO_TAGS)) StepHangar();
+        }
+        if (!changed) { if (live) LiveTick(); return; }
+    }
+
+    if (displays.Count == 0) {
+        if (hangars.Count == 0) RefreshBlocks(); // a hangar-only PB keeps its ship cache
+        if (displays.Count == 0) {
+            Echo(hangars.Count > 0 ? "YST hangar: " + ships.Count + " docked ship(s)" : "No [YST] display found.");
             return; 
         }
     }
 
-    surface.ContentType = ContentType.TEXT_AND_IMAGE;
-    surface.Font = "Monospace";
-    surface.FontSize = 0.7f;
-    surface.Alignment = TextAlignment.LEFT;
-    surface.WriteText("", false);
+    foreach (var d in displays) {
+        d.Surface.ContentType = ContentType.TEXT_AND_IMAGE;
+        d.Surface.Font = "Monospace";
+        d.Surface.FontSize = 0.7f;
+        d.Surface.Alignment = TextAlignment.LEFT;
+        d.Surface.WriteText("", false);
+    }
 
     if (controllers.Count == 0) {
-        surface.WriteText("No cockpit/RC found.", false);
+        foreach (var d in displays) d.Surface.WriteText("No cockpit/RC found.", false);
         return;
     }
 
-    IMyShipController ctrl = GetMainController();
-    MatrixD refMatrix = ctrl.WorldMatrix;
-    var sm = ctrl.CalculateShipMass();
-    double shipMass = sm.PhysicalMass;      // includes current inventory
-    double baseEmptyMass = sm.BaseMass;     // empty mass without inventory
-
-    // === Directional thrust relative to cockpit ===
-    double up=0,down=0,left=0,right=0,forward=0,backward=0;
-    foreach (var t in thrusters) {
-        double thrustKg = t.MaxEffectiveThrust * 0.1019716213;
-        Vector3D thrDir = -t.WorldMatrix.Forward; // thrust direction
-        Vector3D local = Vector3D.TransformNormal(thrDir, MatrixD.Transpose(refMatrix));
-
-        if (local.Y > 0.9) up += thrustKg;
-        else if (local.Y < -0.9) down += thrustKg;
-        else if (local.Z < -0.9) forward += thrustKg;   // cockpit -Z is Forward
-        else if (local.Z > 0.9) backward += thrustKg;  // cockpit +Z is Backward
-        else if (local.X > 0.9) right += thrustKg;
-        else if (local.X < -0.9) left += thrustKg;
-    }
-
-    // === Cargo ===
-    double totalVol=0,usedVol=0;
-    for (int i=0;i<containers.Count;i++)
-        for (int inv=0;inv<containers[i].InventoryCount;inv++) {
-            var invRef=containers[i].GetInventory(inv);
-            totalVol+=(double)invRef.MaxVolume;
-            usedVol+=(double)invRef.CurrentVolume;
-        }
-    double totalL=totalVol*1000, usedL=usedVol*1000;
-    double fill=(totalL>0)?(usedL/totalL*100):0;
-
-    // === Densités ===
-    double compD=0.7, oreD=2.5, iceD=0.9;
-    double compMass=totalL*compD, oreMass=totalL*oreD, iceMass=totalL*iceD;
-
-    // === Combo Up + Fw (45°) ===
-    double upForward=(up*0.707)+(forward*0.707);
+    ComputeModel();
 
     // === New UI state machine (modes + cursor) ===
     string mode = "overview", scenario = "empty"; int slice = 25; int cursor = 0; int shipSlice = 0;
@@ -143,6 +284,7 @@ public void Main(string argument, UpdateType updateSource) {
     if (arg == "empty") { mode = "thrust_overview"; cursor=0; }
     if (arg == "ship") { mode = "ship_overview"; cursor=0; shipSlice=0; }
     if (arg == "menu") { mode = "overview"; cursor=0; }
+    if (arg == "live") { mode = "live"; cursor=0; }
 
     // cursor bounds computed by helper outside Main
 
@@ -156,12 +298,14 @@ public void Main(string argument, UpdateType updateSource) {
         else if (mode=="scenario_detail") { mode = "scenario_overview"; cursor=0; }
         else if (mode=="scenario_slice") { mode = "scenario_detail"; cursor=0; }
         else if (mode=="ship_overview") { mode = "overview"; cursor=0; }
+        else if (mode=="live") { mode = "overview"; cursor=0; }
     }
     else if (arg == "apply") {
         if (mode=="overview") {
             if (cursor==0) { mode = "thrust_overview"; cursor=0; }
             else if (cursor==1) { mode = "scenario_overview"; if (string.IsNullOrEmpty(scenario)) scenario="comp"; cursor=0; }
             else if (cursor==2) { mode = "ship_overview"; cursor=0; shipSlice=0; }
+            else if (cursor==3) { mode = "live"; cursor=0; }
         } else if (mode=="thrust_overview") {
             if (cursor==0) { mode = "thrust_detail"; cursor=0; }
             else if (cursor==1) { mode = "overview"; cursor=0; }
@@ -186,13 +330,70 @@ public void Main(string argument, UpdateType updateSource) {
         } else if (mode=="ship_overview") {
             if (cursor==0) { shipSlice++; }
             else if (cursor==1) { mode = "overview"; cursor=0; }
+        } else if (mode=="live") {
+            mode = "overview"; cursor=0;
         }
     }
 
     // Save
     Storage = "mode="+mode+";scenario="+scenario+";slice="+slice.ToString()+";cursor="+cursor.ToString()+";shipslice="+shipSlice.ToString();
+    if (live != (mode=="live")) {
+        live = mode=="live";
+        Runtime.UpdateFrequency = live ? UpdateFrequency.Update10 | UpdateFrequency.Update100 : UpdateFrequency.Update100;
+    }
+
+    // Render the same state on every display, each with its own layout
+    foreach (var d in displays) {
+        surface = d.Surface;
+        d.Metrics.Update(d.Surface);
+        metrics = d.Metrics;
+        Render(d, mode, scenario, slice, cursor, shipSlice);
+    }
+}
+
+// Ship mass, directional thrust and cargo, shared by all displays
+void ComputeModel() {
+    ctrl = GetMainController();
+    refMatrix = ctrl.WorldMatrix;
+    var sm = ctrl.CalculateShipMass();
+    shipMass = sm.PhysicalMass;      // includes current inventory
+    baseEmptyMass = sm.BaseMass;     // empty mass without inventory
+
+    // === Directional thrust relative to cockpit ===
+    up=0;down=0;left=0;right=0;forward=0;backward=0;
+    foreach (var t in thrusters) {
+        double thrustKg = t.MaxEffectiveThrust * 0.1019716213;
+        Vector3D thrDir = -t.WorldMatrix.Forward; // thrust direction
+        Vector3D local = Vector3D.TransformNormal(thrDir, MatrixD.Transpose(refMatrix));
+
+        if (local.Y > 0.9) up += thrustKg;
+        else if (local.Y < -0.9) down += thrustKg;
+        else if (local.Z < -0.9) forward += thrustKg;   // cockpit -Z is Forward
+        else if (local.Z > 0.9) backward += thrustKg;  // cockpit +Z is Backward
+        else if (local.X > 0.9) right += thrustKg;
+        else if (local.X < -0.9) left += thrustKg;
+    }
+
+    // === Cargo ===
+    double totalVol=0,usedVol=0;
+    for (int i=0;i<containers.Count;i++)
+        for (int inv=0;inv<containers[i].InventoryCount;inv++) {
+            var invRef=containers[i].GetInventory(inv);
+            totalVol+=(double)invRef.MaxVolume;
+            usedVol+=(double)invRef.CurrentVolume;
+        }
+    totalL=totalVol*1000; usedL=usedVol*1000;
+    fill=(totalL>0)?(usedL/totalL*100):0;
 
-    // Render
+    // === Densités ===
+    double compD=0.7, oreD=2.5, iceD=0.9;
+    compMass=totalL*compD; oreMass=totalL*oreD; iceMass=totalL*iceD;
+
+    // === Combo Up + Fw (45°) ===
+    upForward=(up*0.707)+(forward*0.707);
+}
+
+void Render(YstDisplay display, string mode, string scenario, int slice, int cursor, int shipSlice) {
     if (mode=="overview") {
         Title("Overview", 1, 1);
         WriteLine("Mass: " + Fm(shipMass));
@@ -204,31 +405,31 @@ public void Main(string argument, UpdateType updateSource) {
         WriteLine((cursor==0?"> ":"  ") + "Thrust overview");
         WriteLine((cursor==1?"> ":"  ") + "Scenarios");
         WriteLine((cursor==2?"> ":"  ") + "Ship overview");
+        WriteLine((cursor==3?"> ":"  ") + "Live flight");
         WriteFooterText("up/down, apply, menu");
         return;
     }
 
+    if (mode=="live") {
+        if (liveCtrl != ctrl) BuildLiveTables();
+        liveMass = shipMass; liveVolume = usedL / 1000; // just measured by ComputeModel
+        if (Sprites) LiveSprites(display);
+        else surface.WriteText(LiveText(), false);
+        return;
+    }
+
     if (mode=="ship_overview") {
         Title("Ship overview", 1, 1);
-        int maxLines = ComputeMaxLines(surface);
-        int reserve = 4; // footer + options spacing
-        int avail = Math.Max(8, maxLines - reserve);
-
-        var sections = BuildShipSections(refMatrix);
-        // Slice packing by full sections
-        int start = 0; int end = 0; int current = 0;
-        while (true) {
-            int lines = 0; end = start;
-            while (end < sections.Count && lines + sections[end].Count <= avail) { lines += sections[end].Count; end++; }
-            if (current == shipSlice) break;
-            current++;
-            if (end >= sections.Count) { shipSlice = 0; start = 0; current = 0; continue; }
-            start = end;
-        }
-        // Render this slice
+        int maxLines = display.Metrics.MaxLines;
+        int reserve = 7; // title + blank, options spacing + 2 options, footer
+        int avail = Math.Max(1, maxLines - reserve);
+
+        if (tableCtrl != ctrl) BuildShipTables();
+        var pages = SliceIndex(avail);
+        int page = shipSlice % (pages.Count - 1); // past the last page, wrap around
+        int start = pages[page], end = pages[page + 1];
         for (int i=start;i<end;i++) {
-            var block = sections[i];
-            for (int j=0;j<block.Count;j++) WriteLine(block[j]);
+            for (int j=sectionStart[i];j<sectionStart[i + 1];j++) WriteLine(shipLines[j]);
             if (i<end-1) WriteLine("");
         }
         WriteLine("");
@@ -349,6 +550,288 @@ public void Main(string argument, UpdateType updateSource) {
 }
 
 // === Helpers ===
+// Once per RefreshBlocks: the only full listing for change detection
+void ResetWatch() {
+    GridTerminalSystem.GetBlocksOfType(watchBlocks, Watched);
+    lastWatchNames = 0;
+    foreach (var b in watchBlocks) lastWatchNames += NameHash(b);
+    for (int k = 0; k < WatchKinds; k++) watchKindCounts[k] = ProbeCount(k);
+    watchCursor = 0; watchNames = 0; watchClosed = false;
+}
+
+bool BlocksChanged() {
+    int end = Math.Min(watchBlocks.Count, watchCursor + WatchSlice);
+    for (int i = watchCursor; i < end; i++) {
+        var b = watchBlocks[i];
+        if (b.Closed) { watchClosed = true; continue; }
+        watchNames += NameHash(b);
+    }
+    watchCursor = end;
+    if (watchCursor < watchBlocks.Count) return false;
+    bool changed = watchClosed || watchNames != lastWatchNames || ProbeCount(watchKind) != watchKindCounts[watchKind];
+    watchKind = (watchKind + 1) % WatchKinds;
+    watchCursor = 0; watchNames = 0; watchClosed = false;
+    return changed;
+}
+
+// Hangar mode watches the whole terminal system: docking adds the ship's blocks
+bool Watched(IMyTerminalBlock b) { return hangars.Count > 0 || b.CubeGrid == Me.CubeGrid; }
+
+long NameHash(IMyTerminalBlock b) { return (long)b.CustomName.GetHashCode() * 31 + (b.EntityId & 0xFFFF); }
+
+int ProbeCount(int kind) {
+    switch (kind) {
+        case 0: GridTerminalSystem.GetBlocksOfType<IMyThrust>(watchProbe, Watched); break;
+        case 1: GridTerminalSystem.GetBlocksOfType<IMyShipController>(watchProbe, Watched); break;
+        case 2: GridTerminalSystem.GetBlocksOfType<IMyCargoContainer>(watchProbe, Watched); break;
+        case 3: GridTerminalSystem.GetBlocksOfType<IMyGasTank>(watchProbe, Watched); break;
+        case 4: GridTerminalSystem.GetBlocksOfType<IMyTextPanel>(watchProbe, Watched); break;
+        default: GridTerminalSystem.GetBlocksOfType<IMyShipConnector>(watchProbe, Watched); break;
+    }
+    return watchProbe.Count;
+}
+
+// Thrust direction in the controller frame: 0 up, 1 down, 2 left, 3 right, 4 fwd, 5 back
+string[] AxisNames = { "U", "D", "L", "R", "F", "B" };
+int Axis(Vector3D local) {
+    if (local.Y > 0.9) return 0; if (local.Y < -0.9) return 1;
+    if (local.X < -0.9) return 2; if (local.X > 0.9) return 3;
+    if (local.Z < -0.9) return 4; if (local.Z > 0.9) return 5; // cockpit -Z is Forward
+    return -1;
+}
+
+// === Live flight ===
+void BuildLiveTables() {
+    liveCtrl = ctrl;
+    MatrixD inv = MatrixD.Transpose(ctrl.WorldMatrix);
+    for (int a = 0; a < 6; a++) { axisThrusters[a].Clear(); axisThrust[a] = 0; }
+    foreach (var t in thrusters) {
+        int a = Axis(Vector3D.TransformNormal(-t.WorldMatrix.Forward, inv));
+        if (a < 0) continue;
+        axisThrusters[a].Add(t);
+        if (t.IsWorking) axisThrust[a] += t.MaxEffectiveThrust;
+    }
+    h2Tanks.Clear();
+    foreach (var t in gasTanks)
+        if ((t.DefinitionDisplayNameText ?? t.CustomName ?? "").ToLower().Contains("hydrogen")) h2Tanks.Add(t);
+    liveVolume = -1; liveH2 = -1; h2Rate = 0;
+}
+
+// Per tick: one axis, the cargo volume, the velocity; mass and H2 when due
+void LiveTick() {
+    if (displays.Count == 0 || controllers.Count == 0) return;
+    if (!governor.Allows(Governor.SLOWER) && ++liveSkip < GovernorSlowFactor) return;
+    liveSkip = 0;
+    if (liveCtrl == null || liveCtrl.Closed) { ComputeModel(); BuildLiveTables(); }
+
+    var list = axisThrusters[liveAxis];
+    double sum = 0;
+    for (int i = 0; i < list.Count; i++) if (list[i].IsWorking) sum += list[i].MaxEffectiveThrust;
+    axisThrust[liveAxis] = sum;
+    liveAxis = (liveAxis + 1) % 6;
+
+    double volume = 0;
+    for (int i = 0; i < containers.Count; i++)
+        for (int n = 0; n < containers[i].InventoryCount; n++) volume += (double)containers[i].GetInventory(n).CurrentVolume;
+    if (volume != liveVolume) { liveVolume = volume; liveMass = ctrl.CalculateShipMass().PhysicalMass; }
+
+    if (!governor.Allows(Governor.NO_RATES)) { liveH2 = -1; h2Rate = 0; }
+    else if (liveH2 < 0 || clock - liveH2At >= LiveRateSeconds) {
+        double h2 = 0;
+        for (int i = 0; i < h2Tanks.Count; i++) h2 += h2Tanks[i].FilledRatio * h2Tanks[i].Capacity;
+        if (liveH2 >= 0) h2Rate += 0.5 * ((liveH2 - h2) / (clock - liveH2At) - h2Rate);
+        liveH2 = h2; liveH2At = clock;
+    }
+
+    if (Sprites) { foreach (var d in displays) LiveSprites(d); return; }
+    string text = LiveText();
+    foreach (var d in displays) d.Surface.WriteText(text, false);
+}
+
+string LiveText() {
+    Vector3D v = ctrl.GetShipVelocities().LinearVelocity;
+    Vector3D gv = ctrl.GetNaturalGravity();
+    double g = gv.Length(), speed = v.Length();
+    double vertical = g > 0.01 ? -Vector3D.Dot(v, gv) / g : 0;
+    UpdateStop(v);
+
+    double gEff = g < 0.1 ? EarthSurfaceGravity : g;
+    liveText.Clear();
+    liveText.Append("=== Live flight ===\n\n");
+    liveText.Append("Speed ").Append(speed.ToString("0.0")).Append(" m/s  V ").Append(vertical >= 0 ? "+" : "").Append(vertical.ToString("0.0")).Append('\n');
+    if (!governor.Allows(Governor.MINIMAL)) {
+        liveText.Append("Stop ").Append(canStop ? stopTime.ToString("0.0") + " s" : "-").Append('\n');
+        return liveText.Append(governor.Status).Append('\n').ToString();
+    }
+    liveText.Append("Mass ").Append(Fm(liveMass)).Append("  g ").Append((g / 9.81).ToString("0.00")).Append('\n');
+    liveText.Append("TWR").Append(g < 0.1 ? " (1g)" : "").Append('\n');
+    for (int a = 0; a < 6; a++) {
+        double twr = liveMass > 0 ? axisThrust[a] / (liveMass * gEff) : 0;
+        liveText.Append(a % 3 == 0 ? " " : "  ").Append(AxisNames[a]).Append(' ').Append(twr.ToString("0.00"));
+        if (a % 3 == 2) liveText.Append('\n');
+    }
+    liveText.Append("Stop ");
+    if (!canStop) liveText.Append("no thrust to brake");
+    else liveText.Append(stopTime.ToString("0.0")).Append(" s  ").Append(Math.Sqrt(stopDistSq).ToString("0")).Append(" m");
+    liveText.Append('\n');
+    liveText.Append("H2 ").Append(Math.Max(0, h2Rate).ToString("0.0")).Append(" L/s");
+    if (h2Rate > 0.01 && liveH2 > 0) liveText.Append(", ").Append((liveH2 / h2Rate / 60).ToString("0.0")).Append(" min left");
+    liveText.Append("\n\nback = menu\n");
+    return liveText.ToString();
+}
+
+// Whole m/s and s in the texts, TWR in hundredths: at Update10 most ticks
+// change no pixel and send no frame
+void LiveSprites(YstDisplay d) {
+    if (d.View == null) d.View = new SpriteView(d.Surface, 11);
+    var view = d.View;
+    Vector3D v = ctrl.GetShipVelocities().LinearVelocity;
+    double g = ctrl.GetNaturalGravity().Length();
+    double gEff = g < 0.1 ? EarthSurfaceGravity : g;
+    UpdateStop(v);
+
+    view.Text(0, g < 0.1 ? "Live flight (TWR at 1g)" : "Live flight", Color.White);
+    view.Text(1, "Speed " + v.Length().ToString("0") + " m/s", Color.White);
+    for (int a = 0; a < 6; a++) {
+        double twr = liveMass > 0 ? axisThrust[a] / (liveMass * gEff) : 0;
+        view.Bar(2 + a, AxisNames[a], twr / LiveTwrFull, (int)Math.Round(twr * 100), 2, "", twr >= 1 ? Color.Lime : Color.Orange);
+    }
+    view.Text(8, canStop ? "Stop " + stopTime.ToString("0") + " s " + Math.Sqrt(stopDistSq).ToString("0") + " m" : "Stop -", canStop ? Color.White : Color.Orange);
+    // One column per H2 sample (every LiveRateSeconds), not per tick
+    view.Spark(9, "H2", d.SparkAt != liveH2At ? Math.Max(0, h2Rate) : double.NaN, 0, Color.Cyan, Color.Cyan);
+    d.SparkAt = liveH2At;
+    view.Text(10, "back = menu", Color.Gray);
+    view.Draw();
+}
+
+// Stopping: each local velocity component braked by the side pushing against
+// it, all at once (gravity left out); distance is the vector sum
+void UpdateStop(Vector3D v) {
+    Vector3D lv = Vector3D.TransformNormal(v, MatrixD.Transpose(ctrl.WorldMatrix));
+    stopTime = 0; stopDistSq = 0; canStop = true;
+    Brake(lv.Y, 0, 1); // moving down: up thrusters brake, moving up: down ones
+    Brake(lv.X, 3, 2);
+    Brake(lv.Z, 5, 4); // cockpit -Z is Forward
+}
+
+void Brake(double velocity, int whenNegative, int whenPositive) {
+    double sp = Math.Abs(velocity);
+    if (sp < 0.01) return;
+    double accel = liveMass > 0 ? axisThrust[velocity > 0 ? whenPositive : whenNegative] / liveMass : 0;
+    if (accel <= 0) { canStop = false; return; }
+    stopTime = Math.Max(stopTime, sp / accel);
+    double d = sp * sp / (2 * accel);
+    stopDistSq += d * d;
+}
+
+// === Hangar (base side) ===
+void RefreshHangar() {
+    ships.Clear();
+    shipByGrid.Clear();
+    hangarDirty = true;
+    GridTerminalSystem.GetBlocksOfType(hangars, p => p.CubeGrid == Me.CubeGrid && names.Match(p).Has(hangarTag));
+    if (hangars.Count == 0) return;
+    foreach (var p in hangars) {
+        p.ContentType = ContentType.TEXT_AND_IMAGE;
+        p.Font = "Monospace";
+        p.Alignment = TextAlignment.LEFT;
+    }
+
+    GridTerminalSystem.GetBlocksOfType(docks, c => c.IsSameConstructAs(Me) && c.Status == MyShipConnectorStatus.Connected
+        && names.Match(c).Has(dockTag));
+    foreach (var c in docks) {
+        var other = c.OtherConnector;
+        if (other == null || other.IsSameConstructAs(Me)) continue;
+        bool known = false;
+        foreach (var s in ships) if (s.Link.IsSameConstructAs(other)) { known = true; break; }
+        if (!known) ships.Add(new DockedShip { Link = other, Name = other.CubeGrid.CustomName });
+    }
+    if (ships.Count == 0) return;
+
+    // One pass over the terminal system, each grid resolved to its ship once
+    GridTerminalSystem.GetBlocks(allBlocks);
+    foreach (var b in allBlocks) {
+        int i;
+        if (!shipByGrid.TryGetValue(b.CubeGrid, out i)) {
+            i = -1;
+            for (int k = 0; k < ships.Count; k++) if (ships[k].Link.IsSameConstructAs(b)) { i = k; break; }
+            shipByGrid[b.CubeGrid] = i;
+        }
+        if (i < 0) continue;
+        var ship = ships[i];
+        var t = b as IMyThrust;
+        var sc = b as IMyShipController;
+        if (t != null) ship.Thrusters.Add(t);
+        else if (sc != null) { if (ship.Ctrl == null || sc.IsMainCockpit) ship.Ctrl = sc; }
+        else if (b.HasInventory && !(b is IMyGasTank))
+            for (int n = 0; n < b.InventoryCount; n++) ship.Inventories.Add(b.GetInventory(n));
+    }
+    if (shipCursor >= ships.Count) shipCursor = 0;
+}
+
+// One ship per run: cargo mass read, full evaluation only when it moved
+void StepHangar() {
+    if (hangars.Count == 0) return;
+    if (ships.Count > 0) {
+        var s = ships[shipCursor];
+        shipCursor = (shipCursor + 1) % ships.Count;
+        double cargo = 0;
+        for (int i = 0; i < s.Inventories.Count; i++) cargo += (double)s.Inventories[i].CurrentMass;
+        if (s.CargoMass < 0 || Math.Abs(cargo - s.CargoMass) >= MassChangeKg) { EvaluateShip(s, cargo); hangarDirty = true; }
+    }
+    if (hangarDirty) ShowHangar();
+}
+
+void EvaluateShip(DockedShip s, double cargo) {
+    s.CargoMass = cargo;
+    if (s.Ctrl == null || s.Ctrl.Closed) { s.Ctrl = null; return; }
+    var sm = s.Ctrl.CalculateShipMass();
+    s.Mass = sm.PhysicalMass;
+    s.BaseMass = sm.BaseMass;
+    s.Gravity = s.Ctrl.GetNaturalGravity().Length();
+
+    MatrixD inv = MatrixD.Transpose(s.Ctrl.WorldMatrix);
+    for (int a = 0; a < 6; a++) s.Thrust[a] = 0;
+    foreach (var t in s.Thrusters) {
+        if (t.Closed || !t.IsFunctional) continue;
+        int a = Axis(Vector3D.TransformNormal(-t.WorldMatrix.Forward, inv));
+        if (a >= 0) s.Thrust[a] += t.MaxEffectiveThrust;
+    }
+    s.CapacityL = 0;
+    for (int i = 0; i < s.Inventories.Count; i++) s.CapacityL += (double)s.Inventories[i].MaxVolume * 1000;
+}
+
+// TWR at local gravity, 1g in space
+double Twr(double thrustN, double massKg, double g) {
+    if (g < 0.1) g = EarthSurfaceGravity;
+    return massKg > 0 ? thrustN / (massKg * g) : 0;
+}
+
+void ShowHangar() {
+    hangarDirty = false;
+    hangarText.Clear();
+    hangarText.Append("=== Hangar - ").Append(ships.Count).Append(ships.Count == 1 ? " ship" : " ships").Append(" ===\n");
+    if (ships.Count == 0) hangarText.Append("No ship docked to ").Append(DockTag).Append('\n');
+    foreach (var s in ships) {
+        string name = s.Name.Length > 16 ? s.Name.Substring(0, 16) : s.Name;
+        hangarText.Append('\n').Append(name.PadRight(17));
+        if (s.CargoMass < 0) { hangarText.Append("...\n"); continue; }
+        if (s.Ctrl == null) { hangarText.Append("NO COCKPIT\n"); continue; }
+        double full = s.BaseMass + s.CapacityL * LoadedDensity;
+        double now = Twr(s.Thrust[0], s.Mass, s.Gravity), loaded = Twr(s.Thrust[0], full, s.Gravity);
+        hangarText.Append(Fm(s.Mass).PadLeft(8)).Append("  ")
+            .Append(now < LaunchTwr ? "HEAVY" : loaded >= LaunchTwr ? "GO LOADED" : "GO EMPTY").Append('\n');
+        hangarText.Append("  TWR");
+        for (int a = 0; a < 6; a++) hangarText.Append(' ').Append(AxisNames[a]).Append(Twr(s.Thrust[a], s.Mass, s.Gravity).ToString("0.0"));
+        hangarText.Append("\n  Full ").Append(Fm(full)).Append(" U").Append(loaded.ToString("0.0")).Append('\n');
+    }
+    double g = ships.Count > 0 && ships[0].Ctrl != null ? ships[0].Gravity : 0;
+    hangarText.Append("\ng ").Append(g < 0.1 ? "1g (space)" : g.ToString("0.00") + " m/s^2")
+        .Append(", launch at TWR ").Append(LaunchTwr.ToString("0.0")).Append('\n');
+    string text = hangarText.ToString();
+    foreach (var p in hangars) if (!p.Closed) p.WriteText(text, false);
+}
+
 IMyShipController GetMainController() {
     for (int i = 0; i < controllers.Count; i++)
         if (controllers[i].IsMainCockpit) return controllers[i];
@@ -382,13 +865,14 @@ void Title(string name, int page, int total) {
 }
 
 string Center(string s) {
-    int width = 40; // monospace approximation
-    int pad = Math.Max(0, (width - s.Length) / 2);
+    if (metrics == null) return s;
+    float space = Math.Max(1f, metrics.Glyph(' '));
+    int pad = (int)Math.Max(0f, (metrics.Width - metrics.TextWidth(s)) / 2f / space);
     return new string(' ', pad) + s;
 }
 
 int MaxCursorMode(string m){
-    if (m=="overview") return 2;                // thrust, scenarios, ship overview
+    if (m=="overview") return 3;                // thrust, scenarios, ship overview, live
     if (m=="thrust_overview") return 1;         // details, back
     if (m=="thrust_detail") return 1;           // empty slice, back
     if (m=="thrust_empty") return 0;            // back
@@ -396,6 +880,7 @@ int MaxCursorMode(string m){
     if (m=="scenario_detail") return 1;         // next slice, back
     if (m=="scenario_slice") return 1;          // next slice, back
     if (m=="ship_overview") return 1;           // next slice, back
+    if (m=="live") return 0;                    // back
     return 0;
 }
 
@@ -414,14 +899,6 @@ double ScenarioMass(string scen, double comp, double ore, double ice) {
 }
 string CapFirst(string s){ if(string.IsNullOrEmpty(s)) return s; return char.ToUpper(s[0])+s.Substring(1); }
 
-int ComputeMaxLines(IMyTextSurface surf){
-    var size = surf.SurfaceSize; // pixels
-    // empirical line height factor for monospace
-    float linePx = 22f * surf.FontSize; // tweak if needed
-    int lines = (int)(size.Y / Math.Max(12f, linePx));
-    return Math.Max(12, lines);
-}
-
 string ThrusterTypeTag(IMyThrust t){
     string n = t.DefinitionDisplayNameText ?? t.CustomName;
     string l = (n??"").ToLower();
@@ -470,78 +947,72 @@ string ContainerTypeTag(IMyCargoContainer c){
     return n;
 }
 
-string GroupGas(List<IMyGasTank> tanks, bool hydrogen, Dictionary<string,int> outMap){
-    for (int i=0;i<tanks.Count;i++){
-        var t=tanks[i]; string n=t.DefinitionDisplayNameText ?? t.CustomName; string l=(n??"").ToLower();
-        bool isH = l.Contains("hydrogen"); bool isO = l.Contains("oxygen");
-        if (hydrogen && !isH) continue; if (!hydrogen && !isO) continue;
-        string key = n;
-        if (!outMap.ContainsKey(key)) outMap[key]=0; outMap[key]++;
+// Counts by side and thruster kind, cargo and tank kinds, then the lines
+void BuildShipTables(){
+    tableCtrl = ctrl;
+    Array.Clear(thrustTable, 0, thrustTable.Length);
+    MatrixD inv = MatrixD.Transpose(ctrl.WorldMatrix);
+    for (int i=0;i<thrusters.Count;i++){
+        var t = thrusters[i];
+        int side = Axis(Vector3D.TransformNormal(-t.WorldMatrix.Forward, inv));
+        if (side < 0) continue;
+        string ty = ThrusterTypeTag(t);
+        int kind = (ty == "Hydro" ? 2 : ty == "Atmo" ? 4 : 0) + (ThrusterSizeTag(t) == "Big" ? 1 : 0);
+        thrustTable[side * 6 + kind]++;
+    }
+    cargoKinds.Clear(); cargoCounts.Clear();
+    for (int i=0;i<cargoContainers.Count;i++) CountKind(cargoKinds, cargoCounts, ContainerTypeTag(cargoContainers[i]));
+    h2Kinds.Clear(); h2Counts.Clear(); o2Kinds.Clear(); o2Counts.Clear();
+    for (int i=0;i<gasTanks.Count;i++){
+        var t=gasTanks[i]; string n=t.DefinitionDisplayNameText ?? t.CustomName; string l=(n??"").ToLower();
+        if (l.Contains("hydrogen")) CountKind(h2Kinds, h2Counts, n);
+        else if (l.Contains("oxygen")) CountKind(o2Kinds, o2Counts, n);
+    }
+
+    // Sections: thrusters (compact table, no grid in label), cargo, H2, O2
+    shipLines.Clear(); sectionStart.Clear(); sliceIndex.Clear();
+    sectionStart.Add(0);
+    shipLines.Add("Thrusters (IS IB HS HB AS AB)");
+    shipLines.Add("Side | IS IB HS HB AS AB");
+    for (int side=0;side<6;side++){
+        string line = SideNames[side].PadRight(4) + "|";
+        for (int k=0;k<6;k++) line += " " + thrustTable[side * 6 + k].ToString().PadLeft(2);
+        shipLines.Add(line);
     }
-    if (outMap.Count==0) return "- none -";
-    var sb = new System.Text.StringBuilder();
-    foreach (var kv in outMap) { sb.Append("  ").Append(kv.Key).Append(": x").Append(kv.Value).Append("\n"); }
-    return sb.ToString().TrimEnd();
+    AddKindSection("Cargo containers:", cargoKinds, cargoCounts);
+    AddKindSection("H2 tanks:", h2Kinds, h2Counts);
+    AddKindSection("O2 tanks:", o2Kinds, o2Counts);
+    sectionStart.Add(shipLines.Count); // end of the last section
 }
 
-// Build ship overview sections; each section is a list of lines, kept intact per slice
-List<List<string>> BuildShipSections(MatrixD refMatrix){
-    var sections = new List<List<string>>();
+void CountKind(List<string> kinds, List<int> counts, string key){
+    int i = kinds.IndexOf(key);
+    if (i < 0) { kinds.Add(key); counts.Add(1); } else counts[i]++;
+}
 
-    // Thrusters by side (compact table, no grid in label)
-    var thr = new List<string>();
-    thr.Add("Thrusters (IS IB HS HB AS AB)");
-    thr.Add("Side | IS IB HS HB AS AB");
-    string[] sides = new[]{"Up","Down","Left","Right","Fwd","Back"};
-    var sideMap = new Dictionary<string, Dictionary<string,int>>();
-    for (int i=0;i<sides.Length;i++) sideMap[sides[i]] = new Dictionary<string,int>();
-    for (int i=0;i<thrusters.Count;i++){
-        var t = thrusters[i];
-        Vector3D local = Vector3D.TransformNormal(-t.WorldMatrix.Forward, MatrixD.Transpose(refMatrix));
-        string side=null;
-        if (local.Y > 0.9) side="Up"; else if (local.Y < -0.9) side="Down";
-        else if (local.Z < -0.9) side="Fwd"; else if (local.Z > 0.9) side="Back";
-        else if (local.X > 0.9) side="Right"; else if (local.X < -0.9) side="Left";
-        if (side==null) continue;
-        string ty = ThrusterTypeTag(t) + " " + ThrusterSizeTag(t); // no grid in label
-        var map = sideMap[side]; if (!map.ContainsKey(ty)) map[ty]=0; map[ty]++;
-    }
-    for (int i=0;i<sides.Length;i++){
-        var c = sideMap[sides[i]];
-        int isml = CountOrZero(c, "Ion Sml"), ibig = CountOrZero(c, "Ion Big");
-        int hsml = CountOrZero(c, "Hydro Sml"), hbig = CountOrZero(c, "Hydro Big");
-        int asml = CountOrZero(c, "Atmo Sml"), abig = CountOrZero(c, "Atmo Big");
-        string line = sides[i].PadRight(4) + "| "
-            + isml.ToString().PadLeft(2) + " " + ibig.ToString().PadLeft(2) + " "
-            + hsml.ToString().PadLeft(2) + " " + hbig.ToString().PadLeft(2) + " "
-            + asml.ToString().PadLeft(2) + " " + abig.ToString().PadLeft(2);
-        thr.Add(line);
-    }
-    sections.Add(thr);
-
-    // Cargo containers
-    var cargo = new List<string>();
-    cargo.Add("Cargo containers:");
-    var cMap = new Dictionary<string,int>();
-    for (int i=0;i<cargoContainers.Count;i++){ var c=cargoContainers[i]; string key=ContainerTypeTag(c); if(!cMap.ContainsKey(key)) cMap[key]=0; cMap[key]++; }
-    if (cMap.Count==0) cargo.Add("- none -"); else { foreach (var kv in cMap) cargo.Add("  "+kv.Key+": x"+kv.Value); }
-    sections.Add(cargo);
-
-    // H2 tanks
-    var hsec = new List<string>(); hsec.Add("H2 tanks:");
-    var hMap = new Dictionary<string,int>(); string hLines = GroupGas(gasTanks, true, hMap); foreach (var ln in hLines.Split('\n')) hsec.Add(ln);
-    sections.Add(hsec);
-    // O2 tanks
-    var osec = new List<string>(); osec.Add("O2 tanks:");
-    var oMap = new Dictionary<string,int>(); string oLines = GroupGas(gasTanks, false, oMap); foreach (var ln in oLines.Split('\n')) osec.Add(ln);
-    sections.Add(osec);
-
-    return sections;
-}
-
-// Safe lookup for compact table counts
-int CountOrZero(Dictionary<string,int> map, string key){
-    int v; return map != null && map.TryGetValue(key, out v) ? v : 0;
+void AddKindSection(string title, List<string> kinds, List<int> counts){
+    sectionStart.Add(shipLines.Count);
+    shipLines.Add(title);
+    if (kinds.Count==0) shipLines.Add("- none -");
+    for (int i=0;i<kinds.Count;i++) shipLines.Add("  "+kinds[i]+": x"+counts[i]);
+}
+
+// Pages packed by full sections, counting the blank line between them; a
+// section taller than the page still gets a page of its own
+List<int> SliceIndex(int avail){
+    List<int> pages;
+    if (sliceIndex.TryGetValue(avail, out pages)) return pages;
+    pages = new List<int> { 0 };
+    int sections = sectionStart.Count - 1, lines = 0;
+    for (int i=0;i<sections;i++){
+        int height = sectionStart[i + 1] - sectionStart[i];
+        bool first = i == pages[pages.Count - 1];
+        if (!first && lines + 1 + height > avail) { pages.Add(i); lines = height; }
+        else lines += height + (first ? 0 : 1);
+    }
+    pages.Add(sections);
+    sliceIndex[avail] = pages;
+    return pages;
 }
 
 // Sum total hydrogen capacity (L) on this grid
@@ -653,3 +1124,353 @@ string Fv(double L){if(L>1e6)return(L/1e6).ToString("0.00")+"ML";
 if(L>1e3)return(L/1e3).ToString("0.0")+"kL";return L.ToString("0")+"L";}
 string Pad(string s,int len){while(s.Length<len)s+=" ";return s;}
  
+
+// Retained sprite dashboard on a SCRIPT surface, one row per line: a text, a
+// bar (label, track, fill, value) or a sparkline (label, one column per
+// sample). A row's sprites are created on its first use, rows in order, and
+// then kept: updates edit them in place and Draw sends a frame only when a
+// text changed or a fill or column moved by a whole pixel.
+class SpriteView {
+    public const int SPARK_SAMPLES = 20;
+    const float LABEL_WIDTH = 0.3f;  // share of the width left of bars and sparklines
+    const float VALUE_WIDTH = 0.2f;  // share of the width right of bars
+    static readonly Color TRACK = new Color(40, 40, 40);
+
+    public readonly IMyTextSurface Surface;
+    readonly List<MySprite> sprites = new List<MySprite>();
+    readonly List<int> drawn = new List<int>();  // per sprite: fill / column px or value shown
+    readonly List<int> rowStart = new List<int>();
+    readonly Dictionary<int, double[]> samples = new Dictionary<int, double[]>();
+    readonly Vector2 origin;
+    readonly float width, rowHeight, textScale;
+    bool dirty = true;
+
+    public SpriteView(IMyTextSurface surface, int rows) {
+        Surface = surface;
+        surface.ScriptBackgroundColor = Color.Black;
+        Vector2 size = surface.SurfaceSize;
+        origin = (surface.TextureSize - size) / 2 + size * 0.02f;
+        width = size.X * 0.96f;
+        rowHeight = size.Y * 0.96f / rows;
+        textScale = Math.Min(1.2f, Math.Min(rowHeight / 34f, width / 500f));
+    }
+
+    public void Text(int row, string text, Color color) {
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            AddText(row, "", origin.X, TextAlignment.LEFT);
+        }
+        int i = rowStart[row];
+        SetText(i, text);
+        SetColor(i, color);
+    }
+
+    // value / 10^decimals + unit on the right; the text is only rebuilt when value changes
+    public void Bar(int row, string label, double ratio, int value, int decimals, string unit, Color color) {
+        float track = width * (1 - LABEL_WIDTH - VALUE_WIDTH);
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            float x = origin.X + width * LABEL_WIDTH;
+            AddText(row, label, origin.X, TextAlignment.LEFT);
+            AddBox(new Vector2(x, Middle(row)), new Vector2(track, rowHeight * 0.6f), TRACK);
+            AddBox(new Vector2(x, Middle(row)), new Vector2(0, rowHeight * 0.6f), color);
+            AddText(row, "", origin.X + width, TextAlignment.RIGHT);
+        }
+        int i = rowStart[row];
+
+        int px = (int)(Math.Max(0, Math.Min(1, ratio)) * track);
+        MySprite fill = sprites[i + 2];
+        if (drawn[i + 2] != px) {
+            drawn[i + 2] = px;
+            fill.Size = new Vector2(px, rowHeight * 0.6f);
+            sprites[i + 2] = fill;
+            dirty = true;
+        }
+        SetColor(i + 2, color);
+
+        if (drawn[i + 3] != value) {
+            drawn[i + 3] = value;
+            string text = decimals == 0 ? value.ToString() : (value / Math.Pow(10, decimals)).ToString("F" + decimals);
+            SetText(i + 3, text + unit);
+        }
+    }
+
+    // Appends one sample (NaN: no new sample, the row is left as it is); full
+    // height is scale, or the largest sample shown when scale is 0. Negative
+    // samples grow downwards in the second color.
+    public void Spark(int row, string label, double sample, double scale, Color up, Color down) {
+        float half = rowHeight * 0.4f;
+        if (row == rowStart.Count) {
+            rowStart.Add(sprites.Count);
+            AddText(row, label, origin.X, TextAlignment.LEFT);
+            float step = width * (1 - LABEL_WIDTH) / SPARK_SAMPLES;
+            for (int k = 0; k < SPARK_SAMPLES; k++) {
+                float x = origin.X + width * LABEL_WIDTH + k * step;
+                AddBox(new Vector2(x, Middle(row)), new Vector2(step * 0.8f, 0), up);
+            }
+            samples[row] = new double[SPARK_SAMPLES];
+        }
+        if (double.IsNaN(sample)) return;
+        int first = rowStart[row] + 1;
+
+        double[] ring = samples[row];
+        Array.Copy(ring, 1, ring, 0, SPARK_SAMPLES - 1);
+        ring[SPARK_SAMPLES - 1] = sample;
+        double peak = scale;
+        if (peak <= 0) {
+            for (int k = 0; k < SPARK_SAMPLES; k++) peak = Math.Max(peak, Math.Abs(ring[k]));
+        }
+
+        for (int k = 0; k < SPARK_SAMPLES; k++) {
+            int px = peak > 0 ? (int)(Math.Max(-1, Math.Min(1, ring[k] / peak)) * half) : 0;
+            int i = first + k;
+            if (drawn[i] == px) continue;
+
+            drawn[i] = px;
+            MySprite column = sprites[i];
+            column.Size = new Vector2(column.Size.Value.X, Math.Abs(px));
+            column.Position = new Vector2(column.Position.Value.X, Middle(row) - px / 2f);
+            column.Color = px >= 0 ? up : down;
+            sprites[i] = column;
+            dirty = true;
+        }
+    }
+
+    // Sends the retained sprites if anything moved; false when nothing was sent
+    public bool Draw() {
+        if (Surface.ContentType != ContentType.SCRIPT) {  // back from text mode
+            Surface.ContentType = ContentType.SCRIPT;
+            Surface.Script = "";
+            dirty = true;
+        }
+        if (!dirty) return false;
+
+        dirty = false;
+        using (MySpriteDrawFrame frame = Surface.DrawFrame()) {
+            for (int i = 0; i < sprites.Count; i++) frame.Add(sprites[i]);
+        }
+        return true;
+    }
+
+    float Middle(int row) { return origin.Y + (row + 0.5f) * rowHeight; }
+
+    void AddText(int row, string text, float x, TextAlignment alignment) {
+        float y = Middle(row) - 15f * textScale;  // text is positioned by its top
+        sprites.Add(new MySprite(SpriteType.TEXT, text, new Vector2(x, y), null, Color.White, "Debug", alignment, textScale));
+        drawn.Add(int.MinValue);
+        dirty = true;
+    }
+
+    void AddBox(Vector2 position, Vector2 size, Color color) {
+        sprites.Add(new MySprite(SpriteType.TEXTURE, "SquareSimple", position, size, color, null, TextAlignment.LEFT));
+        drawn.Add(int.MinValue);
+        dirty = true;
+    }
+
+    void SetText(int index, string text) {
+        MySprite sprite = sprites[index];
+        if (sprite.Data == text) return;
+        sprite.Data = text;
+        sprites[index] = sprite;
+        dirty = true;
+    }
+
+    void SetColor(int index, Color color) {
+        MySprite sprite = sprites[index];
+        if (sprite.Color.Value == color) return;
+        sprite.Color = color;
+        sprites[index] = sprite;
+        dirty = true;
+    }
+}
+
+// Sheds features when this PB gets expensive for the server (dedicated
+// servers throttle or stop PBs on their average run time). Every run is
+// sampled (Runtime.LastRunTimeMs, instructions); when the window average goes
+// over budget the level rises one step, under half the budget it drops one
+// step, at most one change per window. Features shed in this order:
+// 1 slower refresh, 2 per-tag breakdowns, 3 rates, 4 everything but a minimal frame.
+class Governor {
+    public const int SLOWER = 1, NO_TAGS = 2, NO_RATES = 3, MINIMAL = 4;
+    static readonly string[] LevelNames = { "full", "slower refresh", "no breakdown", "no rates", "minimal frame" };
+    readonly double[] ms;
+    readonly int[] instructions;
+    readonly double budgetMs;
+    readonly int budgetInstructions;
+    int head, count, sinceChange;
+    double sumMs;
+    long sumInstructions;
+    public int Level;
+    public string Status = "";
+
+    public Governor(int window, double budgetMs, int budgetInstructions) {
+        ms = new double[window];
+        instructions = new int[window];
+        this.budgetMs = budgetMs;
+        this.budgetInstructions = budgetInstructions;
+    }
+
+    public bool Allows(int feature) { return Level < feature; }
+    public double AverageMs { get { return count > 0 ? sumMs / count : 0; } }
+    public double AverageInstructions { get { return count > 0 ? (double)sumInstructions / count : 0; } }
+
+    // lastRunMs: the previous run (Runtime.LastRunTimeMs); used: this run's instructions
+    public void Sample(double lastRunMs, int used) {
+        if (count == ms.Length) { sumMs -= ms[head]; sumInstructions -= instructions[head]; }
+        else count++;
+        ms[head] = lastRunMs;
+        instructions[head] = used;
+        sumMs += lastRunMs;
+        sumInstructions += used;
+        head = (head + 1) % ms.Length;
+        if (++sinceChange < ms.Length || count < ms.Length) return;
+
+        double load = Math.Max(AverageMs / budgetMs, AverageInstructions / budgetInstructions);
+        int previous = Level;
+        if (load > 1 && Level < MINIMAL) Level++;
+        else if (load < 0.5 && Level > 0) Level--;
+        if (Level == previous) return;
+        sinceChange = 0;
+        Status = Level == 0 ? "" : "Governor: " + LevelNames[Level] + " (" + AverageMs.ToString("0.00") + " ms/run)";
+    }
+}
+
+// Finds every keyword and tag of the script in a block name in one pass
+// (Aho-Corasick automaton, case-insensitive), plus the path of every [tag]
+// ("Miner1:Cargo", ":"-separated, each path once).
+// Results are cached per block until its name changes.
+// Keyword("Locked") matches anywhere; Tag("[YST") matches "[YST]" and
+// "[YST:n]" (index n) but not "[YST LOG]".
+class NameMatcher {
+    readonly List<Dictionary<char, int>> next = new List<Dictionary<char, int>> { new Dictionary<char, int>() };
+    readonly List<int> fail = new List<int> { 0 }, ends = new List<int> { 0 };
+    int count, tagMask, sweep;
+    readonly Dictionary<long, NameMatch> cache = new Dictionary<long, NameMatch>();
+
+    public int Keyword(string text) { return Add(text, false); }
+    public int Tag(string prefix) { return Add(prefix, true); }
+
+    int Add(string text, bool tag) {
+        int id = count++;
+        if (id == 32) throw new Exception("NameMatcher: 32 patterns max");
+        int s = 0;
+        foreach (char raw in text) {
+            char c = char.ToUpperInvariant(raw);
+            int t;
+            if (!next[s].TryGetValue(c, out t)) {
+                t = next.Count;
+                next.Add(new Dictionary<char, int>());
+                fail.Add(0);
+                ends.Add(0);
+                next[s][c] = t;
+            }
+            s = t;
+        }
+        ends[s] |= 1 << id;
+        if (tag) tagMask |= 1 << id;
+        return id;
+    }
+
+    // Failure links, breadth first; call once after the last Keyword/Tag
+    public void Build() {
+        var queue = new Queue<int>();
+        foreach (var t in next[0].Values) queue.Enqueue(t);
+        while (queue.Count > 0) {
+            int s = queue.Dequeue();
+            foreach (var kv in next[s]) {
+                int f = fail[s], t;
+                while (f > 0 && !next[f].ContainsKey(kv.Key)) f = fail[f];
+                fail[kv.Value] = next[f].TryGetValue(kv.Key, out t) ? t : 0;
+                ends[kv.Value] |= ends[fail[kv.Value]];
+                queue.Enqueue(kv.Value);
+            }
+        }
+    }
+
+    public NameMatch Match(IMyTerminalBlock block) {
+        NameMatch m;
+        string name = block.CustomName;
+        if (!cache.TryGetValue(block.EntityId, out m)) cache[block.EntityId] = m = new NameMatch(count);
+        else if (m.Name == name) { m.Sweep = sweep; return m; }
+        Scan(name, m);
+        m.Sweep = sweep;
+        return m;
+    }
+
+    public NameMatch Match(string name) {
+        var m = new NameMatch(count);
+        Scan(name, m);
+        return m;
+    }
+
+    // Forgets the blocks not matched since the previous call (call after a rescan)
+    public void Sweep() {
+        var gone = new List<long>();
+        foreach (var kv in cache) if (kv.Value.Sweep != sweep) gone.Add(kv.Key);
+        foreach (var id in gone) cache.Remove(id);
+        sweep++;
+    }
+
+    void Scan(string name, NameMatch m) {
+        m.Name = name;
+        m.Hits = 0;
+        m.Tags.Clear();
+        for (int i = 0; i < m.Index.Length; i++) m.Index[i] = -1;
+        if (name == null) return;
+
+        int s = 0, open = -1;
+        for (int i = 0; i < name.Length; i++) {
+            char c = char.ToUpperInvariant(name[i]);
+            if (c == '[') open = i;
+            else if (c == ']' && open >= 0) {
+                AddTag(name, open + 1, i, m);
+                open = -1;
+            }
+
+            int t;
+            while (s > 0 && !next[s].ContainsKey(c)) s = fail[s];
+            s = next[s].TryGetValue(c, out t) ? t : 0;
+            for (int hits = ends[s]; hits != 0; hits &= hits - 1) {
+                int id = 0;
+                while ((hits & (1 << id)) == 0) id++;
+                if ((tagMask & (1 << id)) == 0) m.Hits |= 1 << id;
+                else TagEnd(name, i + 1, id, m);
+            }
+        }
+    }
+
+    // Segments trimmed, a last numeric one is an index: "[Hangar:2]" -> "Hangar"
+    static void AddTag(string name, int start, int end, NameMatch m) {
+        string[] parts = name.Substring(start, end - start).Split(':');
+        int count = parts.Length, index;
+        if (count > 1 && int.TryParse(parts[count - 1], out index)) count--;
+        for (int i = 0; i < count; i++) {
+            parts[i] = parts[i].Trim();
+            if (parts[i].Length == 0) return;
+        }
+        string tag = string.Join(":", parts, 0, count);
+        foreach (var t in m.Tags) if (string.Equals(t, tag, StringComparison.OrdinalIgnoreCase)) return;
+        m.Tags.Add(tag);
+    }
+
+    // After a tag prefix: "]" (no index) or ":digits]"
+    static void TagEnd(string name, int at, int id, NameMatch m) {
+        if (at >= name.Length) return;
+        if (name[at] == ']') { m.Hits |= 1 << id; return; }
+        if (name[at] != ':') return;
+        int value = 0, i = at + 1;
+        while (i < name.Length && char.IsDigit(name[i]) && value < 100000) value = value * 10 + name[i++] - '0';
+        if (i == at + 1 || i >= name.Length || name[i] != ']') return;
+        if ((m.Hits & (1 << id)) == 0) m.Index[id] = value;
+        m.Hits |= 1 << id;
+    }
+}
+
+class NameMatch {
+    public string Name;
+    public int Hits, Sweep;
+    public readonly int[] Index;                            // per Tag(): ":n" index, -1 = none
+    public readonly List<string> Tags = new List<string>(); // every [tag] path, e.g. "Hangar" for [Hangar:2], "Miner1:Cargo"
+    public NameMatch(int patterns) { Index = new int[patterns]; }
+    public bool Has(int id) { return (Hits & (1 << id)) != 0; }
+}
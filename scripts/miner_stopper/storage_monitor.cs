@@ -1,13 +1,15 @@
-// === QG Storage Monitor v7.1 ===
+// === QG Storage Monitor v9.2 ===
 // Stops or resumes PAM miners depending on [QG] storage level
-// Retries up to 3 times if miners not yet visible after connector lock
+// and on per-item rules read from this PB's Custom Data
+// Watches [QG] connectors and sends the command as soon as a docked miner's PB is visible
+// Miner PBs are found by name or tag once, then reused by handle
+// Events go to a fixed-size log shown on [LOG] panels
 
 // ---------- CONFIG ----------
 const string TAG_QG = "[QG]";
 const double THRESHOLD_PERCENT = 75.0;
 
-const int RETRY_COUNT = 3;
-const int RETRY_DELAY_TICKS = 60; // ~1s @60TPS
+const double DOCK_TIMEOUT_SECONDS = 60; // stop waiting for a PB on a docked grid after this
 
 string[] EXCLUDED_KEYWORDS = { "Special", "Locked", "Seat", "Control Station" };
 
@@ -15,120 +17,787 @@ string[] MINER_BLOCKS = {
     "[HMiner-1] Programmable Block",
     "[HMiner-2] Programmable Block"
 };
+const string MINER_TAG = "[HMiner"; // docked PBs whose name contains this are miners too ("" = names only)
+
+const int INDEX_PER_RUN = 8; // inventories re-read per Update100 tick
+
+const string LOG_TAG = "[LOG]"; // text panels showing the event log ("log" argument copies it to their Custom Data)
+const int LOG_CAPACITY = 128;   // events kept, oldest overwritten
+
+// Custom Data rules, one per line ("#" starts a comment):
+//   STOP Ore/Stone > 500kL        stop when stone volume exceeds 500 kL
+//   RUN Ore/Ice < 20k             keep running while ice is under 20k kg
+//   [HMiner-2] STOP Ore > 1M      only for miners whose name contains [HMiner-2]
+// Item is Type/Subtype or a whole Type (category). Units: none = item amount,
+// L = volume in liters; k / M multiply by 1e3 / 1e6.
+// A miner stops if the volume threshold or any STOP rule matches, unless a
+// RUN rule matches - RUN rules always win.
 // --------------------------------
 
-// Retry state
-int attemptsDone = 0;
-int delayTicks = 0;
-bool retryPending = false;
+// Compiled rule table (flat arrays, built once per Custom Data change)
+string compiledRules = null;
+int ruleCount = 0;
+string[] ruleSelector = new string[0]; // null = all miners
+bool[] ruleStop = new bool[0];
+int[] ruleItem = new int[0];       // index into ruleItems
+bool[] ruleGreater = new bool[0];
+double[] ruleThreshold = new double[0];
+bool[] ruleVolume = new bool[0];
+List<string> ruleItems = new List<string>(); // "Ore/Stone" or "Ore"
+double[] itemValues = new double[0];
+double[] volumeValues = new double[0];
+Dictionary<MyItemType, int[]> ruleMatches = new Dictionary<MyItemType, int[]>(); // type -> rule items
+
+// Miner PB handles, found once and then revalidated cheaply
+class Miner
+{
+    public string Name;
+    public IMyProgrammableBlock Pb;  // null until seen
+    public int[] Rules = new int[0]; // rules that apply to this miner
+}
+List<Miner> miners = new List<Miner>();
+Dictionary<long, Miner> minerById = new Dictionary<long, Miner>();
+List<IMyProgrammableBlock> pbBuffer = new List<IMyProgrammableBlock>();
+
+// Event log: ring buffer of typed events, formatted only when displayed
+const int EV_FILL = 0, EV_NO_CONTAINERS = 1, EV_SENT_STOP = 2, EV_SENT_CONT = 3, EV_TRYRUN_FAILED = 4,
+    EV_NOT_DOCKED = 5, EV_DOCKED = 6, EV_NO_MINER_PB = 7, EV_MINER_FOUND = 8;
+string[] EVENT_TEXT = {
+    "QG storage %", "No valid containers", "Sent STOP to", "Sent CONT to", "ERROR: TryRun failed on",
+    "Not docked (sent on connector lock):", "Docked:", "No miner PB on ship docked at", "Miner found by tag:"
+};
+long[] logTicks = new long[LOG_CAPACITY];
+int[] logCode = new int[LOG_CAPACITY];
+object[] logSubject = new object[LOG_CAPACITY]; // Miner or block, named at display time
+double[] logValue = new double[LOG_CAPACITY];
+int logHead = 0, logCount = 0, logVersion = 0, shownVersion = -1;
+List<IMyTerminalBlock> logBlocks = new List<IMyTerminalBlock>();
+StringBuilder logText = new StringBuilder();
+
+// Incremental item index over the [QG] containers
+class InventorySlot
+{
+    public IMyTerminalBlock Block;
+    public IMyInventory Inventory;
+    public Dictionary<MyItemType, double> Last = new Dictionary<MyItemType, double>();
+    public bool Read; // Last holds this inventory (false until the index reaches it)
+}
+List<InventorySlot> indexSlots = new List<InventorySlot>();
+Dictionary<long, InventorySlot> slotById = new Dictionary<long, InventorySlot>();
+Dictionary<MyItemType, double> itemTotals = new Dictionary<MyItemType, double>();
+Dictionary<MyItemType, double> litersPerUnit = new Dictionary<MyItemType, double>();
+List<MyInventoryItem> itemBuffer = new List<MyInventoryItem>();
+List<IMyCargoContainer> containers = new List<IMyCargoContainer>();
+int indexCursor = 0;
+int unreadSlots = 0; // slots not indexed yet: item rules wait until this drops to 0
+
+// Connector watch state by connector EntityId (handles cached, Status polled
+// at low frequency): a replaced connector starts fresh, a kept one keeps its state
+class DockWatch
+{
+    public MyShipConnectorStatus Status = MyShipConnectorStatus.Unconnected; // ships already docked get served once
+    public bool Pending;
+    public double PendingSince;
+}
+List<IMyShipConnector> connectors = new List<IMyShipConnector>();
+Dictionary<long, DockWatch> dockWatch = new Dictionary<long, DockWatch>();
+Dictionary<long, DockWatch> dockWatchNext = new Dictionary<long, DockWatch>();
+double clock = 0;
+
+// Tags and excluded keywords, all found in one pass per name (cached per block)
+NameMatcher names = new NameMatcher();
+int qgId, minerId = -1, logId, excludedMask;
+
+public Program()
+{
+    Runtime.UpdateFrequency = UpdateFrequency.Update100;
+    qgId = names.Keyword(TAG_QG);
+    logId = names.Keyword(LOG_TAG);
+    if (MINER_TAG.Length > 0) minerId = names.Keyword(MINER_TAG);
+    foreach (var keyword in EXCLUDED_KEYWORDS) excludedMask |= 1 << names.Keyword(keyword);
+    names.Build();
+    foreach (var name in MINER_BLOCKS) AddMiner(name);
+    CollectContainers();
+    CollectConnectors();
+    CollectLogBlocks();
+    CompileRules();
+}
 
 void Main(string argument, UpdateType updateSource)
 {
-    string now = DateTime.Now.ToString("HH:mm:ss");
+    clock += Runtime.TimeSinceLastRun.TotalSeconds;
+    // No listener of ours: an IGC run (another script's callback, e.g. under
+    // the host) is not a trigger
+    if ((updateSource & UpdateType.IGC) != 0) return;
 
-    // Tick-driven retry loop
-    if ((updateSource & UpdateType.Update1) != 0 && retryPending)
+    // Background ticks: keep the item index warm and watch docking events
+    const UpdateType ticks = UpdateType.Update10 | UpdateType.Update100;
+    if ((updateSource & ticks) != 0)
     {
-        if (--delayTicks <= 0)
-        {
-            bool done = RunOnce(now);
-            if (!done && attemptsDone < RETRY_COUNT)
-            {
-                attemptsDone++;
-                delayTicks = RETRY_DELAY_TICKS;
-                Echo($"[{now}] Retry {attemptsDone}/{RETRY_COUNT} in {(RETRY_DELAY_TICKS/60.0):0.0}s");
-            }
-            else
-            {
-                if (!done) Echo($"[{now}] Gave up after {attemptsDone} retries.");
-                StopRetry();
-            }
-        }
-        return;
+        if ((updateSource & UpdateType.Update100) != 0) { StepItemIndex(); ShowLog(); }
+        WatchConnectors();
+        if ((updateSource & ~ticks) == 0) return;
     }
 
-    // Initial trigger
-    attemptsDone = 0;
-    bool ok = RunOnce(now);
-    if (!ok)
+    CollectLogBlocks();
+    if (argument.Trim().Equals("log", StringComparison.OrdinalIgnoreCase))
     {
-        retryPending = true;
-        attemptsDone = 1;
-        delayTicks = RETRY_DELAY_TICKS;
-        Runtime.UpdateFrequency = UpdateFrequency.Update1;
-        Echo($"[{now}] Retry {attemptsDone}/{RETRY_COUNT} in {(RETRY_DELAY_TICKS/60.0):0.0}s");
+        ExportLog();
+        return;
     }
+
+    // Trigger (timer, button, connector action): decide and send to every visible miner.
+    // Miners that are not docked yet get their command when their connector locks.
+    CollectContainers();
+    CollectConnectors();
+    names.Sweep();
+    RunOnce();
+    ShowLog();
+    Echo(FormatLog(10));
 }
 
-bool RunOnce(string now)
+void RunOnce()
 {
-    // 1) Collect QG containers
-    var containers = new List<IMyCargoContainer>();
-    GridTerminalSystem.GetBlocksOfType(containers, c =>
-        c.CustomName.IndexOf(TAG_QG, StringComparison.OrdinalIgnoreCase) >= 0 &&
-        !ContainsAny(c.CustomName, EXCLUDED_KEYWORDS)
-    );
+    if (Me.CustomData != compiledRules) CompileRules();
+
+    double percentUsed;
+    if (!TryGetFill(out percentUsed))
+    {
+        Log(EV_NO_CONTAINERS);
+        return;
+    }
+    Log(EV_FILL, null, percentUsed);
 
+    // STOP si >= seuil ou si une regle STOP matche (sauf regle RUN), sinon CONT
+    EvaluateItems();
+    foreach (var m in miners)
+    {
+        var minerPB = ResolveMiner(m);
+        if (minerPB == null)
+        {
+            Log(EV_NOT_DOCKED, m);
+            continue;
+        }
+        SendCommand(m, minerPB, percentUsed >= THRESHOLD_PERCENT);
+    }
+}
+
+bool TryGetFill(out double percentUsed)
+{
     double totalCap = 0, totalUsed = 0;
     foreach (var c in containers)
     {
+        if (c.Closed) continue;
         var inv = c.GetInventory();
         totalCap  += (double)inv.MaxVolume;
         totalUsed += (double)inv.CurrentVolume;
     }
+    percentUsed = totalCap > 0 ? (totalUsed / totalCap) * 100.0 : 0;
+    return totalCap > 0;
+}
 
-    if (totalCap <= 0)
+void SendCommand(Miner miner, IMyProgrammableBlock minerPB, bool overThreshold)
+{
+    string cmd = DecideCommand(miner, overThreshold);
+    if (!minerPB.TryRun(cmd)) Log(EV_TRYRUN_FAILED, miner);
+    else Log(cmd == "STOP" ? EV_SENT_STOP : EV_SENT_CONT, miner);
+}
+
+// ---------- Miners ----------
+
+Miner AddMiner(string name)
+{
+    var m = new Miner { Name = name };
+    AssignRules(m);
+    miners.Add(m);
+    return m;
+}
+
+void Track(Miner m, IMyProgrammableBlock pb)
+{
+    if (m.Pb != null) minerById.Remove(m.Pb.EntityId);
+    m.Pb = pb;
+    minerById[pb.EntityId] = m;
+}
+
+// Cached handle first. A live handle that is not reachable means the miner is
+// away, so the name search only runs when there is no handle at all.
+IMyProgrammableBlock ResolveMiner(Miner m)
+{
+    if (m.Pb != null && !m.Pb.Closed) return IsReachable(m.Pb) ? m.Pb : null;
+
+    var pb = GridTerminalSystem.GetBlockWithName(m.Name) as IMyProgrammableBlock;
+    if (pb == null) return null;
+    Track(m, pb);
+    return IsReachable(pb) ? pb : null;
+}
+
+// Working and on this base or on a ship locked to one of our [QG] connectors
+bool IsReachable(IMyProgrammableBlock pb)
+{
+    if (!pb.IsFunctional) return false;
+    if (pb.IsSameConstructAs(Me)) return true;
+    foreach (var c in connectors)
     {
-        Echo($"[{now}] No valid {TAG_QG} containers found.");
-        return true; // rien à réessayer
+        if (c.Closed || c.Status != MyShipConnectorStatus.Connected) continue;
+        var other = c.OtherConnector;
+        if (other != null && pb.IsSameConstructAs(other)) return true;
     }
+    return false;
+}
 
-    double percentUsed = (totalUsed / totalCap) * 100.0;
-    Echo($"[{now}] QG Storage: {percentUsed:0.0}% full");
+// Miss on a docked ship: one pass over its PBs, matched by configured name or by tag
+void DiscoverMiners(IMyShipConnector dockedAt)
+{
+    GridTerminalSystem.GetBlocksOfType(pbBuffer, pb => pb.IsSameConstructAs(dockedAt));
+    foreach (var pb in pbBuffer)
+    {
+        if (minerById.ContainsKey(pb.EntityId)) continue;
 
-    // 2) STOP si >= seuil, sinon CONT
-    if (percentUsed >= THRESHOLD_PERCENT)
-        return ExecuteCommand("STOP", now);
-    else
-        return ExecuteCommand("CONT", now);
+        Miner m = null;
+        foreach (var known in miners)
+            if (known.Name == pb.CustomName) { m = known; break; }
+        if (m == null)
+        {
+            if (minerId < 0 || !names.Match(pb).Has(minerId)) continue;
+            m = AddMiner(pb.CustomName);
+            Log(EV_MINER_FOUND, m);
+        }
+        Track(m, pb);
+    }
 }
 
-bool ExecuteCommand(string cmd, string now)
+// ---------- Connectors ----------
+
+void CollectConnectors()
 {
-    Echo($"[{now}] Sending {cmd} command to miners...");
-    bool missing = false;
+    GridTerminalSystem.GetBlocksOfType(connectors, c =>
+        c.IsSameConstructAs(Me) && names.Match(c).Has(qgId));
 
-    foreach (var minerName in MINER_BLOCKS)
+    dockWatchNext.Clear();
+    foreach (var c in connectors)
     {
-        var minerPB = GridTerminalSystem.GetBlockWithName(minerName) as IMyProgrammableBlock;
-        if (minerPB == null)
+        DockWatch w;
+        if (!dockWatch.TryGetValue(c.EntityId, out w)) w = new DockWatch();
+        dockWatchNext[c.EntityId] = w;
+    }
+    var swap = dockWatch;
+    dockWatch = dockWatchNext;
+    dockWatchNext = swap;
+}
+
+// A lock arms the connector; it stays armed until the docked miner's PB can be
+// resolved (however long the merge takes) or the ship leaves. While anything is
+// approaching or armed the watch runs at Update10, otherwise at Update100.
+void WatchConnectors()
+{
+    bool armed = false;
+    for (int i = 0; i < connectors.Count; i++)
+    {
+        var c = connectors[i];
+        DockWatch w;
+        if (c.Closed || !dockWatch.TryGetValue(c.EntityId, out w)) continue;
+        var status = c.Status;
+
+        if (status == MyShipConnectorStatus.Connected && w.Status != MyShipConnectorStatus.Connected)
+        {
+            w.Pending = true;
+            w.PendingSince = clock;
+        }
+        else if (status != MyShipConnectorStatus.Connected)
+        {
+            w.Pending = false;
+        }
+        w.Status = status;
+
+        // Retried every tick while armed: under the host the block list used by
+        // DiscoverMiners can be a few seconds old, the next scan brings the PB
+        if (w.Pending)
+        {
+            if (TryDispatchDocked(c)) w.Pending = false;
+            else if (clock - w.PendingSince > DOCK_TIMEOUT_SECONDS)
+            {
+                Log(EV_NO_MINER_PB, c);
+                w.Pending = false;
+            }
+        }
+        armed |= w.Pending || status == MyShipConnectorStatus.Connectable;
+    }
+
+    Runtime.UpdateFrequency = armed
+        ? UpdateFrequency.Update10 | UpdateFrequency.Update100
+        : UpdateFrequency.Update100;
+}
+
+bool TryDispatchDocked(IMyShipConnector connector)
+{
+    var other = connector.OtherConnector;
+    if (other == null) return false;
+
+    if (!SendToDocked(connector, other))
+    {
+        // Unknown or rebuilt ship: look it up once, then it is served from the cache
+        DiscoverMiners(other);
+        return SendToDocked(connector, other);
+    }
+    return true;
+}
+
+bool SendToDocked(IMyShipConnector connector, IMyShipConnector other)
+{
+    bool sent = false;
+    double percentUsed = 0;
+    foreach (var m in miners)
+    {
+        var minerPB = m.Pb;
+        if (minerPB == null || minerPB.Closed || !minerPB.IsFunctional || !minerPB.IsSameConstructAs(other)) continue;
+
+        if (!sent)
+        {
+            if (Me.CustomData != compiledRules) CompileRules();
+            TryGetFill(out percentUsed);
+            EvaluateItems();
+        }
+        Log(EV_DOCKED, m);
+        SendCommand(m, minerPB, percentUsed >= THRESHOLD_PERCENT);
+        sent = true;
+    }
+    return sent;
+}
+
+// ---------- Event log ----------
+
+// Hot path: a few array stores, no string work
+void Log(int code, object subject = null, double value = double.NaN)
+{
+    logTicks[logHead] = DateTime.Now.Ticks;
+    logCode[logHead] = code;
+    logSubject[logHead] = subject;
+    logValue[logHead] = value;
+    logHead = (logHead + 1) % LOG_CAPACITY;
+    if (logCount < LOG_CAPACITY) logCount++;
+    logVersion++;
+}
+
+// Newest first, so a panel that is too short still shows the latest events
+string FormatLog(int maxLines)
+{
+    logText.Clear();
+    int lines = Math.Min(maxLines, logCount);
+    for (int k = 1; k <= lines; k++)
+    {
+        int i = (logHead - k + LOG_CAPACITY) % LOG_CAPACITY;
+        logText.Append(new DateTime(logTicks[i]).ToString("HH:mm:ss")).Append(' ').Append(EVENT_TEXT[logCode[i]]);
+        var subject = logSubject[i];
+        if (subject is Miner) logText.Append(' ').Append(((Miner)subject).Name);
+        else if (subject is IMyTerminalBlock) logText.Append(' ').Append(((IMyTerminalBlock)subject).CustomName);
+        if (!double.IsNaN(logValue[i])) logText.Append(' ').Append(logValue[i].ToString("0.0"));
+        logText.Append('\n');
+    }
+    return logText.ToString();
+}
+
+void CollectLogBlocks()
+{
+    GridTerminalSystem.GetBlocksOfType(logBlocks, b =>
+        b.IsSameConstructAs(Me) && names.Match(b).Has(logId));
+}
+
+void ShowLog()
+{
+    if (logVersion == shownVersion) return;
+    shownVersion = logVersion;
+    string text = null;
+    foreach (var b in logBlocks)
+    {
+        var panel = b as IMyTextPanel;
+        if (panel == null || panel.Closed) continue;
+        if (text == null) text = FormatLog(LOG_CAPACITY);
+        panel.ContentType = ContentType.TEXT_AND_IMAGE;
+        panel.WriteText(text);
+    }
+}
+
+void ExportLog()
+{
+    string text = FormatLog(LOG_CAPACITY);
+    foreach (var b in logBlocks)
+        if (!b.Closed) b.CustomData = text;
+    Echo($"Log exported ({logCount} events) to {logBlocks.Count} {LOG_TAG} block(s)");
+}
+
+// ---------- Rules ----------
+
+void CompileRules()
+{
+    compiledRules = Me.CustomData;
+    var selector = new List<string>(); var stop = new List<bool>(); var item = new List<int>();
+    var greater = new List<bool>(); var threshold = new List<double>(); var volume = new List<bool>();
+    ruleItems.Clear();
+
+    foreach (var raw in compiledRules.Split('\n'))
+    {
+        string line = raw.Trim();
+        int hash = line.IndexOf('#');
+        if (hash >= 0) line = line.Substring(0, hash).Trim();
+        if (line.Length == 0) continue;
+
+        string sel = null;
+        if (line[0] == '[')
+        {
+            int close = line.IndexOf(']');
+            if (close < 0) { Echo($"Rule ignored: {line}"); continue; }
+            sel = line.Substring(0, close + 1);
+            if (!AnyMinerMatches(sel)) Echo($"No miner matches {sel} yet");
+            line = line.Substring(close + 1).Trim();
+        }
+
+        var parts = line.Split(new[] { ' ' }, StringSplitOptions.RemoveEmptyEntries);
+        bool isStop = parts.Length == 4 && parts[0].Equals("STOP", StringComparison.OrdinalIgnoreCase);
+        bool isRun = parts.Length == 4 && parts[0].Equals("RUN", StringComparison.OrdinalIgnoreCase);
+        double value; bool isVolume;
+        if ((!isStop && !isRun) || (parts[2] != ">" && parts[2] != "<") || !TryParseQuantity(parts[3], out value, out isVolume))
         {
-            Echo($"[{now}] Not found: {minerName}");
-            missing = true; // on retentera si au moins un est manquant
+            Echo($"Rule ignored: {raw.Trim()}");
             continue;
         }
 
-        bool ok = minerPB.TryRun(cmd);
-        Echo(ok
-            ? $"[{now}] Sent {cmd} to {minerName}"
-            : $"[{now}] ERROR: TryRun failed on {minerName}");
+        int itemIndex = ruleItems.IndexOf(parts[1]);
+        if (itemIndex < 0) { itemIndex = ruleItems.Count; ruleItems.Add(parts[1]); }
+
+        selector.Add(sel); stop.Add(isStop); item.Add(itemIndex);
+        greater.Add(parts[2] == ">"); threshold.Add(value); volume.Add(isVolume);
     }
 
-    return !missing; // retry uniquement si un PB était introuvable
+    ruleCount = selector.Count;
+    ruleSelector = selector.ToArray(); ruleStop = stop.ToArray(); ruleItem = item.ToArray();
+    ruleGreater = greater.ToArray(); ruleThreshold = threshold.ToArray(); ruleVolume = volume.ToArray();
+    itemValues = new double[ruleItems.Count];
+    volumeValues = new double[ruleItems.Count];
+    ruleMatches.Clear();
+    foreach (var m in miners) AssignRules(m);
 }
 
-bool ContainsAny(string name, string[] keywords)
+// Per-miner rule list, rebuilt when the rules change or a miner is discovered
+void AssignRules(Miner m)
 {
-    for (int i = 0; i < keywords.Length; i++)
-        if (name.IndexOf(keywords[i], StringComparison.OrdinalIgnoreCase) >= 0)
+    var rules = new List<int>();
+    for (int r = 0; r < ruleCount; r++)
+        if (ruleSelector[r] == null || m.Name.IndexOf(ruleSelector[r], StringComparison.OrdinalIgnoreCase) >= 0)
+            rules.Add(r);
+    m.Rules = rules.ToArray();
+}
+
+bool AnyMinerMatches(string selector)
+{
+    foreach (var m in miners)
+        if (m.Name.IndexOf(selector, StringComparison.OrdinalIgnoreCase) >= 0)
             return true;
     return false;
 }
 
-void StopRetry()
+// "500kL" -> 500000 (volume), "20k" -> 20000 (amount)
+bool TryParseQuantity(string text, out double value, out bool isVolume)
+{
+    isVolume = text.EndsWith("L", StringComparison.OrdinalIgnoreCase);
+    if (isVolume) text = text.Substring(0, text.Length - 1);
+    double mult = 1;
+    if (text.EndsWith("k")) { mult = 1e3; text = text.Substring(0, text.Length - 1); }
+    else if (text.EndsWith("M")) { mult = 1e6; text = text.Substring(0, text.Length - 1); }
+    bool ok = double.TryParse(text, System.Globalization.NumberStyles.Float,
+        System.Globalization.CultureInfo.InvariantCulture, out value);
+    value *= mult;
+    return ok;
+}
+
+// One pass over the (small) set of distinct item types in the index
+void EvaluateItems()
+{
+    for (int i = 0; i < itemValues.Length; i++) { itemValues[i] = 0; volumeValues[i] = 0; }
+    if (ruleItems.Count == 0) return;
+
+    foreach (var kv in itemTotals)
+    {
+        if (kv.Value <= 0) continue;
+        int[] matches = RuleItemsFor(kv.Key);
+        for (int j = 0; j < matches.Length; j++)
+        {
+            itemValues[matches[j]] += kv.Value;
+            volumeValues[matches[j]] += kv.Value * LitersPerUnit(kv.Key);
+        }
+    }
+}
+
+// Matched once per item type and rule set, then served from the cache
+int[] RuleItemsFor(MyItemType type)
+{
+    int[] matches;
+    if (ruleMatches.TryGetValue(type, out matches)) return matches;
+
+    string typeName = type.TypeId.Replace("MyObjectBuilder_", "");
+    string full = typeName + "/" + type.SubtypeId;
+    var found = new List<int>();
+    for (int i = 0; i < ruleItems.Count; i++)
+    {
+        string spec = ruleItems[i];
+        if (spec.Equals(spec.IndexOf('/') >= 0 ? full : typeName, StringComparison.OrdinalIgnoreCase))
+            found.Add(i);
+    }
+    matches = found.ToArray();
+    ruleMatches[type] = matches;
+    return matches;
+}
+
+string DecideCommand(Miner miner, bool overThreshold)
+{
+    bool stop = overThreshold, keep = false;
+    // Index incomplete (new containers not read yet): item totals would be
+    // too low, so only the volume threshold decides
+    if (unreadSlots > 0) return stop ? "STOP" : "CONT";
+    foreach (int r in miner.Rules)
+    {
+        double v = ruleVolume[r] ? volumeValues[ruleItem[r]] : itemValues[ruleItem[r]];
+        bool hit = ruleGreater[r] ? v > ruleThreshold[r] : v < ruleThreshold[r];
+        if (!hit) continue;
+        if (ruleStop[r]) stop = true; else keep = true;
+    }
+    return stop && !keep ? "STOP" : "CONT";
+}
+
+double LitersPerUnit(MyItemType type)
+{
+    double liters;
+    if (!litersPerUnit.TryGetValue(type, out liters))
+    {
+        liters = type.GetItemInfo().Volume * 1000.0;
+        litersPerUnit[type] = liters;
+    }
+    return liters;
+}
+
+// ---------- Item index ----------
+
+void CollectContainers()
+{
+    GridTerminalSystem.GetBlocksOfType(containers, c =>
+    {
+        var m = names.Match(c);
+        return m.Has(qgId) && (m.Hits & excludedMask) == 0;
+    });
+
+    // Keep known slots, drop the contribution of vanished containers
+    var kept = new Dictionary<long, InventorySlot>();
+    indexSlots.Clear();
+    unreadSlots = 0;
+    foreach (var c in containers)
+    {
+        InventorySlot slot;
+        if (!slotById.TryGetValue(c.EntityId, out slot)) slot = new InventorySlot();
+        slot.Block = c;
+        slot.Inventory = c.GetInventory();
+        kept[c.EntityId] = slot;
+        indexSlots.Add(slot);
+        if (!slot.Read) unreadSlots++;
+    }
+    foreach (var kv in slotById)
+        if (!kept.ContainsKey(kv.Key)) ApplySlot(kv.Value, -1);
+    slotById = kept;
+    if (indexCursor >= indexSlots.Count) indexCursor = 0;
+}
+
+void StepItemIndex()
+{
+    int count = Math.Min(INDEX_PER_RUN, indexSlots.Count);
+    for (int k = 0; k < count; k++)
+    {
+        var slot = indexSlots[indexCursor];
+        indexCursor = (indexCursor + 1) % indexSlots.Count;
+        if (!slot.Block.Closed)
+        {
+            ApplySlot(slot, -1);
+            slot.Last.Clear();
+            itemBuffer.Clear();
+            slot.Inventory.GetItems(itemBuffer);
+            foreach (var it in itemBuffer)
+            {
+                double prev;
+                slot.Last.TryGetValue(it.Type, out prev);
+                slot.Last[it.Type] = prev + (double)it.Amount;
+            }
+            ApplySlot(slot, 1);
+        }
+        if (!slot.Read) // a closed slot counts as read: it adds nothing
+        {
+            slot.Read = true;
+            unreadSlots--;
+        }
+    }
+}
+
+void ApplySlot(InventorySlot slot, int sign)
+{
+    foreach (var kv in slot.Last)
+    {
+        double total;
+        itemTotals.TryGetValue(kv.Key, out total);
+        itemTotals[kv.Key] = total + sign * kv.Value;
+    }
+}
+
+// Finds every keyword and tag of the script in a block name in one pass
+// (Aho-Corasick automaton, case-insensitive), plus the path of every [tag]
+// ("Miner1:Cargo", ":"-separated, each path once).
+// Results are cached per block until its name changes.
+// Keyword("Locked") matches anywhere; Tag("[YST") matches "[YST]" and
+// "[YST:n]" (index n) but not "[YST LOG]".
+class NameMatcher
+{
+    readonly List<Dictionary<char, int>> next = new List<Dictionary<char, int>> { new Dictionary<char, int>() };
+    readonly List<int> fail = new List<int> { 0 }, ends = new List<int> { 0 };
+    int count, tagMask, sweep;
+    readonly Dictionary<long, NameMatch> cache = new Dictionary<long, NameMatch>();
+
+    public int Keyword(string text) { return Add(text, false); }
+    public int Tag(string prefix) { return Add(prefix, true); }
+
+    int Add(string text, bool tag)
+    {
+        int id = count++;
+        if (id == 32) throw new Exception("NameMatcher: 32 patterns max");
+        int s = 0;
+        foreach (char raw in text)
+        {
+            char c = char.ToUpperInvariant(raw);
+            int t;
+            if (!next[s].TryGetValue(c, out t))
+            {
+                t = next.Count;
+                next.Add(new Dictionary<char, int>());
+                fail.Add(0);
+                ends.Add(0);
+                next[s][c] = t;
+            }
+            s = t;
+        }
+        ends[s] |= 1 << id;
+        if (tag) tagMask |= 1 << id;
+        return id;
+    }
+
+    // Failure links, breadth first; call once after the last Keyword/Tag
+    public void Build()
+    {
+        var queue = new Queue<int>();
+        foreach (var t in next[0].Values) queue.Enqueue(t);
+        while (queue.Count > 0)
+        {
+            int s = queue.Dequeue();
+            foreach (var kv in next[s])
+            {
+                int f = fail[s], t;
+                while (f > 0 && !next[f].ContainsKey(kv.Key)) f = fail[f];
+                fail[kv.Value] = next[f].TryGetValue(kv.Key, out t) ? t : 0;
+                ends[kv.Value] |= ends[fail[kv.Value]];
+                queue.Enqueue(kv.Value);
+            }
+        }
+    }
+
+    public NameMatch Match(IMyTerminalBlock block)
+    {
+        NameMatch m;
+        string name = block.CustomName;
+        if (!cache.TryGetValue(block.EntityId, out m)) cache[block.EntityId] = m = new NameMatch(count);
+        else if (m.Name == name) { m.Sweep = sweep; return m; }
+        Scan(name, m);
+        m.Sweep = sweep;
+        return m;
+    }
+
+    public NameMatch Match(string name)
+    {
+        var m = new NameMatch(count);
+        Scan(name, m);
+        return m;
+    }
+
+    // Forgets the blocks not matched since the previous call (call after a rescan)
+    public void Sweep()
+    {
+        var gone = new List<long>();
+        foreach (var kv in cache) if (kv.Value.Sweep != sweep) gone.Add(kv.Key);
+        foreach (var id in gone) cache.Remove(id);
+        sweep++;
+    }
+
+    void Scan(string name, NameMatch m)
+    {
+        m.Name = name;
+        m.Hits = 0;
+        m.Tags.Clear();
+        for (int i = 0; i < m.Index.Length; i++) m.Index[i] = -1;
+        if (name == null) return;
+
+        int s = 0, open = -1;
+        for (int i = 0; i < name.Length; i++)
+        {
+            char c = char.ToUpperInvariant(name[i]);
+            if (c == '[') open = i;
+            else if (c == ']' && open >= 0)
+            {
+                AddTag(name, open + 1, i, m);
+                open = -1;
+            }
+
+            int t;
+            while (s > 0 && !next[s].ContainsKey(c)) s = fail[s];
+            s = next[s].TryGetValue(c, out t) ? t : 0;
+            for (int hits = ends[s]; hits != 0; hits &= hits - 1)
+            {
+                int id = 0;
+                while ((hits & (1 << id)) == 0) id++;
+                if ((tagMask & (1 << id)) == 0) m.Hits |= 1 << id;
+                else TagEnd(name, i + 1, id, m);
+            }
+        }
+    }
+
+    // Segments trimmed, a last numeric one is an index: "[Hangar:2]" -> "Hangar"
+    static void AddTag(string name, int start, int end, NameMatch m)
+    {
+        string[] parts = name.Substring(start, end - start).Split(':');
+        int count = parts.Length, index;
+        if (count > 1 && int.TryParse(parts[count - 1], out index)) count--;
+        for (int i = 0; i < count; i++)
+        {
+            parts[i] = parts[i].Trim();
+            if (parts[i].Length == 0) return;
+        }
+        string tag = string.Join(":", parts, 0, count);
+        foreach (var t in m.Tags) if (string.Equals(t, tag, StringComparison.OrdinalIgnoreCase)) return;
+        m.Tags.Add(tag);
+    }
+
+    // After a tag prefix: "]" (no index) or ":digits]"
+    static void TagEnd(string name, int at, int id, NameMatch m)
+    {
+        if (at >= name.Length) return;
+        if (name[at] == ']') { m.Hits |= 1 << id; return; }
+        if (name[at] != ':') return;
+        int value = 0, i = at + 1;
+        while (i < name.Length && char.IsDigit(name[i]) && value < 100000) value = value * 10 + name[i++] - '0';
+        if (i == at + 1 || i >= name.Length || name[i] != ']') return;
+        if ((m.Hits & (1 << id)) == 0) m.Index[id] = value;
+        m.Hits |= 1 << id;
+    }
+}
+
+class NameMatch
 {
-    retryPending = false;
-    attemptsDone = 0;
-    delayTicks = 0;
-    Runtime.UpdateFrequency = UpdateFrequency.None;
+    public string Name;
+    public int Hits, Sweep;
+    public readonly int[] Index;                            // per Tag(): ":n" index, -1 = none
+    public readonly List<string> Tags = new List<string>(); // every [tag] path, e.g. "Hangar" for [Hangar:2], "Miner1:Cargo"
+    public NameMatch(int patterns) { Index = new int[patterns]; }
+    public bool Has(int id) { return (Hits & (1 << id)) != 0; }
 }
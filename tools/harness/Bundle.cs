@@ -0,0 +1,82 @@
+// Builds one PB script out of several: every script becomes a task class of
+// scripts/Yezus host/host.c (the kernel), then the result is compiled like
+// any other script to catch what the rewriting could not handle.
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using System.Text.RegularExpressions;
+using Harness.Snapshot;
+
+namespace Harness
+{
+    public static class Bundle
+    {
+        public const string KernelPath = "scripts/Yezus host/host.c";
+
+        // What a script uses from MyGridProgram, mapped to the task's members
+        static readonly KeyValuePair<Regex, string>[] Renames =
+        {
+            Rename(@"(?m)^public\s+Program\s*\(\s*\)", "public override void Init()"),
+            Rename(@"(?m)^(?:public\s+)?void\s+Main\s*\(\s*string\s+(\w+)\s*,\s*UpdateType\s+(\w+)\s*\)", "public override void Main(string $1, UpdateType $2)"),
+            Rename(@"(?m)^(?:public\s+)?void\s+Main\s*\(\s*string\s+(\w+)\s*\)", "public override void Main(string $1, UpdateType updateSource)"),
+            Rename(@"(?m)^(?:public\s+)?void\s+Main\s*\(\s*\)", "public override void Main(string argument, UpdateType updateSource)"),
+            Rename(@"(?m)^(?:public\s+)?void\s+Save\s*\(\s*\)", "public override void Save()"),
+            Rename(@"\bIMyGridTerminalSystem\b", "SharedTerminal"),
+            Rename(@"\bIMyGridProgramRuntimeInfo\b", "TaskRuntime"),
+        };
+
+        static KeyValuePair<Regex, string> Rename(string pattern, string replacement)
+        {
+            return new KeyValuePair<Regex, string>(new Regex(pattern), replacement);
+        }
+
+        // bundle <out.c> [alias | name=path ...]; default: the four scripts of replay
+        public static int RunCommand(string[] args)
+        {
+            if (args.Length == 0) throw new ArgumentException("bundle: no output file");
+            var tasks = new List<KeyValuePair<string, string>>();
+            for (int i = 1; i < args.Length; i++)
+            {
+                int eq = args[i].IndexOf('=');
+                if (eq > 0) tasks.Add(new KeyValuePair<string, string>(args[i].Substring(0, eq), args[i].Substring(eq + 1)));
+                else tasks.Add(new KeyValuePair<string, string>(args[i], ReplayConfig.ScriptPath(args[i])));
+            }
+            if (tasks.Count == 0)
+                foreach (var alias in new[] { "monitor", "yim", "ysi", "yst" })
+                    tasks.Add(new KeyValuePair<string, string>(alias, ReplayConfig.ScriptPath(alias)));
+
+            string text = Build(File.ReadAllText(KernelPath), tasks);
+            File.WriteAllText(args[0], text);
+            ScriptHost.Check(args[0]);
+            Console.WriteLine("{0}: {1} tasks, {2} chars (game limit 100000)", args[0], tasks.Count, text.Length);
+            return text.Length > 100000 ? 1 : 0;
+        }
+
+        public static string Build(string kernel, IList<KeyValuePair<string, string>> tasks)
+        {
+            if (!kernel.Contains("// @register") || !kernel.Contains("// @tasks"))
+                throw new ArgumentException(KernelPath + ": missing // @register or // @tasks");
+
+            var register = new StringBuilder();
+            var classes = new StringBuilder();
+            foreach (var task in tasks)
+            {
+                if (!Regex.IsMatch(task.Key, @"^\w+$")) throw new ArgumentException("bundle: bad task name " + task.Key);
+                string cls = "Task_" + task.Key;
+                register.Append("    Add(new ").Append(cls).Append("());\n");
+
+                string source = File.ReadAllText(task.Value);
+                foreach (var rename in Renames) source = rename.Key.Replace(source, rename.Value);
+
+                classes.Append("// ===== ").Append(task.Key).Append(": ").Append(task.Value).Append(" =====\n");
+                classes.Append("class ").Append(cls).Append(" : HostTask {\n");
+                classes.Append("public ").Append(cls).Append("() : base(\"").Append(task.Key).Append("\") { }\n");
+                classes.Append(source.TrimEnd()).Append("\n}\n\n");
+            }
+
+            return kernel.Replace("    // @register", register.ToString().TrimEnd('\n'))
+                .Replace("// @tasks", classes.ToString().TrimEnd('\n'));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+// Fleet simulation parameters. Every public field can be set from a config
+// file or the command line as key=value; "const.NAME=value" overrides a
+// top-level constant of the monitor script (e.g. const.THRESHOLD_PERCENT=80).
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Reflection;
+
+namespace Harness.Fleet
+{
+    public sealed class FleetConfig
+    {
+        public string Script = "scripts/miner_stopper/storage_monitor.cs";
+        public string RulesFile = "";       // Custom Data of the monitor PB
+        public double Days = 2;
+        public int Seed = 1;
+
+        // Base
+        public int BaseContainers = 4;      // large cargo containers tagged [QG]
+        public int Refineries = 4;
+        public double RefineKgPerSecond = 20;    // ore consumed per refinery
+        public double IngotSinkKgPerSecond = 10; // ingots used by assemblers
+        public double TimerSeconds = 60;         // timer block triggering the monitor, 0 = none
+
+        // PAM miners (docs/sources/PAM.md: dock, undock, fly the path, mine until full, come back)
+        public int Miners = 4;
+        public double MinerCargoM3 = 50;
+        public double MineM3PerSecond = 0.05;
+        public double TravelSeconds = 120;  // one way
+        public double TravelJitter = 0.2;   // +/- fraction of TravelSeconds
+        public double ApproachSeconds = 15; // connector Connectable before the lock
+        public double MergeSeconds = 3;     // lock -> docked PB visible in the terminal system
+        public double UndockSeconds = 10;
+        public double UnloadM3PerSecond = 1; // sorters draining the ship
+        public double StaggerSeconds = 60;   // delay between miners at start
+        public string OreMix = "Iron=0.45,Nickel=0.15,Silicon=0.2,Cobalt=0.1,Stone=0.1";
+
+        // Output
+        public double SampleMinutes = 10;
+        public string Csv = "";
+        public bool Verbose = false;
+
+        public readonly Dictionary<string, string> Constants = new Dictionary<string, string>();
+
+        public void LoadFile(string path)
+        {
+            foreach (var raw in File.ReadAllLines(path))
+            {
+                string line = raw;
+                int hash = line.IndexOf('#');
+                if (hash >= 0) line = line.Substring(0, hash);
+                line = line.Trim();
+                if (line.Length > 0) Set(line);
+            }
+        }
+
+        public void Set(string assignment)
+        {
+            int eq = assignment.IndexOf('=');
+            if (eq <= 0) throw new ArgumentException("expected key=value: " + assignment);
+            string key = assignment.Substring(0, eq).Trim();
+            string value = assignment.Substring(eq + 1).Trim();
+
+            if (key.StartsWith("const.")) { Constants[key.Substring(6)] = value; return; }
+
+            var field = typeof(FleetConfig).GetField(key, BindingFlags.Public | BindingFlags.Instance | BindingFlags.IgnoreCase);
+            if (field == null || field.IsInitOnly) throw new ArgumentException("unknown setting: " + key);
+            field.SetValue(this, Convert.ChangeType(value, field.FieldType, CultureInfo.InvariantCulture));
+        }
+
+        public List<KeyValuePair<string, double>> ParseOreMix()
+        {
+            var mix = new List<KeyValuePair<string, double>>();
+            double total = 0;
+            foreach (var part in OreMix.Split(','))
+            {
+                var kv = part.Split('=');
+                double share = double.Parse(kv[1], CultureInfo.InvariantCulture);
+                mix.Add(new KeyValuePair<string, double>(kv[0].Trim(), share));
+                total += share;
+            }
+            for (int i = 0; i < mix.Count; i++)
+                mix[i] = new KeyValuePair<string, double>(mix[i].Key, mix[i].Value / total);
+            return mix;
+        }
+    }
+}
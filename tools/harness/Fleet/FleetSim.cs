@@ -0,0 +1,418 @@
+// Discrete-event simulation of a [QG] base and its PAM miners, with the real
+// storage monitor script running on the base PB. Time advances from event to
+// event (phase ends, script updates, timer triggers, samples), never more than
+// one second at a time so the continuous flows (mining, unloading, refining)
+// are integrated at 1 s resolution.
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using Harness.Sim;
+using Sandbox.ModAPI.Ingame;
+using VRage.Game;
+using VRage.Game.ModAPI.Ingame;
+
+namespace Harness.Fleet
+{
+    enum MinerPhase { Docked, Undocking, Outbound, Mining, Inbound, Approach }
+
+    // PAM in mining mode, reduced to its job cycle and the STOP / CONT commands
+    sealed class PamMiner
+    {
+        public string Name;
+        public SimGrid Grid;
+        public SimConnector Connector;
+        public SimConnector Dock;
+        public SimProgrammableBlock Pb;
+        public SimCargo Cargo;
+
+        public MinerPhase Phase;
+        public long PhaseEnd = long.MaxValue;
+        public long LinkAt = long.MaxValue;
+        public long HoldUntil;
+        public bool Stopped;
+
+        public int Trips, StopsReceived, ContsReceived;
+        public double IdleSeconds, BlockedSeconds, MiningSeconds, TravelSeconds;
+        public double DeliveredKg;
+
+        public Action<PamMiner, string> OnCommand;
+
+        public bool Run(string argument)
+        {
+            string command = argument.Trim().ToUpperInvariant();
+            if (command == "STOP") { Stopped = true; StopsReceived++; }
+            else if (command == "CONT") { Stopped = false; ContsReceived++; }
+            if (OnCommand != null) OnCommand(this, command);
+            return true;
+        }
+    }
+
+    public sealed class FleetSim
+    {
+        const long Quantum = 60; // ticks, flow integration step
+
+        readonly FleetConfig config;
+        readonly SimWorld world = new SimWorld();
+        readonly Random random;
+        readonly List<SimCargo> baseCargo = new List<SimCargo>();
+        readonly List<PamMiner> miners = new List<PamMiner>();
+        readonly List<KeyValuePair<MyItemType, double>> oreMix = new List<KeyValuePair<MyItemType, double>>();
+        readonly List<MyItemType> oreTypes = new List<MyItemType>();
+        readonly List<MyItemType> ingotTypes = new List<MyItemType>();
+        readonly List<MyItemType> scratch = new List<MyItemType>();
+        ScriptHost monitor;
+        TextWriter csv;
+        TextWriter log;
+
+        double fillSeconds, maxFill, fullSeconds;
+        double refineryStarved, refineryBlocked;
+        double oreRefinedKg, ingotProducedKg, ingotConsumedKg;
+
+        public FleetSim(FleetConfig config)
+        {
+            this.config = config;
+            random = new Random(config.Seed);
+            foreach (var kv in config.ParseOreMix())
+            {
+                var ore = MyItemType.MakeOre(kv.Key);
+                oreMix.Add(new KeyValuePair<MyItemType, double>(ore, kv.Value));
+                oreTypes.Add(ore);
+                ingotTypes.Add(MyItemType.MakeIngot(kv.Key));
+            }
+        }
+
+        public static int RunCommand(string[] args)
+        {
+            var config = new FleetConfig();
+            foreach (var arg in args)
+            {
+                if (arg.Contains("=")) config.Set(arg);
+                else config.LoadFile(arg);
+            }
+            var sim = new FleetSim(config);
+            sim.Build();
+            sim.Run(Console.Out);
+            return 0;
+        }
+
+        static long Ticks(double seconds) { return (long)Math.Round(seconds * 60); }
+
+        public void Build()
+        {
+            var baseGrid = world.AddGrid("QG Base", MyCubeSize.Large, true);
+            var monitorPb = new SimProgrammableBlock(baseGrid, "QG Storage Monitor");
+            if (config.RulesFile.Length > 0) monitorPb.CustomData = File.ReadAllText(config.RulesFile);
+            for (int i = 0; i < config.BaseContainers; i++)
+                baseCargo.Add(new SimCargo(baseGrid, "[QG] Large Cargo Container " + (i + 1)));
+
+            for (int i = 0; i < config.Miners; i++)
+            {
+                var m = new PamMiner { Name = "HMiner-" + (i + 1) };
+                m.Dock = new SimConnector(baseGrid, "[QG] Connector " + (i + 1));
+                m.Grid = world.AddGrid(m.Name, MyCubeSize.Large);
+                m.Connector = new SimConnector(m.Grid, "Connector [PAM]");
+                m.Pb = new SimProgrammableBlock(m.Grid, "[" + m.Name + "] Programmable Block");
+                m.Cargo = new SimCargo(m.Grid, "Large Cargo Container", config.MinerCargoM3);
+                m.Pb.Handler = m.Run;
+                m.OnCommand = (miner, command) =>
+                {
+                    if (log != null) log.WriteLine("{0} {1} <- {2}", Clock(world.Tick), miner.Name, command);
+                };
+
+                // Everyone starts docked and empty, leaving one after the other
+                world.Dock(m.Connector, m.Dock);
+                world.Link(m.Connector);
+                m.Phase = MinerPhase.Docked;
+                m.HoldUntil = Ticks(config.StaggerSeconds * i);
+                miners.Add(m);
+            }
+
+            monitor = new ScriptHost(config.Script, monitorPb, config.Constants);
+        }
+
+        public void Run(TextWriter output)
+        {
+            log = config.Verbose ? output : null;
+            if (config.Csv.Length > 0)
+            {
+                csv = new StreamWriter(config.Csv);
+                csv.WriteLine("hours,fill_pct,mining,stopped,blocked,ore_kg,ingot_kg");
+            }
+
+            long end = Ticks(config.Days * 86400);
+            long sampleTicks = Math.Max(1, Ticks(config.SampleMinutes * 60));
+            long timerTicks = config.TimerSeconds > 0 ? Ticks(config.TimerSeconds) : long.MaxValue;
+            long nextSample = 0, nextTimer = timerTicks;
+            long nextScript = monitor.NextUpdateTick(0);
+            var wall = Stopwatch.StartNew();
+
+            while (world.Tick < end)
+            {
+                long now = world.Tick;
+                long next = Math.Min(end, now + Quantum);
+                next = Math.Min(next, Math.Max(now + 1, nextSample));
+                next = Math.Min(next, nextScript);
+                next = Math.Min(next, nextTimer);
+                foreach (var m in miners)
+                {
+                    next = Math.Min(next, m.PhaseEnd);
+                    next = Math.Min(next, m.LinkAt);
+                    if (m.HoldUntil > now) next = Math.Min(next, m.HoldUntil);
+                }
+                if (next <= now) next = now + 1;
+
+                Integrate((next - now) / 60.0);
+                world.Tick = next;
+                Advance(next);
+
+                if (next >= nextSample) { Sample(next); nextSample += sampleTicks; }
+                if (next >= nextScript) monitor.RunUpdate(next);
+                if (next >= nextTimer) { monitor.Run("", UpdateType.Trigger); nextTimer += timerTicks; }
+                nextScript = monitor.NextUpdateTick(next);
+            }
+            wall.Stop();
+
+            if (csv != null) csv.Dispose();
+            Report(output, end, wall.Elapsed.TotalSeconds);
+        }
+
+        // ---------- Continuous flows ----------
+
+        void Integrate(double dt)
+        {
+            double fill = BaseFill();
+            fillSeconds += fill * dt;
+            if (fill > maxFill) maxFill = fill;
+            if (fill >= 0.99) fullSeconds += dt;
+
+            foreach (var m in miners)
+            {
+                switch (m.Phase)
+                {
+                    case MinerPhase.Docked:
+                        if (m.Cargo.Inventory.VolumeM3 > 1e-6)
+                        {
+                            double want = config.UnloadM3PerSecond * dt;
+                            if (Unload(m, want) < want * 0.5 && m.Cargo.Inventory.VolumeM3 > 1e-6) m.BlockedSeconds += dt;
+                        }
+                        else if (m.Stopped) m.IdleSeconds += dt;
+                        break;
+                    case MinerPhase.Mining:
+                        m.MiningSeconds += dt;
+                        double room = Math.Min(config.MineM3PerSecond * dt, m.Cargo.Inventory.FreeM3);
+                        foreach (var kv in oreMix)
+                            m.Cargo.Inventory.Add(kv.Key, room * kv.Value / ItemCatalog.VolumeM3(kv.Key));
+                        break;
+                    default:
+                        m.TravelSeconds += dt;
+                        break;
+                }
+            }
+
+            Refine(dt);
+            ConsumeIngots(config.IngotSinkKgPerSecond * dt);
+        }
+
+        double Unload(PamMiner m, double maxM3)
+        {
+            double moved = 0;
+            scratch.Clear();
+            scratch.AddRange(m.Cargo.Inventory.Types);
+            foreach (var type in scratch)
+            {
+                double volume = ItemCatalog.VolumeM3(type);
+                double take = Math.Min(m.Cargo.Inventory.Amount(type), (maxM3 - moved) / volume);
+                double added = BaseAdd(type, take);
+                m.Cargo.Inventory.Remove(type, added);
+                m.DeliveredKg += added * ItemCatalog.Info(type).Mass;
+                moved += added * volume;
+                if (added < take || moved >= maxM3 - 1e-9) break;
+            }
+            return moved;
+        }
+
+        // Refineries pull ore in mix order (their queue) and push ingots back
+        void Refine(double dt)
+        {
+            if (config.Refineries == 0) return;
+            double need = config.Refineries * config.RefineKgPerSecond * dt;
+            double refineryTime = config.Refineries * dt;
+            if (BaseFreeM3() < need * 0.2 / 1000)
+            {
+                refineryBlocked += refineryTime;
+                return;
+            }
+
+            double got = 0;
+            for (int i = 0; i < oreTypes.Count && got < need; i++)
+            {
+                double taken = BaseRemove(oreTypes[i], need - got);
+                if (taken <= 0) continue;
+                double yield;
+                ItemCatalog.RefineYield.TryGetValue(oreTypes[i].SubtypeId, out yield);
+                ingotProducedKg += BaseAdd(ingotTypes[i], taken * yield);
+                got += taken;
+            }
+            oreRefinedKg += got;
+            if (got < need) refineryStarved += refineryTime * (1 - got / need);
+        }
+
+        void ConsumeIngots(double kg)
+        {
+            for (int i = 0; i < ingotTypes.Count && kg > 0; i++)
+            {
+                double taken = BaseRemove(ingotTypes[i], kg);
+                ingotConsumedKg += taken;
+                kg -= taken;
+            }
+        }
+
+        // ---------- Discrete events ----------
+
+        void Advance(long tick)
+        {
+            foreach (var m in miners)
+            {
+                if (m.LinkAt <= tick) { world.Link(m.Connector); m.LinkAt = long.MaxValue; }
+                if (m.Phase != MinerPhase.Docked && m.Phase != MinerPhase.Mining && tick < m.PhaseEnd) continue;
+
+                switch (m.Phase)
+                {
+                    case MinerPhase.Docked:
+                        if (m.Cargo.Inventory.VolumeM3 > 1e-6 || m.Stopped || tick < m.HoldUntil) break;
+                        world.Undock(m.Connector);
+                        Enter(m, MinerPhase.Undocking, tick + Ticks(config.UndockSeconds));
+                        break;
+                    case MinerPhase.Undocking:
+                        Enter(m, MinerPhase.Outbound, tick + Travel());
+                        break;
+                    case MinerPhase.Outbound:
+                        Enter(m, MinerPhase.Mining, long.MaxValue);
+                        break;
+                    case MinerPhase.Mining:
+                        if (m.Cargo.Inventory.FreeM3 > 1e-6) break;
+                        Enter(m, MinerPhase.Inbound, tick + Travel());
+                        break;
+                    case MinerPhase.Inbound:
+                        m.Connector.Status = MyShipConnectorStatus.Connectable;
+                        m.Dock.Status = MyShipConnectorStatus.Connectable;
+                        Enter(m, MinerPhase.Approach, tick + Ticks(config.ApproachSeconds));
+                        break;
+                    case MinerPhase.Approach:
+                        world.Dock(m.Connector, m.Dock);
+                        m.LinkAt = tick + Ticks(config.MergeSeconds);
+                        m.Trips++;
+                        Enter(m, MinerPhase.Docked, long.MaxValue);
+                        break;
+                }
+            }
+        }
+
+        void Enter(PamMiner m, MinerPhase phase, long end)
+        {
+            m.Phase = phase;
+            m.PhaseEnd = end;
+        }
+
+        long Travel()
+        {
+            double jitter = (random.NextDouble() * 2 - 1) * config.TravelJitter;
+            return Ticks(config.TravelSeconds * (1 + jitter));
+        }
+
+        // ---------- Base storage ----------
+
+        double BaseAdd(MyItemType type, double amount)
+        {
+            double added = 0;
+            foreach (var c in baseCargo)
+            {
+                if (added >= amount) break;
+                added += c.Inventory.Add(type, amount - added);
+            }
+            return added;
+        }
+
+        double BaseRemove(MyItemType type, double amount)
+        {
+            double removed = 0;
+            foreach (var c in baseCargo)
+            {
+                if (removed >= amount) break;
+                removed += c.Inventory.Remove(type, amount - removed);
+            }
+            return removed;
+        }
+
+        double BaseAmount(List<MyItemType> types)
+        {
+            double total = 0;
+            foreach (var c in baseCargo)
+                foreach (var t in types)
+                    total += c.Inventory.Amount(t);
+            return total;
+        }
+
+        double BaseFill()
+        {
+            double used = 0, max = 0;
+            foreach (var c in baseCargo) { used += c.Inventory.VolumeM3; max += c.Inventory.MaxVolumeM3; }
+            return max > 0 ? used / max : 0;
+        }
+
+        double BaseFreeM3()
+        {
+            double free = 0;
+            foreach (var c in baseCargo) free += c.Inventory.FreeM3;
+            return free;
+        }
+
+        // ---------- Output ----------
+
+        static string Clock(long tick)
+        {
+            var t = TimeSpan.FromSeconds(tick / 60.0);
+            return string.Format(CultureInfo.InvariantCulture, "d{0} {1:hh\\:mm\\:ss}", (int)t.TotalDays, t);
+        }
+
+        void Sample(long tick)
+        {
+            if (csv == null) return;
+            int mining = 0, stopped = 0, blocked = 0;
+            foreach (var m in miners)
+            {
+                if (m.Phase == MinerPhase.Mining) mining++;
+                if (m.Phase == MinerPhase.Docked && m.Stopped) stopped++;
+                if (m.Phase == MinerPhase.Docked && m.Cargo.Inventory.VolumeM3 > 1e-6 && BaseFreeM3() < 1e-3) blocked++;
+            }
+            csv.WriteLine(string.Format(CultureInfo.InvariantCulture, "{0:0.###},{1:0.##},{2},{3},{4},{5:0},{6:0}",
+                tick / 216000.0, BaseFill() * 100, mining, stopped, blocked, BaseAmount(oreTypes), BaseAmount(ingotTypes)));
+        }
+
+        void Report(TextWriter o, long ticks, double wallSeconds)
+        {
+            double seconds = ticks / 60.0;
+            var inv = CultureInfo.InvariantCulture;
+            o.WriteLine(string.Format(inv, "Simulated {0:0.##} days ({1:N0} ticks) in {2:0.0} s ({3:N0} ticks/s)",
+                seconds / 86400, ticks, wallSeconds, ticks / Math.Max(1e-9, wallSeconds)));
+            o.WriteLine(string.Format(inv, "Monitor: {0:N0} runs, avg {1:0.000} ms, max {2:0.000} ms",
+                monitor.Runs, monitor.TotalMs / Math.Max(1, monitor.Runs), monitor.MaxMs));
+            o.WriteLine(string.Format(inv, "Base fill: avg {0:0.0}%, max {1:0.0}%, full (>=99%) {2:0.0} h",
+                fillSeconds / seconds * 100, maxFill * 100, fullSeconds / 3600));
+            if (config.Refineries > 0)
+            {
+                double refineryTime = config.Refineries * seconds;
+                o.WriteLine(string.Format(inv, "Refineries: starved {0:0.0}%, output blocked {1:0.0}%, ore refined {2:N0} kg, ingots {3:N0} kg made / {4:N0} kg used",
+                    refineryStarved / refineryTime * 100, refineryBlocked / refineryTime * 100, oreRefinedKg, ingotProducedKg, ingotConsumedKg));
+            }
+            o.WriteLine();
+            o.WriteLine("Miner        Trips  Mining  Travel  Idle(STOP)  Blocked  Delivered kg  STOP  CONT");
+            foreach (var m in miners)
+                o.WriteLine(string.Format(inv, "{0,-12} {1,5}  {2,5:0.0}%  {3,5:0.0}%  {4,9:0.0}%  {5,6:0.0}%  {6,12:N0}  {7,4}  {8,4}",
+                    m.Name, m.Trips, m.MiningSeconds / seconds * 100, m.TravelSeconds / seconds * 100,
+                    m.IdleSeconds / seconds * 100, m.BlockedSeconds / seconds * 100, m.DeliveredKg, m.StopsReceived, m.ContsReceived));
+        }
+    }
+}
@@ -0,0 +1,224 @@
+// Stub of the in-game block interfaces, reduced to what the scripts touch.
+using System;
+using System.Collections.Generic;
+using VRage;
+using VRage.Game.ModAPI.Ingame;
+using VRage.ObjectBuilders;
+using VRageMath;
+
+namespace VRage.ObjectBuilders
+{
+    public struct SerializableDefinitionId
+    {
+        public string TypeIdString;
+        public string SubtypeName;
+
+        public SerializableDefinitionId(string typeId, string subtype)
+        {
+            TypeIdString = typeId;
+            SubtypeName = subtype;
+        }
+
+        public string TypeId { get { return TypeIdString; } }
+        public string SubtypeId { get { return SubtypeName; } }
+        public override string ToString() { return TypeIdString + "/" + SubtypeName; }
+    }
+}
+
+namespace VRage.Game
+{
+    public enum MyCubeSize : byte { Large = 0, Small = 1 }
+}
+
+namespace VRage.Game.ModAPI.Ingame
+{
+    public interface IMyEntity
+    {
+        long EntityId { get; }
+        string Name { get; }
+        string DisplayName { get; }
+        bool Closed { get; }
+        bool HasInventory { get; }
+        int InventoryCount { get; }
+        IMyInventory GetInventory();
+        IMyInventory GetInventory(int index);
+        MatrixD WorldMatrix { get; }
+        Vector3D GetPosition();
+    }
+
+    public interface IMyCubeGrid : IMyEntity
+    {
+        string CustomName { get; set; }
+        VRage.Game.MyCubeSize GridSizeEnum { get; }
+        bool IsStatic { get; }
+    }
+
+    public interface IMyCubeBlock : IMyEntity
+    {
+        IMyCubeGrid CubeGrid { get; }
+        SerializableDefinitionId BlockDefinition { get; }
+        string DefinitionDisplayNameText { get; }
+        bool IsFunctional { get; }
+        bool IsWorking { get; }
+        string DisplayNameText { get; }
+        MyBlockOrientation Orientation { get; }
+    }
+}
+
+namespace Sandbox.ModAPI.Ingame
+{
+    public enum MyShipConnectorStatus { Unconnected, Connectable, Connected }
+
+    public interface IMyTerminalBlock : IMyCubeBlock
+    {
+        string CustomName { get; set; }
+        string CustomData { get; set; }
+        string DetailedInfo { get; }
+        bool ShowInTerminal { get; set; }
+        bool IsSameConstructAs(IMyTerminalBlock other);
+    }
+
+    public interface IMyFunctionalBlock : IMyTerminalBlock
+    {
+        bool Enabled { get; set; }
+    }
+
+    public interface IMyCargoContainer : IMyTerminalBlock { }
+
+    public interface IMyShipConnector : IMyFunctionalBlock
+    {
+        MyShipConnectorStatus Status { get; }
+        bool IsConnected { get; }
+        IMyShipConnector OtherConnector { get; }
+        void Connect();
+        void Disconnect();
+    }
+
+    public interface IMyProgrammableBlock : IMyFunctionalBlock, IMyTextSurfaceProvider
+    {
+        bool IsRunning { get; }
+        bool TryRun(string argument);
+    }
+
+    public interface IMyGasTank : IMyFunctionalBlock
+    {
+        float Capacity { get; }         // litres
+        double FilledRatio { get; }
+        bool Stockpile { get; set; }
+    }
+
+    // Output in MW; stored power in MWh
+    public interface IMyPowerProducer : IMyFunctionalBlock
+    {
+        float CurrentOutput { get; }
+        float MaxOutput { get; }
+    }
+
+    public interface IMyBatteryBlock : IMyPowerProducer
+    {
+        float CurrentStoredPower { get; }
+        float MaxStoredPower { get; }
+        float CurrentInput { get; }
+        float MaxInput { get; }
+    }
+
+    public interface IMyReactor : IMyPowerProducer { }
+    public interface IMySolarPanel : IMyPowerProducer { }
+
+    // Inventory 0 is the input (ore, ingots to assemble), 1 the output
+    public interface IMyProductionBlock : IMyFunctionalBlock
+    {
+        IMyInventory InputInventory { get; }
+        IMyInventory OutputInventory { get; }
+        bool IsProducing { get; }
+        bool IsQueueEmpty { get; }
+        bool UseConveyorSystem { get; set; }
+        void GetQueue(List<MyProductionItem> items);
+    }
+
+    public interface IMyRefinery : IMyProductionBlock { }
+    public interface IMyAssembler : IMyProductionBlock { }
+
+    public struct MyProductionItem
+    {
+        public MyFixedPoint Amount;
+        public uint ItemId;
+
+        public MyProductionItem(uint itemId, MyFixedPoint amount)
+        {
+            ItemId = itemId;
+            Amount = amount;
+        }
+    }
+
+    // O2/H2 generator: ice in inventory 0
+    public interface IMyGasGenerator : IMyFunctionalBlock
+    {
+        bool AutoRefill { get; set; }
+    }
+
+    public enum VentStatus { Depressurized, Depressurizing, Pressurized, Pressurizing }
+
+    public interface IMyAirVent : IMyFunctionalBlock
+    {
+        bool Depressurize { get; set; }
+        bool CanPressurize { get; }
+        VentStatus Status { get; }
+        float GetOxygenLevel();
+    }
+
+    // GetOutput: 0..1 of the farm's maximum production (sunlight)
+    public interface IMyOxygenFarm : IMyFunctionalBlock
+    {
+        bool CanProduce { get; }
+        float GetOutput();
+    }
+
+    // Thrust in N
+    public interface IMyThrust : IMyFunctionalBlock
+    {
+        float ThrustOverride { get; set; }
+        float MaxThrust { get; }
+        float MaxEffectiveThrust { get; }
+        float CurrentThrust { get; }
+    }
+
+    public struct MyShipMass
+    {
+        public readonly float BaseMass;     // blocks only, kg
+        public readonly float TotalMass;    // blocks + inventories
+        public readonly float PhysicalMass; // what thrusters push (inventory multiplier applied)
+
+        public MyShipMass(float baseMass, float totalMass, float physicalMass)
+        {
+            BaseMass = baseMass;
+            TotalMass = totalMass;
+            PhysicalMass = physicalMass;
+        }
+    }
+
+    public struct MyShipVelocities
+    {
+        public readonly Vector3D LinearVelocity;  // m/s, world frame
+        public readonly Vector3D AngularVelocity; // rad/s
+
+        public MyShipVelocities(Vector3D linear, Vector3D angular)
+        {
+            LinearVelocity = linear;
+            AngularVelocity = angular;
+        }
+    }
+
+    public interface IMyShipController : IMyTerminalBlock
+    {
+        bool IsMainCockpit { get; set; }
+        bool CanControlShip { get; }
+        MyShipMass CalculateShipMass();
+        Vector3D GetNaturalGravity();
+        double GetShipSpeed();
+        MyShipVelocities GetShipVelocities();
+    }
+
+    public interface IMyCockpit : IMyShipController, IMyTextSurfaceProvider { }
+    public interface IMyRemoteControl : IMyShipController { }
+}
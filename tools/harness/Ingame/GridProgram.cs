@@ -0,0 +1,95 @@
+// Stub of MyGridProgram and the terminal system. The host sets up the program
+// context before constructing a script, like the game does, so the script's
+// constructor can already use GridTerminalSystem, Me and Runtime.
+using System;
+using System.Collections.Generic;
+
+namespace Sandbox.ModAPI.Ingame
+{
+    [Flags]
+    public enum UpdateType
+    {
+        None = 0,
+        Terminal = 1 << 0,
+        Trigger = 1 << 1,
+        Mod = 1 << 3,
+        Script = 1 << 4,
+        Update1 = 1 << 5,
+        Update10 = 1 << 6,
+        Update100 = 1 << 7,
+        Once = 1 << 8,
+        IGC = 1 << 9,
+    }
+
+    [Flags]
+    public enum UpdateFrequency : byte
+    {
+        None = 0,
+        Update1 = 1,
+        Update10 = 2,
+        Update100 = 4,
+        Once = 8,
+    }
+
+    public interface IMyGridProgramRuntimeInfo
+    {
+        TimeSpan TimeSinceLastRun { get; }
+        double LastRunTimeMs { get; }
+        int MaxInstructionCount { get; }
+        int CurrentInstructionCount { get; }
+        int MaxCallChainDepth { get; }
+        int CurrentCallChainDepth { get; }
+        UpdateFrequency UpdateFrequency { get; set; }
+    }
+
+    public interface IMyGridTerminalSystem
+    {
+        void GetBlocks(List<IMyTerminalBlock> blocks);
+        void GetBlocksOfType<T>(List<IMyTerminalBlock> blocks, Func<IMyTerminalBlock, bool> collect = null) where T : class;
+        void GetBlocksOfType<T>(List<T> blocks, Func<T, bool> collect = null) where T : class;
+        void SearchBlocksOfName(string name, List<IMyTerminalBlock> blocks, Func<IMyTerminalBlock, bool> collect = null);
+        IMyTerminalBlock GetBlockWithName(string name);
+        IMyTerminalBlock GetBlockWithId(long id);
+    }
+
+    public sealed class ProgramContext
+    {
+        public IMyGridTerminalSystem GridTerminalSystem;
+        public IMyProgrammableBlock Me;
+        public IMyGridProgramRuntimeInfo Runtime;
+        public Action<string> Echo;
+        public string Storage;
+        public IMyIntergridCommunicationSystem IGC;
+    }
+
+    public abstract class MyGridProgram
+    {
+        [ThreadStatic] static ProgramContext pending;
+
+        // Set by the host right before the script's constructor runs
+        public static void PrepareContext(ProgramContext context) { pending = context; }
+
+        protected MyGridProgram()
+        {
+            var context = pending;
+            pending = null;
+            if (context == null) throw new InvalidOperationException("No program context: construct scripts through ScriptHost");
+            GridTerminalSystem = context.GridTerminalSystem;
+            Me = context.Me;
+            Runtime = context.Runtime;
+            Echo = context.Echo;
+            Storage = context.Storage ?? "";
+            IGC = context.IGC;
+        }
+
+        public IMyGridTerminalSystem GridTerminalSystem { get; protected set; }
+        public IMyProgrammableBlock Me { get; protected set; }
+        public IMyGridProgramRuntimeInfo Runtime { get; protected set; }
+        public Action<string> Echo { get; protected set; }
+        public string Storage { get; protected set; }
+        public IMyIntergridCommunicationSystem IGC { get; protected set; }
+
+        // Lets the host read Storage after Save() without reflection
+        public string StorageForHost { get { return Storage; } }
+    }
+}
@@ -0,0 +1,62 @@
+// Stub of the intergrid communication system (IGC), as used by the scripts'
+// telemetry packets: broadcast listeners, unicast and message callbacks.
+using System;
+using System.Collections.Generic;
+
+namespace Sandbox.ModAPI.Ingame
+{
+    public enum TransmissionDistance
+    {
+        CurrentConstruct = 0,
+        ConnectedConstructs = 1,
+        AntennaRelay = 2,
+        TransmissionDistanceMax = AntennaRelay,
+    }
+
+    public struct MyIGCMessage
+    {
+        public readonly object Data;
+        public readonly string Tag;
+        public readonly long Source;
+
+        public MyIGCMessage(object data, string tag, long source)
+        {
+            Data = data;
+            Tag = tag;
+            Source = source;
+        }
+
+        public T As<T>() { return (T)Data; }
+    }
+
+    public interface IMyMessageProvider
+    {
+        bool HasPendingMessage { get; }
+        int MaxWaitingMessages { get; }
+        MyIGCMessage AcceptMessage();
+        void SetMessageCallback(string argument = "");
+        void DisableMessageCallback();
+    }
+
+    public interface IMyBroadcastListener : IMyMessageProvider
+    {
+        string Tag { get; }
+        bool IsActive { get; }
+    }
+
+    public interface IMyUnicastListener : IMyMessageProvider
+    {
+    }
+
+    public interface IMyIntergridCommunicationSystem
+    {
+        long Me { get; }
+        IMyUnicastListener UnicastListener { get; }
+        bool IsEndpointReachable(long address, TransmissionDistance transmissionDistance = TransmissionDistance.AntennaRelay);
+        void SendBroadcastMessage<TData>(string tag, TData data, TransmissionDistance transmissionDistance = TransmissionDistance.AntennaRelay);
+        bool SendUnicastMessage<TData>(long addressee, string tag, TData data);
+        IMyBroadcastListener RegisterBroadcastListener(string tag);
+        void DisableBroadcastListener(IMyBroadcastListener broadcastListener);
+        void GetBroadcastListeners(List<IMyBroadcastListener> broadcastListeners, Func<IMyBroadcastListener, bool> collect = null);
+    }
+}
@@ -0,0 +1,114 @@
+// Stub of the in-game item types. Only the members the scripts use exist here;
+// semantics follow the game (volumes in m3, MyFixedPoint with 6 decimals).
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using VRage;
+
+namespace VRage
+{
+    public struct MyFixedPoint : IComparable<MyFixedPoint>, IEquatable<MyFixedPoint>
+    {
+        const long Scale = 1000000;
+        public long RawValue;
+
+        public static readonly MyFixedPoint Zero = new MyFixedPoint();
+        public static readonly MyFixedPoint MaxValue = new MyFixedPoint { RawValue = long.MaxValue };
+
+        public static implicit operator MyFixedPoint(int value) { return new MyFixedPoint { RawValue = value * Scale }; }
+        public static explicit operator MyFixedPoint(double value) { return new MyFixedPoint { RawValue = (long)Math.Round(value * Scale) }; }
+        public static explicit operator MyFixedPoint(float value) { return (MyFixedPoint)(double)value; }
+        public static explicit operator double(MyFixedPoint value) { return (double)value.RawValue / Scale; }
+        public static explicit operator float(MyFixedPoint value) { return (float)((double)value.RawValue / Scale); }
+        public static explicit operator int(MyFixedPoint value) { return (int)(value.RawValue / Scale); }
+
+        public static MyFixedPoint operator +(MyFixedPoint a, MyFixedPoint b) { return new MyFixedPoint { RawValue = a.RawValue + b.RawValue }; }
+        public static MyFixedPoint operator -(MyFixedPoint a, MyFixedPoint b) { return new MyFixedPoint { RawValue = a.RawValue - b.RawValue }; }
+        public static MyFixedPoint operator *(MyFixedPoint a, MyFixedPoint b) { return (MyFixedPoint)((double)a * (double)b); }
+        public static bool operator <(MyFixedPoint a, MyFixedPoint b) { return a.RawValue < b.RawValue; }
+        public static bool operator >(MyFixedPoint a, MyFixedPoint b) { return a.RawValue > b.RawValue; }
+        public static bool operator <=(MyFixedPoint a, MyFixedPoint b) { return a.RawValue <= b.RawValue; }
+        public static bool operator >=(MyFixedPoint a, MyFixedPoint b) { return a.RawValue >= b.RawValue; }
+        public static bool operator ==(MyFixedPoint a, MyFixedPoint b) { return a.RawValue == b.RawValue; }
+        public static bool operator !=(MyFixedPoint a, MyFixedPoint b) { return a.RawValue != b.RawValue; }
+
+        public int CompareTo(MyFixedPoint other) { return RawValue.CompareTo(other.RawValue); }
+        public bool Equals(MyFixedPoint other) { return RawValue == other.RawValue; }
+        public override bool Equals(object obj) { return obj is MyFixedPoint && Equals((MyFixedPoint)obj); }
+        public override int GetHashCode() { return RawValue.GetHashCode(); }
+        public override string ToString() { return ((double)this).ToString(CultureInfo.InvariantCulture); }
+    }
+}
+
+namespace VRage.Game.ModAPI.Ingame
+{
+    public struct MyItemInfo
+    {
+        public float Mass;   // kg per unit
+        public float Volume; // m3 per unit
+        public bool IsOre;
+        public bool IsIngot;
+    }
+
+    public struct MyItemType : IEquatable<MyItemType>
+    {
+        readonly string typeId, subtypeId;
+
+        public MyItemType(string typeId, string subtypeId)
+        {
+            this.typeId = typeId;
+            this.subtypeId = subtypeId;
+        }
+
+        public string TypeId { get { return typeId; } }
+        public string SubtypeId { get { return subtypeId; } }
+
+        public MyItemInfo GetItemInfo() { return Harness.Sim.ItemCatalog.Info(this); }
+
+        public static MyItemType MakeOre(string subtype) { return new MyItemType("MyObjectBuilder_Ore", subtype); }
+        public static MyItemType MakeIngot(string subtype) { return new MyItemType("MyObjectBuilder_Ingot", subtype); }
+        public static MyItemType MakeComponent(string subtype) { return new MyItemType("MyObjectBuilder_Component", subtype); }
+
+        // "Ore/Iron" or "MyObjectBuilder_Ore/Iron"
+        public static MyItemType Parse(string text)
+        {
+            int slash = text.IndexOf('/');
+            string type = text.Substring(0, slash);
+            if (!type.StartsWith("MyObjectBuilder_")) type = "MyObjectBuilder_" + type;
+            return new MyItemType(type, text.Substring(slash + 1));
+        }
+
+        public bool Equals(MyItemType other) { return typeId == other.typeId && subtypeId == other.subtypeId; }
+        public override bool Equals(object obj) { return obj is MyItemType && Equals((MyItemType)obj); }
+        public override int GetHashCode() { return (typeId ?? "").GetHashCode() * 397 ^ (subtypeId ?? "").GetHashCode(); }
+        public static bool operator ==(MyItemType a, MyItemType b) { return a.Equals(b); }
+        public static bool operator !=(MyItemType a, MyItemType b) { return !a.Equals(b); }
+        public override string ToString() { return typeId + "/" + subtypeId; }
+    }
+
+    public struct MyInventoryItem
+    {
+        public readonly MyItemType Type;
+        public readonly MyFixedPoint Amount;
+        public readonly uint ItemId;
+
+        public MyInventoryItem(MyItemType type, uint itemId, MyFixedPoint amount)
+        {
+            Type = type;
+            ItemId = itemId;
+            Amount = amount;
+        }
+    }
+
+    public interface IMyInventory
+    {
+        IMyEntity Owner { get; }
+        MyFixedPoint CurrentMass { get; }
+        MyFixedPoint MaxVolume { get; }
+        MyFixedPoint CurrentVolume { get; }
+        int ItemCount { get; }
+        bool IsFull { get; }
+        void GetItems(List<MyInventoryItem> items, Func<MyInventoryItem, bool> filter = null);
+        MyFixedPoint GetItemAmount(MyItemType itemType);
+    }
+}
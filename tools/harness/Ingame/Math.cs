@@ -0,0 +1,187 @@
+// Stub of the VRageMath types the scripts use. Conventions follow the game:
+// a world matrix stores Right, Up and Backward in rows 1-3, Forward = -Backward.
+using System;
+
+namespace VRageMath
+{
+    public struct Vector2 : IEquatable<Vector2>
+    {
+        public float X, Y;
+
+        public Vector2(float x, float y) { X = x; Y = y; }
+
+        public static readonly Vector2 Zero = new Vector2(0, 0);
+
+        public static Vector2 operator +(Vector2 a, Vector2 b) { return new Vector2(a.X + b.X, a.Y + b.Y); }
+        public static Vector2 operator -(Vector2 a, Vector2 b) { return new Vector2(a.X - b.X, a.Y - b.Y); }
+        public static Vector2 operator *(Vector2 a, float s) { return new Vector2(a.X * s, a.Y * s); }
+        public static Vector2 operator *(float s, Vector2 a) { return new Vector2(a.X * s, a.Y * s); }
+        public static Vector2 operator /(Vector2 a, float s) { return new Vector2(a.X / s, a.Y / s); }
+        public static bool operator ==(Vector2 a, Vector2 b) { return a.X == b.X && a.Y == b.Y; }
+        public static bool operator !=(Vector2 a, Vector2 b) { return !(a == b); }
+
+        public bool Equals(Vector2 other) { return this == other; }
+        public override bool Equals(object obj) { return obj is Vector2 && this == (Vector2)obj; }
+        public override int GetHashCode() { return X.GetHashCode() * 397 ^ Y.GetHashCode(); }
+        public override string ToString() { return "{X:" + X + " Y:" + Y + "}"; }
+    }
+
+    public struct Vector3D : IEquatable<Vector3D>
+    {
+        public double X, Y, Z;
+
+        public Vector3D(double x, double y, double z) { X = x; Y = y; Z = z; }
+
+        public static readonly Vector3D Zero = new Vector3D(0, 0, 0);
+        public static readonly Vector3D Forward = new Vector3D(0, 0, -1);
+        public static readonly Vector3D Backward = new Vector3D(0, 0, 1);
+        public static readonly Vector3D Up = new Vector3D(0, 1, 0);
+        public static readonly Vector3D Down = new Vector3D(0, -1, 0);
+        public static readonly Vector3D Right = new Vector3D(1, 0, 0);
+        public static readonly Vector3D Left = new Vector3D(-1, 0, 0);
+
+        public double Length() { return Math.Sqrt(X * X + Y * Y + Z * Z); }
+        public double LengthSquared() { return X * X + Y * Y + Z * Z; }
+
+        public static double Dot(Vector3D a, Vector3D b) { return a.X * b.X + a.Y * b.Y + a.Z * b.Z; }
+        public static Vector3D Cross(Vector3D a, Vector3D b)
+        {
+            return new Vector3D(a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X);
+        }
+        public static Vector3D Normalize(Vector3D v)
+        {
+            double l = v.Length();
+            return l > 0 ? v / l : v;
+        }
+
+        public static Vector3D TransformNormal(Vector3D v, MatrixD m)
+        {
+            return new Vector3D(
+                v.X * m.M11 + v.Y * m.M21 + v.Z * m.M31,
+                v.X * m.M12 + v.Y * m.M22 + v.Z * m.M32,
+                v.X * m.M13 + v.Y * m.M23 + v.Z * m.M33);
+        }
+
+        public static Vector3D Transform(Vector3D v, MatrixD m)
+        {
+            return TransformNormal(v, m) + new Vector3D(m.M41, m.M42, m.M43);
+        }
+
+        public static Vector3D operator -(Vector3D v) { return new Vector3D(-v.X, -v.Y, -v.Z); }
+        public static Vector3D operator +(Vector3D a, Vector3D b) { return new Vector3D(a.X + b.X, a.Y + b.Y, a.Z + b.Z); }
+        public static Vector3D operator -(Vector3D a, Vector3D b) { return new Vector3D(a.X - b.X, a.Y - b.Y, a.Z - b.Z); }
+        public static Vector3D operator *(Vector3D a, double s) { return new Vector3D(a.X * s, a.Y * s, a.Z * s); }
+        public static Vector3D operator *(double s, Vector3D a) { return a * s; }
+        public static Vector3D operator /(Vector3D a, double s) { return new Vector3D(a.X / s, a.Y / s, a.Z / s); }
+        public static bool operator ==(Vector3D a, Vector3D b) { return a.X == b.X && a.Y == b.Y && a.Z == b.Z; }
+        public static bool operator !=(Vector3D a, Vector3D b) { return !(a == b); }
+
+        public bool Equals(Vector3D other) { return this == other; }
+        public override bool Equals(object obj) { return obj is Vector3D && this == (Vector3D)obj; }
+        public override int GetHashCode() { return (X.GetHashCode() * 397 ^ Y.GetHashCode()) * 397 ^ Z.GetHashCode(); }
+        public override string ToString() { return "{X:" + X + " Y:" + Y + " Z:" + Z + "}"; }
+    }
+
+    public struct MatrixD
+    {
+        public double M11, M12, M13, M14;
+        public double M21, M22, M23, M24;
+        public double M31, M32, M33, M34;
+        public double M41, M42, M43, M44;
+
+        public static readonly MatrixD Identity = new MatrixD { M11 = 1, M22 = 1, M33 = 1, M44 = 1 };
+
+        public Vector3D Right { get { return new Vector3D(M11, M12, M13); } }
+        public Vector3D Left { get { return -Right; } }
+        public Vector3D Up { get { return new Vector3D(M21, M22, M23); } }
+        public Vector3D Down { get { return -Up; } }
+        public Vector3D Backward { get { return new Vector3D(M31, M32, M33); } }
+        public Vector3D Forward { get { return -Backward; } }
+        public Vector3D Translation { get { return new Vector3D(M41, M42, M43); } }
+
+        public static MatrixD CreateWorld(Vector3D position, Vector3D forward, Vector3D up)
+        {
+            var f = Vector3D.Normalize(forward);
+            var r = Vector3D.Normalize(Vector3D.Cross(f, up));
+            var u = Vector3D.Cross(r, f);
+            return new MatrixD
+            {
+                M11 = r.X, M12 = r.Y, M13 = r.Z,
+                M21 = u.X, M22 = u.Y, M23 = u.Z,
+                M31 = -f.X, M32 = -f.Y, M33 = -f.Z,
+                M41 = position.X, M42 = position.Y, M43 = position.Z, M44 = 1,
+            };
+        }
+
+        public static MatrixD Transpose(MatrixD m)
+        {
+            return new MatrixD
+            {
+                M11 = m.M11, M12 = m.M21, M13 = m.M31, M14 = m.M41,
+                M21 = m.M12, M22 = m.M22, M23 = m.M32, M24 = m.M42,
+                M31 = m.M13, M32 = m.M23, M33 = m.M33, M34 = m.M43,
+                M41 = m.M14, M42 = m.M24, M43 = m.M34, M44 = m.M44,
+            };
+        }
+    }
+
+    public struct Color : IEquatable<Color>
+    {
+        public byte R, G, B, A;
+
+        public Color(int r, int g, int b, int a = 255)
+        {
+            R = (byte)r; G = (byte)g; B = (byte)b; A = (byte)a;
+        }
+
+        public static readonly Color White = new Color(255, 255, 255);
+        public static readonly Color Black = new Color(0, 0, 0);
+        public static readonly Color Red = new Color(255, 0, 0);
+        public static readonly Color Green = new Color(0, 128, 0);
+        public static readonly Color Lime = new Color(0, 255, 0);
+        public static readonly Color Yellow = new Color(255, 255, 0);
+        public static readonly Color Orange = new Color(255, 165, 0);
+        public static readonly Color Gray = new Color(128, 128, 128);
+        public static readonly Color DarkGray = new Color(169, 169, 169);
+        public static readonly Color Cyan = new Color(0, 255, 255);
+        public static readonly Color Transparent = new Color(0, 0, 0, 0);
+
+        public static bool operator ==(Color a, Color b) { return a.R == b.R && a.G == b.G && a.B == b.B && a.A == b.A; }
+        public static bool operator !=(Color a, Color b) { return !(a == b); }
+        public bool Equals(Color other) { return this == other; }
+        public override bool Equals(object obj) { return obj is Color && this == (Color)obj; }
+        public override int GetHashCode() { return (R << 24) | (G << 16) | (B << 8) | A; }
+    }
+
+    public static class Base6Directions
+    {
+        public enum Direction : byte { Forward, Backward, Left, Right, Up, Down }
+
+        public static Vector3D GetVectorD(Direction d)
+        {
+            switch (d)
+            {
+                case Direction.Forward: return Vector3D.Forward;
+                case Direction.Backward: return Vector3D.Backward;
+                case Direction.Left: return Vector3D.Left;
+                case Direction.Right: return Vector3D.Right;
+                case Direction.Up: return Vector3D.Up;
+                default: return Vector3D.Down;
+            }
+        }
+    }
+
+    public struct MyBlockOrientation
+    {
+        public Base6Directions.Direction Forward;
+        public Base6Directions.Direction Up;
+
+        public MyBlockOrientation(Base6Directions.Direction forward, Base6Directions.Direction up)
+        {
+            Forward = forward;
+            Up = up;
+        }
+
+        public static readonly MyBlockOrientation Identity = new MyBlockOrientation(Base6Directions.Direction.Forward, Base6Directions.Direction.Up);
+    }
+}
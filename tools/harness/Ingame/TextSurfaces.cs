@@ -0,0 +1,95 @@
+// Stub of the text surface API: LCD panels, cockpit and PB screens.
+using System;
+using System.Collections.Generic;
+using System.Text;
+using VRage.Game.GUI.TextPanel;
+using VRageMath;
+
+namespace Sandbox.ModAPI.Ingame
+{
+    public interface IMyTextSurface
+    {
+        ContentType ContentType { get; set; }
+        string DisplayName { get; }
+        string Font { get; set; }
+        float FontSize { get; set; }
+        Color FontColor { get; set; }
+        Color BackgroundColor { get; set; }
+        TextAlignment Alignment { get; set; }
+        float TextPadding { get; set; }  // percent of the surface, per side
+        Vector2 SurfaceSize { get; }
+        Vector2 TextureSize { get; }
+        bool WriteText(string value, bool append = false);
+        bool WriteText(StringBuilder value, bool append = false);
+        string GetText();
+        void ReadText(StringBuilder buffer, bool append = false);
+        Vector2 MeasureStringInPixels(StringBuilder text, string font, float scale);
+
+        // SCRIPT content type: sprites sent with DrawFrame() replace the text
+        string Script { get; set; }
+        Color ScriptBackgroundColor { get; set; }
+        Color ScriptForegroundColor { get; set; }
+        MySpriteDrawFrame DrawFrame();
+    }
+
+    public interface IMyTextSurfaceProvider
+    {
+        int SurfaceCount { get; }
+        IMyTextSurface GetSurface(int index);
+    }
+
+    public interface IMyTextPanel : IMyTextSurface, IMyFunctionalBlock { }
+}
+
+namespace VRage.Game.GUI.TextPanel
+{
+    public enum ContentType : byte { NONE = 0, TEXT_AND_IMAGE = 1, SCRIPT = 3 }
+
+    public enum TextAlignment : byte { LEFT = 0, RIGHT = 1, CENTER = 2 }
+
+    public enum SpriteType : byte { TEXTURE = 0, TEXT = 2, CLIP_RECT = 4 }
+
+    // Position: texture center (CENTER) or left / right middle, text top;
+    // RotationOrScale: texture rotation (rad) or text scale
+    public struct MySprite
+    {
+        public SpriteType Type;
+        public string Data;
+        public Vector2? Position;
+        public Vector2? Size;
+        public Color? Color;
+        public string FontId;
+        public TextAlignment Alignment;
+        public float RotationOrScale;
+
+        public MySprite(SpriteType type = SpriteType.TEXTURE, string data = null, Vector2? position = null, Vector2? size = null,
+            Color? color = null, string fontId = null, TextAlignment alignment = TextAlignment.CENTER, float rotation = 0)
+        {
+            Type = type;
+            Data = data;
+            Position = position;
+            Size = size;
+            Color = color;
+            FontId = fontId;
+            Alignment = alignment;
+            RotationOrScale = rotation;
+        }
+    }
+
+    // Sprites added to a frame are sent to the surface when it is disposed
+    public struct MySpriteDrawFrame : IDisposable
+    {
+        readonly List<MySprite> sprites;
+        readonly Action<List<MySprite>> submit;
+
+        public MySpriteDrawFrame(Action<List<MySprite>> submit)
+        {
+            sprites = new List<MySprite>();
+            this.submit = submit;
+        }
+
+        public void Add(MySprite sprite) { sprites.Add(sprite); }
+        public void AddRange(IEnumerable<MySprite> list) { sprites.AddRange(list); }
+        public void Dispose() { if (submit != null) submit(sprites); }
+    }
+}
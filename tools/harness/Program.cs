@@ -0,0 +1,49 @@
+// Offline runner for the in-game scripts. Run from the repository root:
+//   dotnet run --project tools/harness -- <command> [args]
+using System;
+using System.Linq;
+
+namespace Harness
+{
+    public static class Program
+    {
+        public static int Main(string[] args)
+        {
+            if (args.Length == 0) return Usage();
+            var rest = args.Skip(1).ToArray();
+            try
+            {
+                switch (args[0])
+                {
+                    case "sim": return Fleet.FleetSim.RunCommand(rest);
+                    case "replay": return Snapshot.Replay.RunCommand(rest);
+                    case "golden": return Snapshot.Golden.RunCommand(rest);
+                    case "bundle": return Bundle.RunCommand(rest);
+                    default: return Usage();
+                }
+            }
+            catch (ScriptException e)
+            {
+                Console.Error.WriteLine(e.Message);
+                return 2;
+            }
+            catch (ArgumentException e)
+            {
+                Console.Error.WriteLine(e.Message);
+                return 1;
+            }
+        }
+
+        static int Usage()
+        {
+            Console.Error.WriteLine("usage: harness <command> [args]");
+            Console.Error.WriteLine("  sim [config.cfg] [key=value ...]   fleet simulation around storage_monitor.cs");
+            Console.Error.WriteLine("                                     (see tools/harness/readme.md for the keys)");
+            Console.Error.WriteLine("  replay <snapshot.txt> [key=value ...]  run YSI, YIM, YST and the monitor on a captured grid");
+            Console.Error.WriteLine("  golden [dir] [Update=true] [Margin=0.25] [Case=name]");
+            Console.Error.WriteLine("                                     check rendered frames and their cost (exit code 3 on failure)");
+            Console.Error.WriteLine("  bundle <out.c> [alias|name=path ...]  one PB script running several scripts as host tasks");
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,378 @@
+// Compiles a script file the way the game does (wrapped in a MyGridProgram
+// subclass, C# 6) against the stub API, then runs it on a simulated PB.
+// Each run is measured: wall time, statements executed, bytes allocated.
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Reflection;
+using System.Text;
+using System.Text.RegularExpressions;
+using Harness.Sim;
+using Microsoft.CodeAnalysis;
+using Microsoft.CodeAnalysis.CSharp;
+using Microsoft.CodeAnalysis.CSharp.Syntax;
+using Sandbox.ModAPI.Ingame;
+
+namespace Harness
+{
+    public sealed class ScriptException : Exception
+    {
+        public ScriptException(string script, string message, Exception inner = null)
+            : base(Path.GetFileName(script) + ": " + message, inner) { }
+    }
+
+    public sealed class SimRuntime : IMyGridProgramRuntimeInfo
+    {
+        internal long RunStart;
+
+        public TimeSpan TimeSinceLastRun { get; set; }
+        public double LastRunTimeMs { get; set; }
+        public int MaxInstructionCount { get { return 50000; } }
+        public int CurrentInstructionCount { get { return (int)(ScriptCost.Statements - RunStart); } }
+        public int MaxCallChainDepth { get { return 10; } }
+        public int CurrentCallChainDepth { get { return 1; } }
+        public UpdateFrequency UpdateFrequency { get; set; }
+    }
+
+    // What DateTime.Now returns inside a script: a fixed epoch plus world time,
+    // so timestamps in logs and frames are the same on every run
+    public static class SimClock
+    {
+        public static readonly DateTime Epoch = new DateTime(2024, 1, 1);
+        [ThreadStatic] static SimWorld world;
+
+        public static DateTime Now
+        {
+            get { return world == null ? Epoch : Epoch.AddTicks(world.Tick * TimeSpan.TicksPerSecond / 60); }
+        }
+
+        internal static void Enter(SimWorld current) { world = current; }
+    }
+
+    // Statements executed by scripts: the harness's stand-in for the game's
+    // instruction counter (the game counts IL instructions, roughly 3-10 per
+    // statement). Counted by the increments CostRewriter inserts.
+    public static class ScriptCost
+    {
+        public static long Statements;
+    }
+
+    // Inserts "ScriptCost.Statements++;" before every statement, wrapping
+    // single embedded statements (if/else/loop bodies) in a block
+    sealed class CostRewriter : CSharpSyntaxRewriter
+    {
+        static StatementSyntax Count() { return SyntaxFactory.ParseStatement("global::Harness.ScriptCost.Statements++;"); }
+
+        static StatementSyntax Wrap(StatementSyntax statement)
+        {
+            return statement is BlockSyntax ? statement : SyntaxFactory.Block(Count(), statement);
+        }
+
+        static SyntaxList<StatementSyntax> Counted(SyntaxList<StatementSyntax> statements)
+        {
+            var list = new List<StatementSyntax>();
+            foreach (var s in statements)
+            {
+                list.Add(Count());
+                list.Add(s);
+            }
+            return SyntaxFactory.List(list);
+        }
+
+        public override SyntaxNode VisitBlock(BlockSyntax node)
+        {
+            var block = (BlockSyntax)base.VisitBlock(node);
+            return block.WithStatements(Counted(block.Statements));
+        }
+
+        public override SyntaxNode VisitSwitchSection(SwitchSectionSyntax node)
+        {
+            var section = (SwitchSectionSyntax)base.VisitSwitchSection(node);
+            return section.WithStatements(Counted(section.Statements));
+        }
+
+        public override SyntaxNode VisitIfStatement(IfStatementSyntax node)
+        {
+            var s = (IfStatementSyntax)base.VisitIfStatement(node);
+            return s.WithStatement(Wrap(s.Statement));
+        }
+
+        public override SyntaxNode VisitElseClause(ElseClauseSyntax node)
+        {
+            var s = (ElseClauseSyntax)base.VisitElseClause(node);
+            return s.Statement is IfStatementSyntax ? s : s.WithStatement(Wrap(s.Statement));
+        }
+
+        public override SyntaxNode VisitForStatement(ForStatementSyntax node)
+        {
+            var s = (ForStatementSyntax)base.VisitForStatement(node);
+            return s.WithStatement(Wrap(s.Statement));
+        }
+
+        public override SyntaxNode VisitForEachStatement(ForEachStatementSyntax node)
+        {
+            var s = (ForEachStatementSyntax)base.VisitForEachStatement(node);
+            return s.WithStatement(Wrap(s.Statement));
+        }
+
+        public override SyntaxNode VisitWhileStatement(WhileStatementSyntax node)
+        {
+            var s = (WhileStatementSyntax)base.VisitWhileStatement(node);
+            return s.WithStatement(Wrap(s.Statement));
+        }
+
+        public override SyntaxNode VisitDoStatement(DoStatementSyntax node)
+        {
+            var s = (DoStatementSyntax)base.VisitDoStatement(node);
+            return s.WithStatement(Wrap(s.Statement));
+        }
+    }
+
+    // DateTime.Now / UtcNow -> SimClock.Now
+    sealed class ClockRewriter : CSharpSyntaxRewriter
+    {
+        public override SyntaxNode VisitMemberAccessExpression(MemberAccessExpressionSyntax node)
+        {
+            string name = node.Name.Identifier.Text;
+            string owner = node.Expression.ToString();
+            if ((name == "Now" || name == "UtcNow") && (owner == "DateTime" || owner == "System.DateTime"))
+                return SyntaxFactory.ParseExpression("global::Harness.SimClock.Now").WithTriviaFrom(node);
+            return base.VisitMemberAccessExpression(node);
+        }
+    }
+
+    public sealed class ScriptHost
+    {
+        // Namespaces the game imports into every script (those the stub defines)
+        static readonly string[] GameUsings =
+        {
+            "System", "System.Collections", "System.Collections.Generic", "System.Linq", "System.Text",
+            "Sandbox.Game.EntityComponents", "Sandbox.ModAPI.Ingame", "Sandbox.ModAPI.Interfaces",
+            "SpaceEngineers.Game.ModAPI.Ingame", "VRage", "VRage.Collections", "VRage.Game",
+            "VRage.Game.Components", "VRage.Game.GUI.TextPanel", "VRage.Game.ModAPI.Ingame",
+            "VRage.Game.ModAPI.Ingame.Utilities", "VRageMath",
+        };
+
+        static readonly Dictionary<string, Type> compiled = new Dictionary<string, Type>();
+        static List<MetadataReference> references;
+
+        public readonly string ScriptPath;
+        public readonly SimProgrammableBlock Me;
+        public readonly SimRuntime Runtime = new SimRuntime();
+        public readonly SimIgc Igc;
+        public readonly StringBuilder EchoText = new StringBuilder();
+        public int Runs { get; private set; }
+        public double TotalMs { get; private set; }
+        public double MaxMs { get; private set; }
+        public long TotalStatements { get; private set; }
+        public long MaxStatements { get; private set; }
+        public long LastStatements { get; private set; }
+        public long TotalAllocated { get; private set; } // bytes
+        public long LastAllocated { get; private set; }
+
+        // false: Runtime.LastRunTimeMs is modelled from the statements executed
+        // instead of measured, so scripts reacting to their run time behave the
+        // same on every machine (deterministic replays, golden frames)
+        public bool MeasuredTime = true;
+        const double ModelledMsPerStatement = 0.00002;
+
+        readonly MyGridProgram program;
+        readonly Action<string, UpdateType> main;
+        readonly Action save;
+        long lastRunTick;
+
+        public ScriptHost(string scriptPath, SimProgrammableBlock me, IDictionary<string, string> constants = null, string storage = null)
+        {
+            ScriptPath = scriptPath;
+            Me = me;
+            Igc = new SimIgc(me);
+            Type type = Compile(scriptPath, constants);
+
+            MyGridProgram.PrepareContext(new ProgramContext
+            {
+                GridTerminalSystem = new SimTerminalSystem(me.Grid),
+                Me = me,
+                Runtime = Runtime,
+                Echo = text => EchoText.Append(text).Append('\n'),
+                Storage = storage,
+                IGC = Igc,
+            });
+            lastRunTick = me.Grid.World.Tick;
+            SimClock.Enter(me.Grid.World);
+            try { program = (MyGridProgram)Activator.CreateInstance(type); }
+            catch (TargetInvocationException e) { throw new ScriptException(scriptPath, "constructor threw " + e.InnerException.Message, e.InnerException); }
+
+            main = BindMain(type, program, scriptPath);
+            var saveMethod = type.GetMethod("Save", BindingFlags.Instance | BindingFlags.Public | BindingFlags.NonPublic, null, Type.EmptyTypes, null);
+            if (saveMethod != null) save = (Action)Delegate.CreateDelegate(typeof(Action), program, saveMethod);
+
+            // Another script calling TryRun on this PB runs it with UpdateType.Script
+            me.Handler = argument => { Run(argument, UpdateType.Script); return true; };
+        }
+
+        public UpdateFrequency Frequency { get { return Runtime.UpdateFrequency; } }
+
+        public void Run(string argument, UpdateType source)
+        {
+            long tick = Me.Grid.World.Tick;
+            Runtime.TimeSinceLastRun = TimeSpan.FromSeconds((tick - lastRunTick) / 60.0);
+            lastRunTick = tick;
+            if ((source & UpdateType.Once) != 0) Runtime.UpdateFrequency &= ~UpdateFrequency.Once;
+
+            EchoText.Clear();
+            SimClock.Enter(Me.Grid.World);
+            Me.IsRunning = true;
+            Runtime.RunStart = ScriptCost.Statements;
+            long allocated = GC.GetAllocatedBytesForCurrentThread();
+            long start = Stopwatch.GetTimestamp();
+            try { main(argument ?? "", source); }
+            catch (Exception e) { throw new ScriptException(ScriptPath, "Main threw " + e.GetType().Name + ": " + e.Message, e); }
+            finally
+            {
+                Me.IsRunning = false;
+                double ms = (Stopwatch.GetTimestamp() - start) * 1000.0 / Stopwatch.Frequency;
+                Runtime.LastRunTimeMs = MeasuredTime ? ms : (ScriptCost.Statements - Runtime.RunStart) * ModelledMsPerStatement;
+                TotalMs += ms;
+                if (ms > MaxMs) MaxMs = ms;
+                LastStatements = ScriptCost.Statements - Runtime.RunStart;
+                TotalStatements += LastStatements;
+                if (LastStatements > MaxStatements) MaxStatements = LastStatements;
+                LastAllocated = GC.GetAllocatedBytesForCurrentThread() - allocated;
+                TotalAllocated += LastAllocated;
+                Runs++;
+                Me.DetailedInfo = EchoText.ToString();
+            }
+        }
+
+        // ---------- Scheduling (same cadence as the game) ----------
+
+        public long NextUpdateTick(long tick)
+        {
+            var f = Frequency;
+            if ((f & (UpdateFrequency.Once | UpdateFrequency.Update1)) != 0 || Igc.HasCallbacks) return tick + 1;
+            if ((f & UpdateFrequency.Update10) != 0) return (tick / 10 + 1) * 10;
+            if ((f & UpdateFrequency.Update100) != 0) return (tick / 100 + 1) * 100;
+            return long.MaxValue;
+        }
+
+        // Runs the script if its update frequency is due at this tick, then
+        // once per IGC callback argument waiting since the previous tick
+        public void RunUpdate(long tick)
+        {
+            var f = Frequency;
+            var source = UpdateType.None;
+            if ((f & UpdateFrequency.Once) != 0) source |= UpdateType.Once;
+            if ((f & UpdateFrequency.Update1) != 0) source |= UpdateType.Update1;
+            if ((f & UpdateFrequency.Update10) != 0 && tick % 10 == 0) source |= UpdateType.Update10;
+            if ((f & UpdateFrequency.Update100) != 0 && tick % 100 == 0) source |= UpdateType.Update100;
+            if (source != UpdateType.None) Run("", source);
+            if (Igc.HasCallbacks)
+                foreach (var argument in Igc.TakeCallbacks()) Run(argument, UpdateType.IGC);
+        }
+
+        public string SaveStorage()
+        {
+            if (save != null) save();
+            return program.StorageForHost;
+        }
+
+        static Action<string, UpdateType> BindMain(Type type, MyGridProgram program, string path)
+        {
+            var method = type.GetMethods(BindingFlags.Instance | BindingFlags.Public | BindingFlags.NonPublic)
+                .FirstOrDefault(m => m.Name == "Main" && m.DeclaringType == type);
+            if (method == null) throw new ScriptException(path, "no Main method");
+
+            switch (method.GetParameters().Length)
+            {
+                case 2:
+                    return (Action<string, UpdateType>)Delegate.CreateDelegate(typeof(Action<string, UpdateType>), program, method);
+                case 1:
+                    var withArgument = (Action<string>)Delegate.CreateDelegate(typeof(Action<string>), program, method);
+                    return (argument, source) => withArgument(argument);
+                default:
+                    var plain = (Action)Delegate.CreateDelegate(typeof(Action), program, method);
+                    return (argument, source) => plain();
+            }
+        }
+
+        // ---------- Compilation ----------
+
+        // Replaces the initializer of a top-level field or constant, e.g.
+        // THRESHOLD_PERCENT=80 turns "const double THRESHOLD_PERCENT = 75.0;" into "= 80;"
+        public static string OverrideConstant(string source, string name, string value)
+        {
+            var pattern = new Regex(@"(?m)^((?:const\s+)?[^\s=;(]+\s+" + Regex.Escape(name) + @"\s*=\s*)[^;]*;");
+            if (!pattern.IsMatch(source)) throw new ArgumentException("no top-level field named " + name);
+            return pattern.Replace(source, m => m.Groups[1].Value + value + ";", 1);
+        }
+
+        // Compiles a script without running it (errors as ScriptException)
+        public static void Check(string path)
+        {
+            Compile(path, null);
+        }
+
+        static Type Compile(string path, IDictionary<string, string> constants)
+        {
+            string source = File.ReadAllText(path);
+            if (constants != null)
+                foreach (var kv in constants)
+                    source = OverrideConstant(source, kv.Key, kv.Value);
+
+            string key = Path.GetFullPath(path) + "\n" + source;
+            Type type;
+            if (compiled.TryGetValue(key, out type)) return type;
+
+            var stubNamespaces = new HashSet<string>(typeof(MyGridProgram).Assembly.GetTypes().Select(t => t.Namespace).Where(n => n != null));
+            var wrapped = new StringBuilder();
+            foreach (var ns in GameUsings)
+                if (ns.StartsWith("System") || stubNamespaces.Contains(ns))
+                    wrapped.Append("using ").Append(ns).Append(";\n");
+            wrapped.Append("namespace HarnessScripts {\n");
+            wrapped.Append("public sealed class Program : MyGridProgram {\n");
+            wrapped.Append("#line 1 \"").Append(path.Replace("\\", "/")).Append("\"\n");
+            wrapped.Append(source);
+            wrapped.Append("\n#line default\n}\n}\n");
+
+            var tree = CSharpSyntaxTree.ParseText(wrapped.ToString(), new CSharpParseOptions(LanguageVersion.CSharp6), path);
+            var root = new ClockRewriter().Visit(tree.GetRoot());
+            root = new CostRewriter().Visit(root);
+            tree = tree.WithRootAndOptions(root, tree.Options);
+            var compilation = CSharpCompilation.Create(
+                "Script_" + compiled.Count,
+                new[] { tree },
+                References(),
+                new CSharpCompilationOptions(OutputKind.DynamicallyLinkedLibrary, optimizationLevel: OptimizationLevel.Release));
+
+            using (var ms = new MemoryStream())
+            {
+                var result = compilation.Emit(ms);
+                if (!result.Success)
+                {
+                    var errors = result.Diagnostics.Where(d => d.Severity == DiagnosticSeverity.Error).Select(d => d.ToString());
+                    throw new ScriptException(path, "compilation failed\n" + string.Join("\n", errors));
+                }
+                type = Assembly.Load(ms.ToArray()).GetType("HarnessScripts.Program");
+            }
+            compiled[key] = type;
+            return type;
+        }
+
+        static List<MetadataReference> References()
+        {
+            if (references != null) return references;
+            references = new List<MetadataReference>();
+            var platform = ((string)AppContext.GetData("TRUSTED_PLATFORM_ASSEMBLIES")).Split(Path.PathSeparator);
+            foreach (var file in platform)
+            {
+                string name = Path.GetFileNameWithoutExtension(file);
+                if (name == "netstandard" || name == "mscorlib" || name.StartsWith("System."))
+                    references.Add(MetadataReference.CreateFromFile(file));
+            }
+            references.Add(MetadataReference.CreateFromFile(typeof(MyGridProgram).Assembly.Location));
+            return references;
+        }
+    }
+}
@@ -0,0 +1,473 @@
+// Concrete simulated blocks behind the stub interfaces.
+using System;
+using System.Collections.Generic;
+using System.Text;
+using Sandbox.ModAPI.Ingame;
+using VRage;
+using VRage.Game.GUI.TextPanel;
+using VRage.Game.ModAPI.Ingame;
+using VRage.ObjectBuilders;
+using VRageMath;
+
+namespace Harness.Sim
+{
+    public class SimBlock : IMyTerminalBlock
+    {
+        public readonly SimGrid Grid;
+        public readonly List<SimInventory> Inventories = new List<SimInventory>();
+        readonly long entityId;
+        string customName;
+
+        public SimBlock(SimGrid grid, string typeId, string subtype, string name)
+        {
+            Grid = grid;
+            BlockDefinition = new SerializableDefinitionId("MyObjectBuilder_" + typeId, subtype);
+            DefinitionDisplayNameText = subtype;
+            customName = name;
+            CustomData = "";
+            IsFunctional = true;
+            Orientation = MyBlockOrientation.Identity;
+            WorldMatrix = MatrixD.Identity;
+            entityId = grid.World.NextEntityId();
+            grid.Add(this);
+        }
+
+        public long EntityId { get { return entityId; } }
+        public string Name { get { return customName; } }
+        public string DisplayName { get { return customName; } }
+        public string DisplayNameText { get { return customName; } }
+        public string DefinitionDisplayNameText { get; set; }
+        public bool Closed { get; private set; }
+        public IMyCubeGrid CubeGrid { get { return Grid; } }
+        public SerializableDefinitionId BlockDefinition { get; private set; }
+        public bool IsFunctional { get; set; }
+        public virtual bool IsWorking { get { return IsFunctional; } }
+        public string CustomData { get; set; }
+        public string DetailedInfo { get; set; }
+        public bool ShowInTerminal { get; set; }
+        public MyBlockOrientation Orientation { get; set; }
+        public MatrixD WorldMatrix { get; set; } // grids sit at the origin, unrotated
+        public Vector3D GetPosition() { return WorldMatrix.Translation; }
+
+        // Type as captured in game (the simulated class may default to another)
+        public void Define(string typeId, string subtype) { BlockDefinition = new SerializableDefinitionId("MyObjectBuilder_" + typeId, subtype); }
+
+        public void Orient(Vector3D forward, Vector3D up) { WorldMatrix = MatrixD.CreateWorld(Vector3D.Zero, forward, up); }
+
+        // Renames change the terminal system fingerprint the scripts watch
+        public string CustomName
+        {
+            get { return customName; }
+            set { customName = value; Grid.World.Invalidate(); }
+        }
+
+        public bool HasInventory { get { return Inventories.Count > 0; } }
+        public int InventoryCount { get { return Inventories.Count; } }
+        public IMyInventory GetInventory() { return Inventories.Count > 0 ? Inventories[0] : null; }
+        public IMyInventory GetInventory(int index) { return index < Inventories.Count ? Inventories[index] : null; }
+
+        public bool IsSameConstructAs(IMyTerminalBlock other)
+        {
+            var b = other as SimBlock;
+            return b != null && b.Grid.Construct == Grid.Construct;
+        }
+
+        public void Close()
+        {
+            if (Closed) return;
+            Closed = true;
+            Grid.Remove(this);
+        }
+
+        public override string ToString() { return customName; }
+    }
+
+    public class SimFunctionalBlock : SimBlock, IMyFunctionalBlock
+    {
+        public SimFunctionalBlock(SimGrid grid, string typeId, string subtype, string name)
+            : base(grid, typeId, subtype, name)
+        {
+            Enabled = true;
+        }
+
+        public bool Enabled { get; set; }
+        public override bool IsWorking { get { return IsFunctional && Enabled; } }
+    }
+
+    public sealed class SimCargo : SimBlock, IMyCargoContainer
+    {
+        public const double LargeContainerM3 = 421.875;
+
+        public SimCargo(SimGrid grid, string name, double volumeM3 = LargeContainerM3, string subtype = "LargeBlockLargeContainer")
+            : base(grid, "CargoContainer", subtype, name)
+        {
+            Inventories.Add(new SimInventory(this, volumeM3));
+        }
+
+        public SimInventory Inventory { get { return Inventories[0]; } }
+    }
+
+    public sealed class SimConnector : SimFunctionalBlock, IMyShipConnector
+    {
+        public SimConnector(SimGrid grid, string name)
+            : base(grid, "ShipConnector", grid.GridSizeEnum == VRage.Game.MyCubeSize.Large ? "Connector" : "ConnectorSmall", name)
+        {
+            Inventories.Add(new SimInventory(this, grid.GridSizeEnum == VRage.Game.MyCubeSize.Large ? 8.0 : 1.152));
+            grid.World.Connectors.Add(this);
+        }
+
+        public SimConnector Other;
+        public bool Linked; // terminal systems merged
+        public MyShipConnectorStatus Status { get; set; }
+        public bool IsConnected { get { return Status == MyShipConnectorStatus.Connected; } }
+        public IMyShipConnector OtherConnector { get { return Status == MyShipConnectorStatus.Connected ? Other : null; } }
+        public void Connect() { }
+        public void Disconnect() { Grid.World.Undock(this); }
+    }
+
+    public sealed class SimProgrammableBlock : SimFunctionalBlock, IMyProgrammableBlock
+    {
+        public readonly List<SimTextSurface> Surfaces = new List<SimTextSurface>();
+
+        public SimProgrammableBlock(SimGrid grid, string name)
+            : base(grid, "MyProgrammableBlock", grid.GridSizeEnum == VRage.Game.MyCubeSize.Large ? "LargeProgrammableBlock" : "SmallProgrammableBlock", name)
+        {
+            Surfaces.Add(new SimTextSurface("Large Display", new Vector2(512, 512)));
+            Surfaces.Add(new SimTextSurface("Keyboard", new Vector2(512, 256)));
+        }
+
+        // What TryRun does: run a hosted script, or a behaviour model (PAM miner)
+        public Func<string, bool> Handler;
+        public bool IsRunning { get; set; }
+
+        public bool TryRun(string argument)
+        {
+            if (!IsWorking || IsRunning || Handler == null) return false;
+            return Handler(argument);
+        }
+
+        public int SurfaceCount { get { return Surfaces.Count; } }
+        public IMyTextSurface GetSurface(int index) { return index >= 0 && index < Surfaces.Count ? Surfaces[index] : null; }
+    }
+
+    // An LCD is its own (single) surface, and a provider of it
+    public sealed class SimTextPanel : SimFunctionalBlock, IMyTextPanel, IMyTextSurfaceProvider
+    {
+        public readonly SimTextSurface Surface;
+
+        public SimTextPanel(SimGrid grid, string name, string subtype = "LargeLCDPanel")
+            : base(grid, "TextPanel", subtype, name)
+        {
+            Surface = new SimTextSurface(subtype, SimTextSurface.DefaultSize(subtype));
+        }
+
+        public int SurfaceCount { get { return 1; } }
+        public IMyTextSurface GetSurface(int index) { return index == 0 ? Surface : null; }
+
+        public ContentType ContentType { get { return Surface.ContentType; } set { Surface.ContentType = value; } }
+        string IMyTextSurface.DisplayName { get { return DisplayNameText; } }
+        public string Font { get { return Surface.Font; } set { Surface.Font = value; } }
+        public float FontSize { get { return Surface.FontSize; } set { Surface.FontSize = value; } }
+        public Color FontColor { get { return Surface.FontColor; } set { Surface.FontColor = value; } }
+        public Color BackgroundColor { get { return Surface.BackgroundColor; } set { Surface.BackgroundColor = value; } }
+        public TextAlignment Alignment { get { return Surface.Alignment; } set { Surface.Alignment = value; } }
+        public float TextPadding { get { return Surface.TextPadding; } set { Surface.TextPadding = value; } }
+        public Vector2 SurfaceSize { get { return Surface.SurfaceSize; } }
+        public Vector2 TextureSize { get { return Surface.TextureSize; } }
+        public bool WriteText(string value, bool append = false) { return Surface.WriteText(value, append); }
+        public bool WriteText(StringBuilder value, bool append = false) { return Surface.WriteText(value, append); }
+        public string GetText() { return Surface.GetText(); }
+        public void ReadText(StringBuilder buffer, bool append = false) { Surface.ReadText(buffer, append); }
+        public Vector2 MeasureStringInPixels(StringBuilder text, string font, float scale) { return Surface.MeasureStringInPixels(text, font, scale); }
+        public string Script { get { return Surface.Script; } set { Surface.Script = value; } }
+        public Color ScriptBackgroundColor { get { return Surface.ScriptBackgroundColor; } set { Surface.ScriptBackgroundColor = value; } }
+        public Color ScriptForegroundColor { get { return Surface.ScriptForegroundColor; } set { Surface.ScriptForegroundColor = value; } }
+        public MySpriteDrawFrame DrawFrame() { return Surface.DrawFrame(); }
+    }
+
+    public sealed class SimGasTank : SimFunctionalBlock, IMyGasTank
+    {
+        public SimGasTank(SimGrid grid, string name, string subtype, float capacityLiters)
+            : base(grid, "OxygenTank", subtype, name)
+        {
+            Capacity = capacityLiters;
+            // Vanilla oxygen tanks have an empty subtype; scripts fall back to the display name
+            DefinitionDisplayNameText = subtype.Contains("Hydrogen") ? "Hydrogen Tank" : "Oxygen Tank";
+        }
+
+        public float Capacity { get; set; }
+        public double FilledRatio { get; set; }
+        public bool Stockpile { get; set; }
+    }
+
+    public class SimPowerProducer : SimFunctionalBlock, IMyPowerProducer
+    {
+        public SimPowerProducer(SimGrid grid, string typeId, string subtype, string name)
+            : base(grid, typeId, subtype, name)
+        {
+        }
+
+        public float CurrentOutput { get; set; }
+        public float MaxOutput { get; set; }
+    }
+
+    public sealed class SimBattery : SimPowerProducer, IMyBatteryBlock
+    {
+        public SimBattery(SimGrid grid, string name, string subtype = "LargeBlockBatteryBlock")
+            : base(grid, "BatteryBlock", subtype, name)
+        {
+        }
+
+        public float CurrentStoredPower { get; set; }
+        public float MaxStoredPower { get; set; }
+        public float CurrentInput { get; set; }
+        public float MaxInput { get; set; }
+    }
+
+    public sealed class SimThrust : SimFunctionalBlock, IMyThrust
+    {
+        public SimThrust(SimGrid grid, string name, string subtype)
+            : base(grid, "Thrust", subtype, name)
+        {
+        }
+
+        public float ThrustOverride { get; set; }
+        public float MaxThrust { get; set; }
+        public float MaxEffectiveThrust { get; set; }
+        public float CurrentThrust { get; set; }
+    }
+
+    public sealed class SimGasGenerator : SimFunctionalBlock, IMyGasGenerator
+    {
+        public SimGasGenerator(SimGrid grid, string name, string subtype)
+            : base(grid, "OxygenGenerator", subtype, name)
+        {
+            Inventories.Add(new SimInventory(this, 4));
+            AutoRefill = true;
+        }
+
+        public bool AutoRefill { get; set; }
+    }
+
+    // Status set from a snapshot; rooms are not modelled
+    public sealed class SimAirVent : SimFunctionalBlock, IMyAirVent
+    {
+        public SimAirVent(SimGrid grid, string name, string subtype)
+            : base(grid, "AirVent", subtype, name)
+        {
+            Status = VentStatus.Depressurized;
+        }
+
+        public bool Depressurize { get; set; }
+        public bool CanPressurize { get { return Status != VentStatus.Depressurized; } }
+        public VentStatus Status { get; set; }
+        public float GetOxygenLevel() { return Status == VentStatus.Pressurized ? 1 : 0; }
+    }
+
+    public sealed class SimOxygenFarm : SimFunctionalBlock, IMyOxygenFarm
+    {
+        public SimOxygenFarm(SimGrid grid, string name, string subtype)
+            : base(grid, "OxygenFarm", subtype, name)
+        {
+        }
+
+        public float Output { get; set; }
+        public bool CanProduce { get { return IsWorking; } }
+        public float GetOutput() { return IsWorking ? Output : 0; }
+    }
+
+    // Refinery or assembler: inventory 0 is the input, 1 the output. The queue
+    // and IsProducing are set from a snapshot; nothing is processed.
+    public class SimProductionBlock : SimFunctionalBlock, IMyProductionBlock
+    {
+        public readonly List<MyProductionItem> Queue = new List<MyProductionItem>();
+
+        public SimProductionBlock(SimGrid grid, string typeId, string subtype, string name, double inputM3, double outputM3)
+            : base(grid, typeId, subtype, name)
+        {
+            Inventories.Add(new SimInventory(this, inputM3));
+            Inventories.Add(new SimInventory(this, outputM3));
+            UseConveyorSystem = true;
+        }
+
+        public IMyInventory InputInventory { get { return Inventories[0]; } }
+        public IMyInventory OutputInventory { get { return Inventories[1]; } }
+        public bool Producing;
+        public bool IsProducing { get { return Producing && IsWorking && Queue.Count > 0; } }
+        public bool IsQueueEmpty { get { return Queue.Count == 0; } }
+        public bool UseConveyorSystem { get; set; }
+        public void GetQueue(List<MyProductionItem> items) { items.Clear(); items.AddRange(Queue); }
+    }
+
+    public sealed class SimRefinery : SimProductionBlock, IMyRefinery
+    {
+        public SimRefinery(SimGrid grid, string name, string subtype = "LargeRefinery")
+            : base(grid, "Refinery", subtype, name, 7.5, 7.5)
+        {
+        }
+    }
+
+    public sealed class SimAssembler : SimProductionBlock, IMyAssembler
+    {
+        public SimAssembler(SimGrid grid, string name, string subtype = "LargeAssembler")
+            : base(grid, "Assembler", subtype, name, 7.5, 7.5)
+        {
+        }
+    }
+
+    // Masses come from a snapshot (Mass) or from the construct's inventories
+    // on top of BaseMass.
+    public class SimShipController : SimBlock, IMyShipController
+    {
+        public SimShipController(SimGrid grid, string typeId, string subtype, string name)
+            : base(grid, typeId, subtype, name)
+        {
+        }
+
+        public bool IsMainCockpit { get; set; }
+        public bool CanControlShip { get { return true; } }
+        public float BaseMass;
+        public MyShipMass? Mass;
+        public Vector3D Gravity;
+        public Vector3D Velocity;
+
+        public MyShipMass CalculateShipMass()
+        {
+            if (Mass.HasValue) return Mass.Value;
+            double cargo = 0;
+            foreach (var g in Grid.World.Grids)
+            {
+                if (g.Construct != Grid.Construct) continue;
+                foreach (var b in g.Blocks)
+                    foreach (var inv in b.Inventories) cargo += (double)inv.CurrentMass;
+            }
+            return new MyShipMass(BaseMass, BaseMass + (float)cargo, BaseMass + (float)cargo);
+        }
+
+        public Vector3D GetNaturalGravity() { return Gravity; }
+        public double GetShipSpeed() { return Velocity.Length(); }
+        public MyShipVelocities GetShipVelocities() { return new MyShipVelocities(Velocity, Vector3D.Zero); }
+    }
+
+    public sealed class SimCockpit : SimShipController, IMyCockpit
+    {
+        public readonly List<SimTextSurface> Surfaces = new List<SimTextSurface>();
+
+        public SimCockpit(SimGrid grid, string name, string subtype = "LargeBlockCockpitSeat")
+            : base(grid, "Cockpit", subtype, name)
+        {
+        }
+
+        public int SurfaceCount { get { return Surfaces.Count; } }
+        public IMyTextSurface GetSurface(int index) { return index >= 0 && index < Surfaces.Count ? Surfaces[index] : null; }
+    }
+
+    // Any other block with screens (button panels, consoles...)
+    public sealed class SimSurfaceBlock : SimFunctionalBlock, IMyTextSurfaceProvider
+    {
+        public readonly List<SimTextSurface> Surfaces = new List<SimTextSurface>();
+
+        public SimSurfaceBlock(SimGrid grid, string typeId, string subtype, string name)
+            : base(grid, typeId, subtype, name)
+        {
+        }
+
+        public int SurfaceCount { get { return Surfaces.Count; } }
+        public IMyTextSurface GetSurface(int index) { return index >= 0 && index < Surfaces.Count ? Surfaces[index] : null; }
+    }
+
+    // Item amounts per type in insertion order; volume tracked as a running sum
+    public sealed class SimInventory : IMyInventory
+    {
+        readonly SimBlock owner;
+        readonly List<MyItemType> order = new List<MyItemType>();
+        readonly Dictionary<MyItemType, double> amounts = new Dictionary<MyItemType, double>();
+        double volume, mass;
+
+        public SimInventory(SimBlock owner, double maxVolumeM3)
+        {
+            this.owner = owner;
+            MaxVolumeM3 = maxVolumeM3;
+        }
+
+        public double MaxVolumeM3;
+        public double VolumeM3 { get { return volume; } }
+        public double FreeM3 { get { return Math.Max(0, MaxVolumeM3 - volume); } }
+
+        public IMyEntity Owner { get { return owner; } }
+        public MyFixedPoint CurrentMass { get { return (MyFixedPoint)mass; } }
+        public MyFixedPoint MaxVolume { get { return (MyFixedPoint)MaxVolumeM3; } }
+        public MyFixedPoint CurrentVolume { get { return (MyFixedPoint)volume; } }
+        public int ItemCount { get { return order.Count; } }
+        public bool IsFull { get { return volume >= MaxVolumeM3 - 1e-6; } }
+
+        public IEnumerable<MyItemType> Types { get { return order; } }
+
+        public double Amount(MyItemType type)
+        {
+            double a;
+            return amounts.TryGetValue(type, out a) ? a : 0;
+        }
+
+        // Adds as much as fits; returns the amount actually added
+        public double Add(MyItemType type, double amount)
+        {
+            var info = ItemCatalog.Info(type);
+            if (amount <= 0) return 0;
+            if (info.Volume > 0) amount = Math.Min(amount, FreeM3 / info.Volume);
+            if (amount <= 1e-9) return 0;
+
+            double cur;
+            if (!amounts.TryGetValue(type, out cur)) order.Add(type);
+            amounts[type] = cur + amount;
+            volume += amount * info.Volume;
+            mass += amount * info.Mass;
+            return amount;
+        }
+
+        public double Remove(MyItemType type, double amount)
+        {
+            double cur;
+            if (amount <= 0 || !amounts.TryGetValue(type, out cur)) return 0;
+            amount = Math.Min(amount, cur);
+            var info = ItemCatalog.Info(type);
+            if (cur - amount <= 1e-9) { amounts.Remove(type); order.Remove(type); amount = cur; }
+            else amounts[type] = cur - amount;
+            volume = Math.Max(0, volume - amount * info.Volume);
+            mass = Math.Max(0, mass - amount * info.Mass);
+            return amount;
+        }
+
+        // Sets an amount as captured in game, without the volume check
+        public void Set(MyItemType type, double amount)
+        {
+            Remove(type, Amount(type));
+            if (amount <= 0) return;
+            var info = ItemCatalog.Info(type);
+            order.Add(type);
+            amounts[type] = amount;
+            volume += amount * info.Volume;
+            mass += amount * info.Mass;
+        }
+
+        public void Clear()
+        {
+            order.Clear();
+            amounts.Clear();
+            volume = 0;
+            mass = 0;
+        }
+
+        // Appends, like the game (callers clear their buffer)
+        public void GetItems(List<MyInventoryItem> items, Func<MyInventoryItem, bool> filter = null)
+        {
+            for (int i = 0; i < order.Count; i++)
+            {
+                var item = new MyInventoryItem(order[i], (uint)i, (MyFixedPoint)amounts[order[i]]);
+                if (filter == null || filter(item)) items.Add(item);
+            }
+        }
+
+        public MyFixedPoint GetItemAmount(MyItemType itemType) { return (MyFixedPoint)Amount(itemType); }
+    }
+}
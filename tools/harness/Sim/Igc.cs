@@ -0,0 +1,154 @@
+// Simulated IGC: one endpoint per hosted PB. Messages are queued on the
+// receivers' listeners as soon as they are sent; a listener with a callback
+// makes its script run with UpdateType.IGC on the next tick (ScriptHost).
+// Antenna range is not modelled: AntennaRelay reaches every endpoint,
+// ConnectedConstructs the ones the sender's terminal system reaches.
+using System;
+using System.Collections.Generic;
+using Sandbox.ModAPI.Ingame;
+
+namespace Harness.Sim
+{
+    public sealed class SimIgc : IMyIntergridCommunicationSystem
+    {
+        public readonly SimProgrammableBlock Pb;
+        readonly List<SimListener> listeners = new List<SimListener>();
+        readonly SimListener unicast;
+        readonly List<string> callbacks = new List<string>();
+
+        public int Sent { get; private set; }     // messages sent, to compare bus traffic
+        public long SentChars { get; private set; } // string payload size
+
+        public SimIgc(SimProgrammableBlock pb)
+        {
+            Pb = pb;
+            unicast = new SimListener(this, null);
+            pb.Grid.World.IgcEndpoints.Add(this);
+        }
+
+        public long Me { get { return Pb.EntityId; } }
+        public IMyUnicastListener UnicastListener { get { return unicast; } }
+
+        public bool IsEndpointReachable(long address, TransmissionDistance distance = TransmissionDistance.AntennaRelay)
+        {
+            var target = Find(address);
+            return target != null && Reaches(target, distance);
+        }
+
+        public void SendBroadcastMessage<TData>(string tag, TData data, TransmissionDistance distance = TransmissionDistance.AntennaRelay)
+        {
+            Count(data);
+            foreach (var target in Pb.Grid.World.IgcEndpoints)
+            {
+                if (target == this || !Reaches(target, distance)) continue;
+                foreach (var l in target.listeners)
+                    if (l.IsActive && l.Tag == tag) l.Deliver(new MyIGCMessage(data, tag, Me));
+            }
+        }
+
+        public bool SendUnicastMessage<TData>(long addressee, string tag, TData data)
+        {
+            var target = Find(addressee);
+            if (target == null || !Reaches(target, TransmissionDistance.AntennaRelay)) return false;
+            Count(data);
+            target.unicast.Deliver(new MyIGCMessage(data, tag, Me));
+            return true;
+        }
+
+        public IMyBroadcastListener RegisterBroadcastListener(string tag)
+        {
+            foreach (var l in listeners)
+                if (l.Tag == tag) { l.IsActive = true; return l; }
+            var listener = new SimListener(this, tag);
+            listeners.Add(listener);
+            return listener;
+        }
+
+        public void DisableBroadcastListener(IMyBroadcastListener broadcastListener)
+        {
+            var l = broadcastListener as SimListener;
+            if (l != null) l.IsActive = false;
+        }
+
+        public void GetBroadcastListeners(List<IMyBroadcastListener> broadcastListeners, Func<IMyBroadcastListener, bool> collect = null)
+        {
+            broadcastListeners.Clear();
+            foreach (var l in listeners)
+                if (collect == null || collect(l)) broadcastListeners.Add(l);
+        }
+
+        // Callback arguments waiting for a run (each argument once)
+        public bool HasCallbacks { get { return callbacks.Count > 0; } }
+
+        public List<string> TakeCallbacks()
+        {
+            var taken = new List<string>(callbacks);
+            callbacks.Clear();
+            return taken;
+        }
+
+        internal void Callback(string argument)
+        {
+            if (!callbacks.Contains(argument)) callbacks.Add(argument);
+        }
+
+        SimIgc Find(long address)
+        {
+            foreach (var e in Pb.Grid.World.IgcEndpoints)
+                if (e.Me == address) return e;
+            return null;
+        }
+
+        bool Reaches(SimIgc target, TransmissionDistance distance)
+        {
+            if (target.Pb.Closed) return false;
+            switch (distance)
+            {
+                case TransmissionDistance.CurrentConstruct: return target.Pb.Grid.Construct == Pb.Grid.Construct;
+                case TransmissionDistance.ConnectedConstructs: return Pb.Grid.World.CanReach(Pb.Grid, target.Pb);
+                default: return true;
+            }
+        }
+
+        void Count<TData>(TData data)
+        {
+            Sent++;
+            var text = data as string;
+            if (text != null) SentChars += text.Length;
+        }
+    }
+
+    public sealed class SimListener : IMyBroadcastListener, IMyUnicastListener
+    {
+        readonly SimIgc owner;
+        readonly Queue<MyIGCMessage> queue = new Queue<MyIGCMessage>();
+        string callback;
+
+        public SimListener(SimIgc owner, string tag)
+        {
+            this.owner = owner;
+            Tag = tag;
+            IsActive = true;
+        }
+
+        public string Tag { get; private set; }
+        public bool IsActive { get; internal set; }
+        public bool HasPendingMessage { get { return queue.Count > 0; } }
+        public int MaxWaitingMessages { get { return 25; } }
+
+        public MyIGCMessage AcceptMessage()
+        {
+            return queue.Count > 0 ? queue.Dequeue() : default(MyIGCMessage);
+        }
+
+        public void SetMessageCallback(string argument = "") { callback = argument ?? ""; }
+        public void DisableMessageCallback() { callback = null; }
+
+        internal void Deliver(MyIGCMessage message)
+        {
+            if (queue.Count == MaxWaitingMessages) queue.Dequeue(); // oldest dropped, like the game
+            queue.Enqueue(message);
+            if (callback != null) owner.Callback(callback);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+// Item masses and volumes (vanilla values) for the simulated inventories and
+// for MyItemType.GetItemInfo(). Unknown items default to 1 kg / 1 L.
+using System.Collections.Generic;
+using VRage.Game.ModAPI.Ingame;
+
+namespace Harness.Sim
+{
+    public static class ItemCatalog
+    {
+        struct Entry { public float Mass, Liters; }
+
+        static readonly Dictionary<string, Entry> entries = new Dictionary<string, Entry>
+        {
+            { "Ore/*",                 new Entry { Mass = 1, Liters = 0.37f } },
+            { "Ingot/Iron",            new Entry { Mass = 1, Liters = 0.127f } },
+            { "Ingot/Nickel",          new Entry { Mass = 1, Liters = 0.112f } },
+            { "Ingot/Cobalt",          new Entry { Mass = 1, Liters = 0.112f } },
+            { "Ingot/Silicon",         new Entry { Mass = 1, Liters = 0.429f } },
+            { "Ingot/Silver",          new Entry { Mass = 1, Liters = 0.095f } },
+            { "Ingot/Gold",            new Entry { Mass = 1, Liters = 0.052f } },
+            { "Ingot/Magnesium",       new Entry { Mass = 1, Liters = 0.575f } },
+            { "Ingot/Platinum",        new Entry { Mass = 1, Liters = 0.047f } },
+            { "Ingot/Uranium",         new Entry { Mass = 1, Liters = 0.052f } },
+            { "Ingot/Stone",           new Entry { Mass = 1, Liters = 0.37f } },
+            { "Component/SteelPlate",  new Entry { Mass = 20, Liters = 3 } },
+            { "Component/Construction", new Entry { Mass = 8, Liters = 2 } },
+            { "Component/InteriorPlate", new Entry { Mass = 3, Liters = 5 } },
+            { "Component/Computer",    new Entry { Mass = 0.2f, Liters = 1 } },
+            { "Component/MetalGrid",   new Entry { Mass = 6, Liters = 15 } },
+            { "Component/SmallTube",   new Entry { Mass = 4, Liters = 2 } },
+            { "Component/LargeTube",   new Entry { Mass = 25, Liters = 38 } },
+            { "Component/Motor",       new Entry { Mass = 24, Liters = 8 } },
+        };
+
+        // Refinery yield per kg of ore (no modules)
+        public static readonly Dictionary<string, double> RefineYield = new Dictionary<string, double>
+        {
+            { "Iron", 0.7 }, { "Nickel", 0.4 }, { "Cobalt", 0.3 }, { "Silicon", 0.7 },
+            { "Silver", 0.1 }, { "Gold", 0.01 }, { "Magnesium", 0.007 }, { "Platinum", 0.005 },
+            { "Uranium", 0.01 }, { "Stone", 0.014 },
+        };
+
+        static readonly Dictionary<MyItemType, MyItemInfo> cache = new Dictionary<MyItemType, MyItemInfo>();
+
+        public static MyItemInfo Info(MyItemType type)
+        {
+            MyItemInfo info;
+            if (cache.TryGetValue(type, out info)) return info;
+
+            string typeName = type.TypeId.Replace("MyObjectBuilder_", "");
+            Entry e;
+            if (!entries.TryGetValue(typeName + "/" + type.SubtypeId, out e) && !entries.TryGetValue(typeName + "/*", out e))
+                e = new Entry { Mass = 1, Liters = 1 };
+            info = new MyItemInfo
+            {
+                Mass = e.Mass,
+                Volume = e.Liters / 1000f,
+                IsOre = typeName == "Ore",
+                IsIngot = typeName == "Ingot",
+            };
+            cache[type] = info;
+            return info;
+        }
+
+        public static double VolumeM3(MyItemType type) { return Info(type).Volume; }
+    }
+}
@@ -0,0 +1,133 @@
+// A simulated text surface. Text is kept verbatim; MeasureStringInPixels uses
+// fixed glyph widths close to the game's fonts at scale 1 (Monospace: every
+// glyph 24 px, others: proportional classes), so layouts are deterministic.
+// In SCRIPT mode the last sprite frame is kept as one line per sprite.
+using System.Collections.Generic;
+using System.Globalization;
+using System.Text;
+using Sandbox.ModAPI.Ingame;
+using VRage.Game.GUI.TextPanel;
+using VRageMath;
+
+namespace Harness.Sim
+{
+    public sealed class SimTextSurface : IMyTextSurface
+    {
+        public const float LineHeight = 30f;
+        public const float MonospaceWidth = 24f;
+
+        readonly StringBuilder text = new StringBuilder();
+        readonly string displayName;
+
+        public SimTextSurface(string displayName, Vector2 size)
+        {
+            this.displayName = displayName;
+            SurfaceSize = size;
+            Font = "Debug";
+            FontSize = 1f;
+            FontColor = Color.White;
+            BackgroundColor = Color.Black;
+            TextPadding = 2f;
+        }
+
+        public int Writes { get; private set; } // WriteText calls and sprite frames, to spot redundant redraws
+        public int Frames { get; private set; } // sprite frames sent
+        readonly StringBuilder sprites = new StringBuilder();
+
+        public ContentType ContentType { get; set; }
+        public string DisplayName { get { return displayName; } }
+        public string Font { get; set; }
+        public float FontSize { get; set; }
+        public Color FontColor { get; set; }
+        public Color BackgroundColor { get; set; }
+        public TextAlignment Alignment { get; set; }
+        public float TextPadding { get; set; }
+        public Vector2 SurfaceSize { get; set; }
+        public Vector2 TextureSize { get { return SurfaceSize; } }
+
+        public bool WriteText(string value, bool append = false)
+        {
+            if (!append) text.Clear();
+            text.Append(value);
+            Writes++;
+            return true;
+        }
+
+        public bool WriteText(StringBuilder value, bool append = false)
+        {
+            if (!append) text.Clear();
+            text.Append(value);
+            Writes++;
+            return true;
+        }
+
+        public string GetText() { return text.ToString(); }
+
+        // What the surface shows: its text, or its sprites in SCRIPT mode
+        public string Rendered { get { return ContentType == ContentType.SCRIPT ? sprites.ToString() : text.ToString(); } }
+
+        public string Script { get; set; }
+        public Color ScriptBackgroundColor { get; set; }
+        public Color ScriptForegroundColor { get; set; }
+
+        public MySpriteDrawFrame DrawFrame() { return new MySpriteDrawFrame(Submit); }
+
+        void Submit(List<MySprite> frame)
+        {
+            sprites.Clear();
+            foreach (var s in frame)
+            {
+                sprites.Append(s.Type).Append(' ').Append(s.Data);
+                if (s.Position.HasValue) sprites.Append(" @").Append(Num(s.Position.Value.X)).Append(',').Append(Num(s.Position.Value.Y));
+                if (s.Size.HasValue) sprites.Append(" ").Append(Num(s.Size.Value.X)).Append('x').Append(Num(s.Size.Value.Y));
+                if (s.Color.HasValue) sprites.Append(" #").Append(s.Color.Value.R.ToString("x2")).Append(s.Color.Value.G.ToString("x2")).Append(s.Color.Value.B.ToString("x2"));
+                if (s.Type == SpriteType.TEXT) sprites.Append(" x").Append(Num(s.RotationOrScale));
+                sprites.Append(' ').Append(s.Alignment).Append('\n');
+            }
+            Frames++;
+            Writes++;
+        }
+
+        static string Num(float value) { return value.ToString("0.#", CultureInfo.InvariantCulture); }
+
+        public void ReadText(StringBuilder buffer, bool append = false)
+        {
+            if (!append) buffer.Clear();
+            buffer.Append(text);
+        }
+
+        public Vector2 MeasureStringInPixels(StringBuilder value, string font, float scale)
+        {
+            bool mono = font == "Monospace";
+            float width = 0, line = 0;
+            int lines = 1;
+            for (int i = 0; i < value.Length; i++)
+            {
+                char c = value[i];
+                if (c == '\n') { lines++; line = 0; continue; }
+                line += mono ? MonospaceWidth : GlyphWidth(c);
+                if (line > width) width = line;
+            }
+            return new Vector2(width * scale, lines * LineHeight * scale);
+        }
+
+        static float GlyphWidth(char c)
+        {
+            if (c == ' ') return 8;
+            if ("il.,:;'|!".IndexOf(c) >= 0) return 9;
+            if ("ftrIj()[]".IndexOf(c) >= 0) return 12;
+            if ("mwMW%@".IndexOf(c) >= 0) return 27;
+            if (char.IsUpper(c) || char.IsDigit(c)) return 20;
+            return 17;
+        }
+
+        // Surface size by block subtype, for panels built without a snapshot
+        public static Vector2 DefaultSize(string subtype)
+        {
+            if (subtype.Contains("Wide")) return new Vector2(1024, 512);
+            if (subtype.Contains("Corner")) return new Vector2(512, 86);
+            if (subtype.Contains("TextPanel")) return new Vector2(512, 307);
+            return new Vector2(512, 512);
+        }
+    }
+}
@@ -0,0 +1,205 @@
+// Simulated world: grids, constructs and the terminal systems they see.
+// Grids sharing a Construct are mechanically joined (IsSameConstructAs);
+// a linked connector pair merges two constructs' terminal systems, like a
+// docked ship in game. Reachable-block lists are cached per topology version.
+using System.Collections.Generic;
+using Sandbox.ModAPI.Ingame;
+using VRage.Game;
+using VRage.Game.ModAPI.Ingame;
+using VRageMath;
+
+namespace Harness.Sim
+{
+    public sealed class SimWorld
+    {
+        public readonly List<SimGrid> Grids = new List<SimGrid>();
+        public readonly List<SimConnector> Connectors = new List<SimConnector>();
+        public readonly Dictionary<long, SimBlock> BlocksById = new Dictionary<long, SimBlock>();
+        public readonly List<SimIgc> IgcEndpoints = new List<SimIgc>();
+        public long Tick;
+        public int Version { get; private set; }
+
+        long nextEntityId = 100000;
+        int nextConstruct = 1;
+        readonly Dictionary<int, Reach> reach = new Dictionary<int, Reach>(); // construct -> cache
+
+        sealed class Reach
+        {
+            public int Version = -1;
+            public readonly List<SimBlock> Blocks = new List<SimBlock>();
+            public readonly HashSet<int> Constructs = new HashSet<int>();
+        }
+
+        public double Seconds { get { return Tick / 60.0; } }
+
+        public long NextEntityId() { return nextEntityId++; }
+
+        public void Invalidate() { Version++; }
+
+        public SimGrid AddGrid(string name, MyCubeSize size = MyCubeSize.Large, bool isStatic = false, SimGrid joinConstructOf = null)
+        {
+            var grid = new SimGrid(this, name, size, isStatic, joinConstructOf != null ? joinConstructOf.Construct : nextConstruct++);
+            Grids.Add(grid);
+            Invalidate();
+            return grid;
+        }
+
+        public void Dock(SimConnector a, SimConnector b)
+        {
+            a.Other = b; b.Other = a;
+            a.Status = b.Status = MyShipConnectorStatus.Connected;
+            a.Linked = b.Linked = false; // terminal systems merge on Link()
+        }
+
+        public void Link(SimConnector a)
+        {
+            if (a.Other == null) return;
+            a.Linked = a.Other.Linked = true;
+            Invalidate();
+        }
+
+        public void Undock(SimConnector a)
+        {
+            var b = a.Other;
+            bool wasLinked = a.Linked;
+            a.Other = null; a.Linked = false; a.Status = MyShipConnectorStatus.Unconnected;
+            if (b != null) { b.Other = null; b.Linked = false; b.Status = MyShipConnectorStatus.Unconnected; }
+            if (wasLinked) Invalidate();
+        }
+
+        public List<SimBlock> TerminalBlocks(SimGrid from)
+        {
+            return Reachable(from).Blocks;
+        }
+
+        public bool CanReach(SimGrid from, SimBlock block)
+        {
+            return !block.Closed && Reachable(from).Constructs.Contains(block.Grid.Construct);
+        }
+
+        Reach Reachable(SimGrid from)
+        {
+            Reach r;
+            if (!reach.TryGetValue(from.Construct, out r)) { r = new Reach(); reach[from.Construct] = r; }
+            if (r.Version == Version) return r;
+
+            r.Version = Version;
+            r.Constructs.Clear();
+            r.Constructs.Add(from.Construct);
+            bool grown = true;
+            while (grown)
+            {
+                grown = false;
+                foreach (var c in Connectors)
+                {
+                    if (!c.Linked || c.Closed || c.Other == null) continue;
+                    if (r.Constructs.Contains(c.Grid.Construct) && r.Constructs.Add(c.Other.Grid.Construct)) grown = true;
+                }
+            }
+
+            r.Blocks.Clear();
+            foreach (var g in Grids)
+                if (r.Constructs.Contains(g.Construct))
+                    r.Blocks.AddRange(g.Blocks);
+            return r;
+        }
+    }
+
+    public sealed class SimGrid : IMyCubeGrid
+    {
+        public readonly SimWorld World;
+        public readonly List<SimBlock> Blocks = new List<SimBlock>();
+        public int Construct;
+        readonly long entityId;
+
+        public SimGrid(SimWorld world, string name, MyCubeSize size, bool isStatic, int construct)
+        {
+            World = world;
+            CustomName = name;
+            GridSizeEnum = size;
+            IsStatic = isStatic;
+            Construct = construct;
+            entityId = world.NextEntityId();
+        }
+
+        public long EntityId { get { return entityId; } }
+        public string Name { get { return CustomName; } }
+        public string DisplayName { get { return CustomName; } }
+        public string CustomName { get; set; }
+        public MyCubeSize GridSizeEnum { get; private set; }
+        public bool IsStatic { get; private set; }
+        public bool Closed { get; set; }
+        public bool HasInventory { get { return false; } }
+        public int InventoryCount { get { return 0; } }
+        public IMyInventory GetInventory() { return null; }
+        public IMyInventory GetInventory(int index) { return null; }
+        public MatrixD WorldMatrix { get { return MatrixD.Identity; } }
+        public Vector3D GetPosition() { return Vector3D.Zero; }
+
+        internal void Add(SimBlock block)
+        {
+            Blocks.Add(block);
+            World.BlocksById[block.EntityId] = block;
+            World.Invalidate();
+        }
+
+        internal void Remove(SimBlock block)
+        {
+            Blocks.Remove(block);
+            World.BlocksById.Remove(block.EntityId);
+            World.Invalidate();
+        }
+    }
+
+    // The terminal system a programmable block on `grid` sees
+    public sealed class SimTerminalSystem : IMyGridTerminalSystem
+    {
+        readonly SimGrid grid;
+
+        public SimTerminalSystem(SimGrid grid) { this.grid = grid; }
+
+        public void GetBlocks(List<IMyTerminalBlock> blocks)
+        {
+            blocks.Clear();
+            foreach (var b in grid.World.TerminalBlocks(grid)) blocks.Add(b);
+        }
+
+        public void GetBlocksOfType<T>(List<IMyTerminalBlock> blocks, System.Func<IMyTerminalBlock, bool> collect = null) where T : class
+        {
+            blocks.Clear();
+            foreach (var b in grid.World.TerminalBlocks(grid))
+                if (b is T && (collect == null || collect(b))) blocks.Add(b);
+        }
+
+        public void GetBlocksOfType<T>(List<T> blocks, System.Func<T, bool> collect = null) where T : class
+        {
+            blocks.Clear();
+            foreach (var b in grid.World.TerminalBlocks(grid))
+            {
+                var t = b as T;
+                if (t != null && (collect == null || collect(t))) blocks.Add(t);
+            }
+        }
+
+        public void SearchBlocksOfName(string name, List<IMyTerminalBlock> blocks, System.Func<IMyTerminalBlock, bool> collect = null)
+        {
+            blocks.Clear();
+            foreach (var b in grid.World.TerminalBlocks(grid))
+                if (b.CustomName.IndexOf(name, System.StringComparison.OrdinalIgnoreCase) >= 0 && (collect == null || collect(b)))
+                    blocks.Add(b);
+        }
+
+        public IMyTerminalBlock GetBlockWithName(string name)
+        {
+            foreach (var b in grid.World.TerminalBlocks(grid))
+                if (b.CustomName == name) return b;
+            return null;
+        }
+
+        public IMyTerminalBlock GetBlockWithId(long id)
+        {
+            SimBlock b;
+            return grid.World.BlocksById.TryGetValue(id, out b) && grid.World.CanReach(grid, b) ? b : null;
+        }
+    }
+}
@@ -0,0 +1,242 @@
+// Golden-frame regression checks. Each case replays a snapshot through one
+// script, runs a list of steps (arguments or waits) and records every
+// surface the script wrote after each step. The text must match the stored
+// frames exactly; the statements executed and bytes allocated by the step
+// must stay within the stored budget plus Margin.
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using Sandbox.ModAPI.Ingame;
+
+namespace Harness.Snapshot
+{
+    public sealed class GoldenCase
+    {
+        public string Name, Script, Snapshot;
+        public readonly List<string> Settings = new List<string>(); // replay key=value, e.g. const.ysi.SPRITES=true
+        public readonly List<string> Steps = new List<string>();
+    }
+
+    public sealed class GoldenFrame
+    {
+        public string Step;
+        public string Text;
+        public long Statements, Allocated;
+    }
+
+    public sealed class Golden
+    {
+        public string Directory = "tools/harness/golden";
+        public bool Update;
+        public double Margin = 0.25;
+        public string Case = "";
+
+        int failures;
+
+        public static int RunCommand(string[] args)
+        {
+            var golden = new Golden();
+            foreach (var arg in args)
+            {
+                int eq = arg.IndexOf('=');
+                if (eq < 0) { golden.Directory = arg; continue; }
+                string key = arg.Substring(0, eq).ToLowerInvariant(), value = arg.Substring(eq + 1);
+                if (key == "update") golden.Update = bool.Parse(value);
+                else if (key == "margin") golden.Margin = double.Parse(value, CultureInfo.InvariantCulture);
+                else if (key == "case") golden.Case = value;
+                else throw new ArgumentException("unknown setting: " + arg.Substring(0, eq));
+            }
+            return golden.Run(Console.Out);
+        }
+
+        public int Run(TextWriter output)
+        {
+            int ran = 0;
+            foreach (var c in LoadCases(Path.Combine(Directory, "cases.cfg")))
+            {
+                if (Case.Length > 0 && c.Name != Case) continue;
+                Check(c, output);
+                ran++;
+            }
+            if (ran == 0) throw new ArgumentException("golden: no case" + (Case.Length > 0 ? " named " + Case : ""));
+            output.WriteLine(failures == 0 ? "golden: {0} case(s) ok" : "golden: {1} failure(s) in {0} case(s)", ran, failures);
+            return failures == 0 ? 0 : 3;
+        }
+
+        // "name script snapshot [key=value...] step,step,..." per line; a step is
+        // an argument run ("-" = empty argument), "+N" = N seconds at the
+        // script's cadence or ">" = apply the snapshot's next frame. key=value
+        // are replay settings (const.ALIAS.NAME=value, arg.ALIAS=...).
+        static List<GoldenCase> LoadCases(string path)
+        {
+            var cases = new List<GoldenCase>();
+            string dir = Path.GetDirectoryName(path);
+            foreach (var raw in File.ReadAllLines(path))
+            {
+                string line = raw.Trim();
+                if (line.Length == 0 || line[0] == '#') continue;
+                var f = line.Split(new[] { ' ', '\t' }, StringSplitOptions.RemoveEmptyEntries);
+                if (f.Length < 4) throw new ArgumentException(path + ": expected \"name script snapshot steps\": " + line);
+                var c = new GoldenCase { Name = f[0], Script = f[1], Snapshot = Path.Combine(dir, f[2]) };
+                for (int i = 3; i < f.Length - 1; i++) c.Settings.Add(f[i]);
+                foreach (var step in f[f.Length - 1].Split(',')) c.Steps.Add(step.Trim());
+                cases.Add(c);
+            }
+            return cases;
+        }
+
+        public static List<GoldenFrame> Render(GoldenCase c)
+        {
+            var config = new ReplayConfig { Snapshot = c.Snapshot, Scripts = c.Script, Timing = false };
+            foreach (var setting in c.Settings) config.Set(setting);
+            var replay = new Replay(config);
+            replay.Start();
+            ScriptHost host = null;
+            foreach (var kv in replay.Hosts) host = kv.Value;
+
+            var frames = new List<GoldenFrame>();
+            foreach (var step in c.Steps)
+            {
+                long statements = host.TotalStatements, allocated = host.TotalAllocated;
+                if (step == ">") replay.Snapshot.ApplyFrame();
+                else if (step.StartsWith("+")) replay.RunFor(double.Parse(step.Substring(1), CultureInfo.InvariantCulture));
+                else host.Run(step == "-" ? "" : step, UpdateType.Terminal);
+
+                var text = new StringBuilder();
+                foreach (var s in replay.WrittenSurfaces())
+                    text.Append("== ").Append(s.Key).Append(" ==\n").Append(s.Value.Rendered).Append('\n');
+                frames.Add(new GoldenFrame
+                {
+                    Step = step,
+                    Text = text.ToString(),
+                    Statements = host.TotalStatements - statements,
+                    Allocated = host.TotalAllocated - allocated,
+                });
+            }
+            return frames;
+        }
+
+        void Check(GoldenCase c, TextWriter output)
+        {
+            string framesPath = Path.Combine(Directory, c.Name + ".frames");
+            string budgetPath = Path.Combine(Directory, c.Name + ".budget");
+            var frames = Render(c);
+
+            if (Update)
+            {
+                WriteFrames(framesPath, frames);
+                WriteBudget(budgetPath, frames);
+                output.WriteLine("{0}: {1} frame(s) recorded", c.Name, frames.Count);
+                return;
+            }
+            if (!File.Exists(framesPath) || !File.Exists(budgetPath))
+            {
+                Fail(output, c.Name, "no golden frames, record them with Update=true");
+                return;
+            }
+
+            var expected = ReadFrames(framesPath);
+            var budget = ReadBudget(budgetPath);
+            if (expected.Count != frames.Count) Fail(output, c.Name, "expected " + expected.Count + " frames, rendered " + frames.Count);
+
+            bool textOk = true;
+            for (int i = 0; i < frames.Count && i < expected.Count; i++)
+            {
+                string diff = FirstDifference(expected[i], frames[i].Text);
+                if (diff != null) { textOk = false; Fail(output, c.Name, "frame " + (i + 1) + " (" + frames[i].Step + "): " + diff); }
+                if (i >= budget.Count) continue;
+                OverBudget(output, c.Name, i, "statements", frames[i].Statements, budget[i].Statements);
+                OverBudget(output, c.Name, i, "bytes allocated", frames[i].Allocated, budget[i].Allocated);
+            }
+            if (!textOk) WriteFrames(framesPath + ".actual", frames);
+            else output.WriteLine("{0}: {1} frame(s) ok", c.Name, frames.Count);
+        }
+
+        void OverBudget(TextWriter output, string name, int frame, string what, long actual, long budget)
+        {
+            if (actual <= budget * (1 + Margin)) return;
+            Fail(output, name, string.Format(CultureInfo.InvariantCulture,
+                "frame {0}: {1} {2} over budget {3} (+{4:0}%)", frame + 1, actual, what, budget, budget > 0 ? (actual - budget) * 100.0 / budget : 100));
+        }
+
+        void Fail(TextWriter output, string name, string message)
+        {
+            failures++;
+            output.WriteLine("{0}: FAIL {1}", name, message);
+        }
+
+        static string FirstDifference(string expected, string actual)
+        {
+            if (expected == actual) return null;
+            var a = expected.Split('\n');
+            var b = actual.Split('\n');
+            for (int i = 0; i < Math.Max(a.Length, b.Length); i++)
+            {
+                string x = i < a.Length ? a[i] : "<end>", y = i < b.Length ? b[i] : "<end>";
+                if (x != y) return "line " + (i + 1) + "\n    expected: " + x + "\n    actual:   " + y;
+            }
+            return "differs";
+        }
+
+        // ---------- Files ----------
+
+        const string FrameHeader = "### frame ";
+
+        static void WriteFrames(string path, List<GoldenFrame> frames)
+        {
+            var sb = new StringBuilder();
+            for (int i = 0; i < frames.Count; i++)
+                sb.Append(FrameHeader).Append(i + 1).Append(": ").Append(frames[i].Step).Append('\n').Append(frames[i].Text);
+            File.WriteAllText(path, sb.ToString());
+        }
+
+        static List<string> ReadFrames(string path)
+        {
+            var frames = new List<string>();
+            StringBuilder current = null;
+            foreach (var line in File.ReadAllText(path).Split('\n'))
+            {
+                if (line.StartsWith(FrameHeader))
+                {
+                    if (current != null) frames.Add(current.ToString());
+                    current = new StringBuilder();
+                    continue;
+                }
+                if (current != null) current.Append(line).Append('\n');
+            }
+            if (current != null)
+            {
+                // the file's final newline does not start another line
+                if (current.Length > 0) current.Length--;
+                frames.Add(current.ToString());
+            }
+            return frames;
+        }
+
+        static void WriteBudget(string path, List<GoldenFrame> frames)
+        {
+            var sb = new StringBuilder("# frame statements bytes_allocated (step)\n");
+            for (int i = 0; i < frames.Count; i++)
+                sb.AppendFormat(CultureInfo.InvariantCulture, "{0} {1} {2} {3}\n", i + 1, frames[i].Statements, frames[i].Allocated, frames[i].Step);
+            File.WriteAllText(path, sb.ToString());
+        }
+
+        static List<GoldenFrame> ReadBudget(string path)
+        {
+            var budget = new List<GoldenFrame>();
+            foreach (var raw in File.ReadAllLines(path))
+            {
+                if (raw.Length == 0 || raw[0] == '#') continue;
+                var f = raw.Split(' ');
+                budget.Add(new GoldenFrame
+                {
+                    Statements = long.Parse(f[1], CultureInfo.InvariantCulture),
+                    Allocated = long.Parse(f[2], CultureInfo.InvariantCulture),
+                });
+            }
+            return budget;
+        }
+    }
+}
@@ -0,0 +1,387 @@
+// Loads a YSNAP snapshot written by "scripts/Yezus grid snapshot/snapshot.c"
+// into a SimWorld. Frame 0 describes grids and blocks and their values; later
+// frames only carry the values that changed and are applied with ApplyFrame.
+// Format: see scripts/Yezus grid snapshot/readme.md.
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using Harness.Sim;
+using Sandbox.ModAPI.Ingame;
+using VRage;
+using VRage.Game;
+using VRage.Game.ModAPI.Ingame;
+using VRageMath;
+
+namespace Harness.Snapshot
+{
+    public sealed class SnapshotFrame
+    {
+        public double Seconds;
+        public readonly List<KeyValuePair<int, string>> Lines = new List<KeyValuePair<int, string>>(); // source line, text
+    }
+
+    public sealed class GridSnapshot
+    {
+        public readonly string Path;
+        public readonly SimWorld World = new SimWorld();
+        public readonly List<SimGrid> Grids = new List<SimGrid>();
+        public readonly List<SimBlock> Blocks = new List<SimBlock>();
+        public readonly List<SnapshotFrame> Frames = new List<SnapshotFrame>();
+        public int Applied { get; private set; } // frames applied so far
+
+        readonly List<KeyValuePair<SimConnector, int>> pendingLinks = new List<KeyValuePair<SimConnector, int>>();
+        int lineNo;
+
+        GridSnapshot(string path) { Path = path; }
+
+        public static GridSnapshot Load(string path)
+        {
+            var snapshot = new GridSnapshot(path);
+            snapshot.Parse(File.ReadAllLines(path));
+            snapshot.ApplyFrame();
+            return snapshot;
+        }
+
+        public double FrameSeconds(int frame) { return Frames[frame].Seconds; }
+
+        // Applies the next frame's values; false once every frame is applied
+        public bool ApplyFrame()
+        {
+            if (Applied >= Frames.Count) return false;
+            foreach (var line in Frames[Applied].Lines)
+            {
+                lineNo = line.Key;
+                ApplyValue(line.Value);
+            }
+            ResolveLinks();
+            Applied++;
+            return true;
+        }
+
+        // ---------- Parsing ----------
+
+        void Parse(string[] lines)
+        {
+            bool header = false;
+            SimBlock block = null;
+            for (int i = 0; i < lines.Length; i++)
+            {
+                lineNo = i + 1;
+                string line = lines[i].TrimEnd('\r');
+                if (line.Length == 0 || line[0] == '#') continue;
+
+                if (!header)
+                {
+                    if (line != "YSNAP 1") throw Error("expected \"YSNAP 1\", got \"" + line + "\"");
+                    header = true;
+                    continue;
+                }
+
+                char kind = line[0];
+                string rest = line.Length > 2 ? line.Substring(2) : "";
+                switch (kind)
+                {
+                    case 'T':
+                        Frames.Add(new SnapshotFrame { Seconds = Number(rest) });
+                        block = null;
+                        break;
+                    case 'G':
+                        StaticOnly();
+                        AddGrid(rest);
+                        break;
+                    case 'B':
+                        StaticOnly();
+                        block = AddBlock(rest);
+                        break;
+                    case 'D':
+                        Previous(block).CustomData = Unescape(rest);
+                        break;
+                    case 'S':
+                        SetSurfaces(Previous(block), rest);
+                        break;
+                    case 'O':
+                        var parts = rest.Split(' ');
+                        Previous(block).Orient(Vector(parts[0]), Vector(parts[1]));
+                        break;
+                    default:
+                        if (Frames.Count == 0) throw Error("value before the first frame");
+                        Frames[Frames.Count - 1].Lines.Add(new KeyValuePair<int, string>(lineNo, line));
+                        break;
+                }
+            }
+            if (!header) throw Error("empty snapshot");
+            if (Frames.Count == 0) throw Error("no frame");
+        }
+
+        void StaticOnly()
+        {
+            if (Frames.Count != 1) throw Error("grids and blocks are only allowed in the first frame");
+        }
+
+        SimBlock Previous(SimBlock block)
+        {
+            if (block == null) throw Error("no block before this line");
+            return block;
+        }
+
+        void AddGrid(string text)
+        {
+            var f = Fields(text, 4);
+            var size = f[0] == "S" ? MyCubeSize.Small : MyCubeSize.Large;
+            int construct = Int(f[2]);
+            if (construct > Grids.Count) throw Error("construct " + construct + " refers to a later grid");
+            var join = construct < Grids.Count ? Grids[construct] : null;
+            Grids.Add(World.AddGrid(f[3], size, f[1] == "1", join));
+        }
+
+        SimBlock AddBlock(string text)
+        {
+            var f = Fields(text, 5);
+            var grid = Grid(f[0]);
+            string type = Token(f[2]), subtype = Token(f[3]), name = f[4];
+            SimBlock block;
+            switch (f[1])
+            {
+                case "T": block = new SimGasTank(grid, name, subtype, 0); break;
+                case "B": block = new SimBattery(grid, name, subtype); break;
+                case "P": block = new SimPowerProducer(grid, type, subtype, name); break;
+                case "H": block = new SimThrust(grid, name, subtype); break;
+                case "C": block = new SimCockpit(grid, name, subtype); break;
+                case "R": block = new SimShipController(grid, type, subtype, name); break;
+                case "K": block = new SimCargo(grid, name, 0, subtype); break;
+                case "F":
+                    if (type == "Refinery") block = new SimRefinery(grid, name, subtype);
+                    else block = new SimAssembler(grid, name, subtype);
+                    break;
+                case "Y":
+                    if (type == "AirVent") block = new SimAirVent(grid, name, subtype);
+                    else if (type == "OxygenFarm") block = new SimOxygenFarm(grid, name, subtype);
+                    else block = new SimGasGenerator(grid, name, subtype);
+                    break;
+                case "N": block = new SimConnector(grid, name); break;
+                case "G": block = new SimProgrammableBlock(grid, name); break;
+                case "L": block = new SimTextPanel(grid, name, subtype); break;
+                case "S": block = new SimSurfaceBlock(grid, type, subtype, name); break;
+                case "-": block = new SimFunctionalBlock(grid, type, subtype, name); break;
+                default: throw Error("unknown block kind " + f[1]);
+            }
+            block.Define(type, subtype);
+            Blocks.Add(block);
+            return block;
+        }
+
+        void SetSurfaces(SimBlock block, string text)
+        {
+            var sizes = new List<Vector2>();
+            foreach (var part in text.Split(','))
+            {
+                int x = part.IndexOf('x');
+                if (x <= 0) throw Error("bad surface size " + part);
+                sizes.Add(new Vector2((float)Number(part.Substring(0, x)), (float)Number(part.Substring(x + 1))));
+            }
+
+            var panel = block as SimTextPanel;
+            if (panel != null) { panel.Surface.SurfaceSize = sizes[0]; return; }
+
+            List<SimTextSurface> surfaces = null;
+            if (block is SimProgrammableBlock) surfaces = ((SimProgrammableBlock)block).Surfaces;
+            else if (block is SimCockpit) surfaces = ((SimCockpit)block).Surfaces;
+            else if (block is SimSurfaceBlock) surfaces = ((SimSurfaceBlock)block).Surfaces;
+            if (surfaces == null) throw Error(block.CustomName + " has no text surfaces");
+
+            surfaces.Clear();
+            for (int i = 0; i < sizes.Count; i++)
+                surfaces.Add(new SimTextSurface("Screen " + i, sizes[i]));
+        }
+
+        // ---------- Values ----------
+
+        void ApplyValue(string line)
+        {
+            var f = line.Split(new[] { ' ' }, StringSplitOptions.RemoveEmptyEntries);
+            if (f.Length < 2) throw Error("incomplete line");
+            var block = Block(f[1]);
+            switch (f[0])
+            {
+                case "I":
+                    Need(f, 4);
+                    int index = Int(f[2]);
+                    while (block.Inventories.Count <= index) block.Inventories.Add(new SimInventory(block, 0));
+                    var inventory = block.Inventories[index];
+                    inventory.MaxVolumeM3 = Number(f[3]);
+                    inventory.Clear();
+                    for (int i = 4; i < f.Length; i++)
+                    {
+                        int eq = f[i].LastIndexOf('=');
+                        if (eq <= 0 || f[i].IndexOf('/') <= 0) throw Error("bad item " + f[i]);
+                        inventory.Set(MyItemType.Parse(f[i].Substring(0, eq)), Number(f[i].Substring(eq + 1)));
+                    }
+                    break;
+                case "Q":
+                    Need(f, 4);
+                    var tank = As<SimGasTank>(block);
+                    tank.Capacity = (float)Number(f[2]);
+                    tank.FilledRatio = Number(f[3]);
+                    break;
+                case "E":
+                    Need(f, 6);
+                    var battery = As<SimBattery>(block);
+                    battery.CurrentStoredPower = (float)Number(f[2]);
+                    battery.MaxStoredPower = (float)Number(f[3]);
+                    battery.CurrentOutput = (float)Number(f[4]);
+                    battery.MaxOutput = (float)Number(f[5]);
+                    break;
+                case "W":
+                    Need(f, 4);
+                    var producer = As<SimPowerProducer>(block);
+                    producer.CurrentOutput = (float)Number(f[2]);
+                    producer.MaxOutput = (float)Number(f[3]);
+                    break;
+                case "H":
+                    Need(f, 4);
+                    var thrust = As<SimThrust>(block);
+                    thrust.MaxEffectiveThrust = (float)Number(f[2]);
+                    thrust.MaxThrust = (float)Number(f[3]);
+                    if (f.Length > 4) thrust.CurrentThrust = (float)Number(f[4]);
+                    break;
+                case "V":
+                    Need(f, 3);
+                    var vent = block as SimAirVent;
+                    if (vent != null) vent.Status = (VentStatus)Int(f[2]);
+                    else As<SimOxygenFarm>(block).Output = (float)Number(f[2]);
+                    break;
+                case "C":
+                    Need(f, 4);
+                    var connector = As<SimConnector>(block);
+                    if (connector.Other != null) World.Undock(connector);
+                    connector.Status = (MyShipConnectorStatus)Int(f[2]);
+                    int other = Int(f[3]);
+                    if (connector.Status == MyShipConnectorStatus.Connected && other >= 0)
+                        pendingLinks.Add(new KeyValuePair<SimConnector, int>(connector, other));
+                    break;
+                case "M":
+                    Need(f, 7);
+                    var controller = As<SimShipController>(block);
+                    controller.IsMainCockpit = f[2] == "1";
+                    controller.BaseMass = (float)Number(f[3]);
+                    controller.Mass = new MyShipMass((float)Number(f[3]), (float)Number(f[4]), (float)Number(f[5]));
+                    controller.Gravity = Vector(f[6]);
+                    break;
+                case "F":
+                    Need(f, 5);
+                    var production = As<SimProductionBlock>(block);
+                    production.Producing = f[2] == "1";
+                    production.Queue.Clear();
+                    int queued = Int(f[3]);
+                    for (int i = 0; i < queued; i++)
+                        production.Queue.Add(new MyProductionItem((uint)i, (MyFixedPoint)(Number(f[4]) / queued)));
+                    break;
+                case "X":
+                    Need(f, 3);
+                    bool working = f[2] == "1";
+                    var functional = block as SimFunctionalBlock;
+                    if (functional != null) functional.Enabled = working;
+                    else block.IsFunctional = working;
+                    break;
+                default:
+                    throw Error("unknown record " + f[0]);
+            }
+        }
+
+        // Connected pairs are docked once both ends have their status
+        void ResolveLinks()
+        {
+            foreach (var kv in pendingLinks)
+            {
+                var a = kv.Key;
+                var b = As<SimConnector>(Block(kv.Value.ToString(CultureInfo.InvariantCulture)));
+                if (a.Other == b) continue;
+                World.Dock(a, b);
+                World.Link(a);
+            }
+            pendingLinks.Clear();
+        }
+
+        // ---------- Helpers ----------
+
+        SimGrid Grid(string text)
+        {
+            int i = Int(text);
+            if (i < 0 || i >= Grids.Count) throw Error("unknown grid " + text);
+            return Grids[i];
+        }
+
+        SimBlock Block(string text)
+        {
+            int i = Int(text);
+            if (i < 0 || i >= Blocks.Count) throw Error("unknown block " + text);
+            return Blocks[i];
+        }
+
+        T As<T>(SimBlock block) where T : SimBlock
+        {
+            var t = block as T;
+            if (t == null) throw Error(block.CustomName + " is not a " + typeof(T).Name.Substring(3));
+            return t;
+        }
+
+        // The last field takes the rest of the line (names contain spaces)
+        string[] Fields(string text, int count)
+        {
+            var f = text.Split(new[] { ' ' }, count);
+            if (f.Length < count) throw Error("expected " + count + " fields");
+            return f;
+        }
+
+        void Need(string[] f, int count)
+        {
+            if (f.Length < count) throw Error("expected " + count + " fields");
+        }
+
+        int Int(string text)
+        {
+            int value;
+            if (!int.TryParse(text, NumberStyles.Integer, CultureInfo.InvariantCulture, out value)) throw Error("bad integer " + text);
+            return value;
+        }
+
+        double Number(string text)
+        {
+            double value;
+            if (!double.TryParse(text, NumberStyles.Float, CultureInfo.InvariantCulture, out value)) throw Error("bad number " + text);
+            return value;
+        }
+
+        Vector3D Vector(string text)
+        {
+            var p = text.Split(',');
+            if (p.Length != 3) throw Error("bad vector " + text);
+            return new Vector3D(Number(p[0]), Number(p[1]), Number(p[2]));
+        }
+
+        static string Token(string text) { return text == "_" ? "" : text; }
+
+        static string Unescape(string text)
+        {
+            var sb = new StringBuilder(text.Length);
+            for (int i = 0; i < text.Length; i++)
+            {
+                char c = text[i];
+                if (c == '\\' && i + 1 < text.Length)
+                {
+                    char n = text[++i];
+                    sb.Append(n == 'n' ? '\n' : n);
+                }
+                else sb.Append(c);
+            }
+            return sb.ToString();
+        }
+
+        ArgumentException Error(string message)
+        {
+            return new ArgumentException(System.IO.Path.GetFileName(Path) + ":" + lineNo + ": " + message);
+        }
+    }
+}
@@ -0,0 +1,227 @@
+// Replays a captured snapshot through the in-game scripts: the world is built
+// from frame 0, every script runs at its own cadence until the next frame's
+// time, the next frame's values are applied, and so on. Script clocks follow
+// world time (SimClock), so the surfaces' text is the same on every run.
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Reflection;
+using System.Text;
+using Harness.Sim;
+using Sandbox.ModAPI.Ingame;
+
+namespace Harness.Snapshot
+{
+    public sealed class ReplayConfig
+    {
+        public string Snapshot = "";
+        public string Scripts = "ysi,yim,yst,monitor"; // aliases or script paths
+        public double SettleSeconds = 60;  // run time after the last frame
+        public double MaxFrameSeconds = 0; // cap on the time between frames, 0 = as captured
+        public bool Show = false;          // print every surface the scripts wrote
+        public bool Echo = false;          // print each script's last Echo output
+        public bool Timing = true;         // false = only deterministic output
+
+        // arg.ALIAS=text runs the script once with that argument after loading;
+        // pb.ALIAS=name hosts it on that captured PB (its Custom Data is kept);
+        // const.ALIAS.NAME=value overrides a constant of that script
+        public readonly Dictionary<string, string> Arguments = new Dictionary<string, string>();
+        public readonly Dictionary<string, string> HostBlocks = new Dictionary<string, string>();
+        public readonly Dictionary<string, Dictionary<string, string>> Constants = new Dictionary<string, Dictionary<string, string>>();
+
+        public static readonly Dictionary<string, string> Aliases = new Dictionary<string, string>
+        {
+            { "ysi", "scripts/Yezus ship infos/script.c" },
+            { "yim", "scripts/Yezus Inventory manager/yezus_inventory_manager.c" },
+            { "yst", "scripts/Yezus ship tester/yst.c" },
+            { "monitor", "scripts/miner_stopper/storage_monitor.cs" },
+        };
+
+        public void Set(string assignment)
+        {
+            int eq = assignment.IndexOf('=');
+            if (eq <= 0) throw new ArgumentException("expected key=value: " + assignment);
+            string key = assignment.Substring(0, eq).Trim();
+            string value = assignment.Substring(eq + 1).Trim();
+
+            if (key.StartsWith("arg.")) { Arguments[key.Substring(4)] = value; return; }
+            if (key.StartsWith("pb.")) { HostBlocks[key.Substring(3)] = value; return; }
+            if (key.StartsWith("const."))
+            {
+                int dot = key.IndexOf('.', 6);
+                if (dot < 0) throw new ArgumentException("expected const.ALIAS.NAME: " + key);
+                string alias = key.Substring(6, dot - 6);
+                Dictionary<string, string> constants;
+                if (!Constants.TryGetValue(alias, out constants)) Constants[alias] = constants = new Dictionary<string, string>();
+                constants[key.Substring(dot + 1)] = value;
+                return;
+            }
+
+            var field = typeof(ReplayConfig).GetField(key, BindingFlags.Public | BindingFlags.Instance | BindingFlags.IgnoreCase);
+            if (field == null || field.IsInitOnly) throw new ArgumentException("unknown setting: " + key);
+            field.SetValue(this, Convert.ChangeType(value, field.FieldType, CultureInfo.InvariantCulture));
+        }
+
+        public static string ScriptPath(string alias)
+        {
+            string path;
+            return Aliases.TryGetValue(alias, out path) ? path : alias;
+        }
+    }
+
+    public sealed class Replay
+    {
+        readonly ReplayConfig config;
+        readonly GridSnapshot snapshot;
+        readonly List<KeyValuePair<string, ScriptHost>> hosts = new List<KeyValuePair<string, ScriptHost>>();
+
+        public Replay(ReplayConfig config)
+        {
+            this.config = config;
+            snapshot = GridSnapshot.Load(config.Snapshot);
+        }
+
+        public GridSnapshot Snapshot { get { return snapshot; } }
+        public IEnumerable<KeyValuePair<string, ScriptHost>> Hosts { get { return hosts; } }
+
+        public static int RunCommand(string[] args)
+        {
+            var config = new ReplayConfig();
+            foreach (var arg in args)
+            {
+                if (arg.Contains("=")) config.Set(arg);
+                else config.Snapshot = arg;
+            }
+            if (config.Snapshot.Length == 0) throw new ArgumentException("replay: no snapshot file");
+
+            var replay = new Replay(config);
+            replay.Start();
+            replay.Run();
+            replay.Report(Console.Out);
+            return 0;
+        }
+
+        public void Start()
+        {
+            foreach (var raw in config.Scripts.Split(','))
+            {
+                string alias = raw.Trim();
+                if (alias.Length == 0) continue;
+
+                SimProgrammableBlock pb = null;
+                string pbName;
+                if (config.HostBlocks.TryGetValue(alias, out pbName))
+                {
+                    foreach (var b in snapshot.Blocks)
+                        if (b.CustomName == pbName) pb = b as SimProgrammableBlock;
+                    if (pb == null) throw new ArgumentException("replay: no programmable block named " + pbName);
+                }
+                else pb = new SimProgrammableBlock(snapshot.Grids[0], "[Harness] " + alias);
+
+                Dictionary<string, string> constants;
+                config.Constants.TryGetValue(alias, out constants);
+                var host = new ScriptHost(ReplayConfig.ScriptPath(alias), pb, constants);
+                host.MeasuredTime = config.Timing;
+                hosts.Add(new KeyValuePair<string, ScriptHost>(alias, host));
+            }
+
+            foreach (var kv in hosts)
+            {
+                string argument;
+                if (config.Arguments.TryGetValue(kv.Key, out argument)) kv.Value.Run(argument, UpdateType.Terminal);
+            }
+            if (hosts.Count == 0) throw new ArgumentException("replay: no script");
+        }
+
+        // Every frame, then SettleSeconds after the last one
+        public void Run()
+        {
+            var frames = snapshot.Frames;
+            for (int f = 0; f < frames.Count; f++)
+            {
+                if (f > 0) snapshot.ApplyFrame();
+                double seconds = f + 1 < frames.Count ? frames[f + 1].Seconds - frames[f].Seconds : config.SettleSeconds;
+                if (config.MaxFrameSeconds > 0) seconds = Math.Min(seconds, config.MaxFrameSeconds);
+                RunFor(seconds);
+            }
+        }
+
+        public void RunFor(double seconds)
+        {
+            var world = snapshot.World;
+            long end = world.Tick + (long)Math.Round(seconds * 60);
+            while (true)
+            {
+                long next = long.MaxValue;
+                foreach (var kv in hosts) next = Math.Min(next, kv.Value.NextUpdateTick(world.Tick));
+                if (next > end) break;
+                world.Tick = next;
+                foreach (var kv in hosts) kv.Value.RunUpdate(next);
+            }
+            world.Tick = end;
+        }
+
+        public void Report(TextWriter output)
+        {
+            output.WriteLine("Snapshot {0}: {1} grids, {2} blocks, {3} frame(s), {4:0} s replayed",
+                Path.GetFileName(snapshot.Path), snapshot.Grids.Count, snapshot.Blocks.Count, snapshot.Frames.Count, snapshot.World.Seconds);
+
+            foreach (var kv in hosts)
+            {
+                var host = kv.Value;
+                output.Write("  {0,-8} {1,6} runs", kv.Key, host.Runs);
+                if (host.Runs > 0)
+                    output.Write(", {0} statements avg, {1} max", host.TotalStatements / host.Runs, host.MaxStatements);
+                if (config.Timing && host.Runs > 0)
+                    output.Write(", {0:0.000} ms avg, {1:0.000} ms max", host.TotalMs / host.Runs, host.MaxMs);
+                output.WriteLine();
+                if (config.Echo && host.EchoText.Length > 0) output.Write(Indent(host.EchoText.ToString()));
+            }
+
+            var text = new StringBuilder();
+            foreach (var s in WrittenSurfaces())
+            {
+                text.Append("== ").Append(s.Key).Append(" ==\n").Append(s.Value.Rendered).Append('\n');
+            }
+            output.WriteLine("Surfaces written: {0}, digest {1:x16}", CountSurfaces(), Digest(text.ToString()));
+            if (config.Show) output.Write(text.ToString());
+        }
+
+        // "Block name [index]" -> surface, for every surface a script wrote to
+        public IEnumerable<KeyValuePair<string, SimTextSurface>> WrittenSurfaces()
+        {
+            foreach (var b in snapshot.Blocks)
+            {
+                var provider = b as IMyTextSurfaceProvider;
+                if (provider == null) continue;
+                for (int i = 0; i < provider.SurfaceCount; i++)
+                {
+                    var surface = provider.GetSurface(i) as SimTextSurface;
+                    if (surface != null && surface.Writes > 0)
+                        yield return new KeyValuePair<string, SimTextSurface>(b.CustomName + " [" + i + "]", surface);
+                }
+            }
+        }
+
+        int CountSurfaces()
+        {
+            int n = 0;
+            foreach (var s in WrittenSurfaces()) n++;
+            return n;
+        }
+
+        // FNV-1a over the surfaces' text: equal digests = identical output
+        static ulong Digest(string text)
+        {
+            ulong h = 14695981039346656037UL;
+            foreach (char c in text) { h ^= c; h *= 1099511628211UL; }
+            return h;
+        }
+
+        static string Indent(string text)
+        {
+            return "    " + text.TrimEnd('\n').Replace("\n", "\n    ") + "\n";
+        }
+    }
+}